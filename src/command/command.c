@@ -944,7 +944,7 @@ static struct cmd_t command_defs[] =
             "How long to wait for keyboard input before checking for new messages or checking for state changes such as 'idle'.")
         CMD_ARGS(
             { "timeout <millis>", "Time to wait (1-1000) in milliseconds before reading input from the terminal buffer, default: 1000." },
-            { "dynamic on|off", "Start with 0 millis and dynamically increase up to timeout when no activity, default: on." })
+            { "dynamic on|off", "Start with 0 millis and dynamically increase up to timeout when no activity, default: on. Ignored while the connection socket is watched directly." })
         CMD_NOEXAMPLES
     },
 
@@ -1254,20 +1254,40 @@ static struct cmd_t command_defs[] =
     },
 
     { "/history",
-        cmd_history, parse_args, 1, 1, &cons_history_setting,
+        cmd_history, parse_args, 1, 2, &cons_history_setting,
         CMD_TAGS(
             CMD_TAG_UI,
             CMD_TAG_CHAT)
         CMD_SYN(
-            "/history on|off")
+            "/history on|off",
+            "/history lines <lines>")
         CMD_DESC(
             "Switch chat history on or off, /chlog will automatically be enabled when this setting is on. "
-            "When history is enabled, previous messages are shown in chat windows.")
+            "When history is enabled, previous messages are shown in chat windows. "
+            "Older messages are loaded when scrolling past the top of the window.")
         CMD_ARGS(
-            { "on|off", "Enable or disable showing chat history." })
+            { "on|off", "Enable or disable showing chat history." },
+            { "lines <lines>", "Number of lines shown when a chat window opens, and loaded each time older history is needed, defaults to 100." })
         CMD_NOEXAMPLES
     },
 
+    { "/search",
+        cmd_search, parse_args_with_freetext, 1, 1, NULL,
+        CMD_TAGS(
+            CMD_TAG_CHAT,
+            CMD_TAG_GROUPCHAT)
+        CMD_SYN(
+            "/search <text>")
+        CMD_DESC(
+            "Search the chat and room logs of the current account, results are shown newest first in the search window. "
+            "Lines containing every word of the text are matched, ignoring case. "
+            "The logs are indexed in the background after connecting and as new messages are logged.")
+        CMD_ARGS(
+            { "<text>", "Words to search for." })
+        CMD_EXAMPLES(
+            "/search meeting tomorrow")
+    },
+
     { "/log",
         cmd_log, parse_args, 1, 2, &cons_log_setting,
         CMD_NOTAGS
@@ -1275,14 +1295,18 @@ static struct cmd_t command_defs[] =
             "/log where",
             "/log rotate on|off",
             "/log maxsize <bytes>",
-            "/log shared on|off")
+            "/log shared on|off",
+            "/log async on|off",
+            "/log queue <lines>")
         CMD_DESC(
             "Manage profanity log settings.")
         CMD_ARGS(
             { "where",           "Show the current log file location." },
             { "rotate on|off",   "Rotate log, default on." },
             { "maxsize <bytes>", "With rotate enabled, specifies the max log size, defaults to 1048580 (1MB)." },
-            { "shared on|off",   "Share logs between all instances, default: on. When off, the process id will be included in the log." })
+            { "shared on|off",   "Share logs between all instances, default: on. When off, the process id will be included in the log." },
+            { "async on|off",    "Write the log from a background thread, default: on. When off, each line is written as it is logged." },
+            { "queue <lines>",   "With async enabled, the number of lines that can wait to be written before logging waits for the writer, defaults to 1000." })
         CMD_NOEXAMPLES
     },
 
@@ -1548,6 +1572,47 @@ static struct cmd_t command_defs[] =
         CMD_NOEXAMPLES
     },
 
+    { "/perf",
+        cmd_perf, parse_args, 0, 2, NULL,
+        CMD_TAGS(
+            CMD_TAG_UI)
+        CMD_SYN(
+            "/perf",
+            "/perf on|off",
+            "/perf reset",
+            "/perf dump <file>")
+        CMD_DESC(
+            "Profile how long stanza handlers, server events and screen updates take. "
+            "With no arguments, show the count, total, median, 99th percentile and maximum time for each in the perf window. "
+            "Profiling is off by default and costs almost nothing until enabled.")
+        CMD_ARGS(
+            { "on|off",      "Start or stop recording times." },
+            { "reset",       "Discard the times recorded so far." },
+            { "dump <file>", "Write the times to a file as tab separated values, in nanoseconds." })
+        CMD_EXAMPLES(
+            "/perf on",
+            "/perf dump /tmp/profanity-perf.tsv")
+    },
+
+    { "/capture",
+        cmd_capture, parse_args, 1, 2, NULL,
+        CMD_TAGS(
+            CMD_TAG_CONNECTION)
+        CMD_SYN(
+            "/capture start <file>",
+            "/capture stop")
+        CMD_DESC(
+            "Record every stanza received from the server, with the time it arrived, to a file. "
+            "Recordings can be replayed at full speed by the functional tests to measure how quickly they are handled. "
+            "The file contains the full content of your messages and presences.")
+        CMD_ARGS(
+            { "start <file>", "Start recording to file, replacing its contents." },
+            { "stop",         "Stop recording." })
+        CMD_EXAMPLES(
+            "/capture start /tmp/session.capture",
+            "/capture stop")
+    },
+
     { "/away",
         cmd_away, parse_args_with_freetext, 0, 1, NULL,
         CMD_TAGS(
@@ -1650,6 +1715,7 @@ static Autocomplete account_status_ac;
 static Autocomplete disco_ac;
 static Autocomplete close_ac;
 static Autocomplete wins_ac;
+static Autocomplete history_ac;
 static Autocomplete roster_ac;
 static Autocomplete roster_option_ac;
 static Autocomplete roster_by_ac;
@@ -1680,6 +1746,8 @@ static Autocomplete time_ac;
 static Autocomplete time_format_ac;
 static Autocomplete resource_ac;
 static Autocomplete inpblock_ac;
+static Autocomplete perf_ac;
+static Autocomplete capture_ac;
 static Autocomplete receipts_ac;
 static Autocomplete pgp_ac;
 static Autocomplete pgp_log_ac;
@@ -1788,6 +1856,8 @@ cmd_init(void)
     autocomplete_add(log_ac, "maxsize");
     autocomplete_add(log_ac, "rotate");
     autocomplete_add(log_ac, "shared");
+    autocomplete_add(log_ac, "async");
+    autocomplete_add(log_ac, "queue");
     autocomplete_add(log_ac, "where");
 
     autoaway_ac = autocomplete_new();
@@ -1873,6 +1943,11 @@ cmd_init(void)
     autocomplete_add(wins_ac, "tidy");
     autocomplete_add(wins_ac, "swap");
 
+    history_ac = autocomplete_new();
+    autocomplete_add(history_ac, "on");
+    autocomplete_add(history_ac, "off");
+    autocomplete_add(history_ac, "lines");
+
     roster_ac = autocomplete_new();
     autocomplete_add(roster_ac, "add");
     autocomplete_add(roster_ac, "online");
@@ -2059,6 +2134,16 @@ cmd_init(void)
     autocomplete_add(inpblock_ac, "timeout");
     autocomplete_add(inpblock_ac, "dynamic");
 
+    perf_ac = autocomplete_new();
+    autocomplete_add(perf_ac, "on");
+    autocomplete_add(perf_ac, "off");
+    autocomplete_add(perf_ac, "reset");
+    autocomplete_add(perf_ac, "dump");
+
+    capture_ac = autocomplete_new();
+    autocomplete_add(capture_ac, "start");
+    autocomplete_add(capture_ac, "stop");
+
     receipts_ac = autocomplete_new();
     autocomplete_add(receipts_ac, "send");
     autocomplete_add(receipts_ac, "request");
@@ -2108,6 +2193,7 @@ cmd_uninit(void)
     autocomplete_free(disco_ac);
     autocomplete_free(close_ac);
     autocomplete_free(wins_ac);
+    autocomplete_free(history_ac);
     autocomplete_free(roster_ac);
     autocomplete_free(roster_option_ac);
     autocomplete_free(roster_by_ac);
@@ -2138,6 +2224,8 @@ cmd_uninit(void)
     autocomplete_free(time_format_ac);
     autocomplete_free(resource_ac);
     autocomplete_free(inpblock_ac);
+    autocomplete_free(perf_ac);
+    autocomplete_free(capture_ac);
     autocomplete_free(receipts_ac);
     autocomplete_free(pgp_ac);
     autocomplete_free(pgp_log_ac);
@@ -2287,6 +2375,7 @@ cmd_reset_autocomplete(ProfWin *window)
     autocomplete_reset(disco_ac);
     autocomplete_reset(close_ac);
     autocomplete_reset(wins_ac);
+    autocomplete_reset(history_ac);
     autocomplete_reset(roster_ac);
     autocomplete_reset(roster_option_ac);
     autocomplete_reset(roster_by_ac);
@@ -2318,6 +2407,8 @@ cmd_reset_autocomplete(ProfWin *window)
     autocomplete_reset(time_format_ac);
     autocomplete_reset(resource_ac);
     autocomplete_reset(inpblock_ac);
+    autocomplete_reset(perf_ac);
+    autocomplete_reset(capture_ac);
     autocomplete_reset(receipts_ac);
     autocomplete_reset(pgp_ac);
     autocomplete_reset(pgp_log_ac);
@@ -2467,7 +2558,7 @@ _cmd_complete_parameters(ProfWin *window, const char * const input)
 
     // autocomplete boolean settings
     gchar *boolean_choices[] = { "/beep", "/intype", "/states", "/outtype",
-        "/flash", "/splash", "/chlog", "/grlog", "/history", "/vercheck",
+        "/flash", "/splash", "/chlog", "/grlog", "/vercheck",
         "/privileges", "/presence", "/wrap", "/winstidy", "/carbons", "/encwarn" };
 
     for (i = 0; i < ARRAY_SIZE(boolean_choices); i++) {
@@ -2533,8 +2624,8 @@ _cmd_complete_parameters(ProfWin *window, const char * const input)
         }
     }
 
-    gchar *cmds[] = { "/prefs", "/disco", "/close", "/wins", "/subject", "/room" };
-    Autocomplete completers[] = { prefs_ac, disco_ac, close_ac, wins_ac, subject_ac, room_ac };
+    gchar *cmds[] = { "/prefs", "/disco", "/close", "/wins", "/subject", "/room", "/history", "/perf", "/capture" };
+    Autocomplete completers[] = { prefs_ac, disco_ac, close_ac, wins_ac, subject_ac, room_ac, history_ac, perf_ac, capture_ac };
 
     for (i = 0; i < ARRAY_SIZE(cmds); i++) {
         result = autocomplete_param_with_ac(input, cmds[i], completers[i], TRUE);
@@ -2911,6 +3002,11 @@ _log_autocomplete(ProfWin *window, const char * const input)
     if (result) {
         return result;
     }
+    result = autocomplete_param_with_func(input, "/log async",
+        prefs_autocomplete_boolean_choice);
+    if (result) {
+        return result;
+    }
     result = autocomplete_param_with_ac(input, "/log", log_ac, TRUE);
     if (result) {
         return result;
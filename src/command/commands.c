@@ -53,6 +53,7 @@
 #include "roster_list.h"
 #include "jid.h"
 #include "log.h"
+#include "log_index.h"
 #include "muc.h"
 #ifdef HAVE_LIBOTR
 #include "otr/otr.h"
@@ -63,6 +64,7 @@
 #include "profanity.h"
 #include "tools/autocomplete.h"
 #include "tools/parser.h"
+#include "tools/perf.h"
 #include "tools/tinyurl.h"
 #include "xmpp/xmpp.h"
 #include "xmpp/bookmark.h"
@@ -71,6 +73,15 @@
 #include "event/client_events.h"
 #include "event/ui_events.h"
 
+// most recent matches shown by /search
+#define SEARCH_MAX_RESULTS 100
+
+// window a /tiny result is sent to
+typedef struct tiny_request_t {
+    win_type_t win_type;
+    char *target;
+} TinyRequest;
+
 static void _update_presence(const resource_presence_t presence,
     const char * const show, gchar **args);
 static gboolean _cmd_set_boolean_preference(gchar *arg, const char * const command,
@@ -78,6 +89,8 @@ static gboolean _cmd_set_boolean_preference(gchar *arg, const char * const comma
 //static void _cmd_show_filtered_help(char *heading, gchar *cmd_filter[], int filter_size);
 static void _who_room(ProfWin *window, const char * const command, gchar **args);
 static void _who_roster(ProfWin *window, const char * const command, gchar **args);
+static void _cmd_tiny_created(const char * const tiny, void *userdata);
+static void _tiny_request_free(TinyRequest *request);
 
 extern GHashTable *commands;
 
@@ -191,25 +204,29 @@ cmd_connect(ProfWin *window, const char * const command, gchar **args)
         }
     }
 
-    char *user = args[0];
-    char *def = prefs_get_string(PREF_DEFAULT_ACCOUNT);
+    const char *user = args[0];
+    const char *def = prefs_get_string(PREF_DEFAULT_ACCOUNT);
     if (!user) {
         if (def) {
             user = def;
             cons_show("Using default account %s.", user);
         } else {
             cons_show("No default account.");
-            g_free(def);
             return TRUE;
         }
     }
 
     char *lower = g_utf8_strdown(user, -1);
     char *jid;
-    g_free(def);
 
     // connect with account
-    ProfAccount *account = accounts_get_account(lower);
+    ProfAccount *account = NULL;
+    ProfAccount *cached = accounts_get_account(lower);
+    if (cached) {
+        // the password is filled in below, so work on a private copy
+        account = account_copy(cached);
+        account_free(cached);
+    }
     if (account) {
         // use password if set
         if (account->password) {
@@ -305,7 +322,7 @@ cmd_account(ProfWin *window, const char * const command, gchar **args)
         if(!account_name) {
             cons_bad_cmd_usage(command);
         } else {
-            char *def = prefs_get_string(PREF_DEFAULT_ACCOUNT);
+            const char *def = prefs_get_string(PREF_DEFAULT_ACCOUNT);
             if(accounts_remove(account_name)){
                 cons_show("Account %s removed.", account_name);
                 if(def && strcmp(def, account_name) == 0){
@@ -317,7 +334,6 @@ cmd_account(ProfWin *window, const char * const command, gchar **args)
                 cons_show("Either the account does not exist, or an unknown error occurred.");
             }
             cons_show("");
-            g_free(def);
         }
     } else if (strcmp(subcmd, "enable") == 0) {
         char *account_name = args[1];
@@ -362,11 +378,10 @@ cmd_account(ProfWin *window, const char * const command, gchar **args)
         }
     } else if (strcmp(subcmd, "default") == 0) {
         if(g_strv_length(args) == 1){
-            char *def = prefs_get_string(PREF_DEFAULT_ACCOUNT);
+            const char *def = prefs_get_string(PREF_DEFAULT_ACCOUNT);
 
             if(def){
                 cons_show("The default account is %s.", def);
-                free(def);
             } else {
                 cons_show("No default account.");
             }
@@ -379,7 +394,7 @@ cmd_account(ProfWin *window, const char * const command, gchar **args)
             }
         } else if(g_strv_length(args) == 3) {
             if(strcmp(args[1], "set") == 0){
-                if(accounts_get_account(args[2])){
+                if(accounts_account_exists(args[2])){
                     prefs_set_string(PREF_DEFAULT_ACCOUNT, args[2]);
                     cons_show("Default account set to %s.", args[2]);
                 } else {
@@ -444,21 +459,29 @@ cmd_account(ProfWin *window, const char * const command, gchar **args)
                     }
                     cons_show("");
                 } else if (strcmp(property, "password") == 0) {
-                    if(accounts_get_account(account_name)->eval_password) {
+                    ProfAccount *account = accounts_get_account(account_name);
+                    gchar *eval_password = g_strdup(account->eval_password);
+                    account_free(account);
+                    if(eval_password) {
                         cons_show("Cannot set password when eval_password is set.");
                     } else {
                         accounts_set_password(account_name, value);
                         cons_show("Updated password for account %s", account_name);
                         cons_show("");
                     }
+                    g_free(eval_password);
                 } else if (strcmp(property, "eval_password") == 0) {
-                    if(accounts_get_account(account_name)->password) {
+                    ProfAccount *account = accounts_get_account(account_name);
+                    gchar *password = g_strdup(account->password);
+                    account_free(account);
+                    if(password) {
                         cons_show("Cannot set eval_password when password is set.");
                     } else {
                         accounts_set_eval_password(account_name, value);
                         cons_show("Updated eval_password for account %s", account_name);
                         cons_show("");
                     }
+                    g_free(password);
                 } else if (strcmp(property, "muc") == 0) {
                     accounts_set_muc_service(account_name, value);
                     cons_show("Updated muc service for account %s: %s", account_name, value);
@@ -3283,41 +3306,83 @@ cmd_tiny(ProfWin *window, const char * const command, gchar **args)
         return TRUE;
     }
 
-    char *tiny = tinyurl_get(url);
-    if (!tiny) {
-        win_print(window, '-', 0, NULL, 0, THEME_ERROR, "", "Couldn't create tinyurl.");
-        return TRUE;
+    // remember the window by jid, it may be closed before the url arrives
+    TinyRequest *request = malloc(sizeof(TinyRequest));
+    request->win_type = window->type;
+    switch (window->type) {
+    case WIN_CHAT:
+        request->target = strdup(((ProfChatWin*)window)->barejid);
+        break;
+    case WIN_PRIVATE:
+        request->target = strdup(((ProfPrivateWin*)window)->fulljid);
+        break;
+    default:
+        request->target = strdup(((ProfMucWin*)window)->roomjid);
+        break;
     }
 
-    switch (window->type){
+    tinyurl_get(url, _cmd_tiny_created, request, (GDestroyNotify)_tiny_request_free);
+
+    return TRUE;
+}
+
+static void
+_cmd_tiny_created(const char * const tiny, void *userdata)
+{
+    TinyRequest *request = userdata;
+
+    switch (request->win_type) {
     case WIN_CHAT:
     {
-        ProfChatWin *chatwin = (ProfChatWin*)window;
-        assert(chatwin->memcheck == PROFCHATWIN_MEMCHECK);
-        cl_ev_send_msg(chatwin, tiny);
+        ProfChatWin *chatwin = wins_get_chat(request->target);
+        if (chatwin == NULL) {
+            break;
+        }
+        if (tiny) {
+            cl_ev_send_msg(chatwin, tiny);
+        } else {
+            win_print((ProfWin*)chatwin, '-', 0, NULL, 0, THEME_ERROR, "", "Couldn't create tinyurl.");
+        }
         break;
     }
     case WIN_PRIVATE:
     {
-        ProfPrivateWin *privatewin = (ProfPrivateWin*)window;
-        assert(privatewin->memcheck == PROFPRIVATEWIN_MEMCHECK);
-        cl_ev_send_priv_msg(privatewin, tiny);
+        ProfPrivateWin *privatewin = wins_get_private(request->target);
+        if (privatewin == NULL) {
+            break;
+        }
+        if (tiny) {
+            cl_ev_send_priv_msg(privatewin, tiny);
+        } else {
+            win_print((ProfWin*)privatewin, '-', 0, NULL, 0, THEME_ERROR, "", "Couldn't create tinyurl.");
+        }
         break;
     }
     case WIN_MUC:
     {
-        ProfMucWin *mucwin = (ProfMucWin*)window;
-        assert(mucwin->memcheck == PROFMUCWIN_MEMCHECK);
-        cl_ev_send_muc_msg(mucwin, tiny);
+        ProfMucWin *mucwin = wins_get_muc(request->target);
+        if (mucwin == NULL) {
+            break;
+        }
+        if (tiny) {
+            cl_ev_send_muc_msg(mucwin, tiny);
+        } else {
+            win_print((ProfWin*)mucwin, '-', 0, NULL, 0, THEME_ERROR, "", "Couldn't create tinyurl.");
+        }
         break;
     }
     default:
         break;
     }
+}
 
-    free(tiny);
-
-    return TRUE;
+static void
+_tiny_request_free(TinyRequest *request)
+{
+    if (request) {
+        free(request->target);
+        free(request);
+    }
 }
 
 gboolean
@@ -3775,6 +3840,7 @@ cmd_log(ProfWin *window, const char * const command, gchar **args)
         gboolean res = strtoi_range(value, &intval, PREFS_MIN_LOG_SIZE, INT_MAX, &err_msg);
         if (res) {
             prefs_set_max_log_size(intval);
+            log_update_rotate();
             cons_show("Log maxinum size set to %d bytes", intval);
         } else {
             cons_show(err_msg);
@@ -3788,7 +3854,9 @@ cmd_log(ProfWin *window, const char * const command, gchar **args)
             cons_bad_cmd_usage(command);
             return TRUE;
         }
-        return _cmd_set_boolean_preference(value, command, "Log rotate", PREF_LOG_ROTATE);
+        gboolean result = _cmd_set_boolean_preference(value, command, "Log rotate", PREF_LOG_ROTATE);
+        log_update_rotate();
+        return result;
     }
 
     if (strcmp(subcmd, "shared") == 0) {
@@ -3801,6 +3869,36 @@ cmd_log(ProfWin *window, const char * const command, gchar **args)
         return result;
     }
 
+    if (strcmp(subcmd, "async") == 0) {
+        if (value == NULL) {
+            cons_bad_cmd_usage(command);
+            return TRUE;
+        }
+        gboolean result = _cmd_set_boolean_preference(value, command, "Async log", PREF_LOG_ASYNC);
+        log_reinit();
+        return result;
+    }
+
+    if (strcmp(subcmd, "queue") == 0) {
+        if (value == NULL) {
+            cons_bad_cmd_usage(command);
+            return TRUE;
+        }
+
+        int intval = 0;
+        char *err_msg = NULL;
+        gboolean res = strtoi_range(value, &intval, 1, INT_MAX, &err_msg);
+        if (res) {
+            prefs_set_log_queue_size(intval);
+            log_reinit();
+            cons_show("Log queue size set to %d lines", intval);
+        } else {
+            cons_show(err_msg);
+            free(err_msg);
+        }
+        return TRUE;
+    }
+
     if (strcmp(subcmd, "where") == 0) {
         char *logfile = get_log_file_location();
         cons_show("Log file: %s", logfile);
@@ -4035,6 +4133,87 @@ cmd_vercheck(ProfWin *window, const char * const command, gchar **args)
     }
 }
 
+gboolean
+cmd_search(ProfWin *window, const char * const command, gchar **args)
+{
+    jabber_conn_status_t conn_status = jabber_get_connection_status();
+    if (conn_status != JABBER_CONNECTED) {
+        cons_show("You are not currently connected.");
+        return TRUE;
+    }
+
+    // the index reads the logs back from disk
+    chat_log_flush_all();
+
+    Jid *jidp = jid_create(jabber_get_fulljid());
+    GTimer *timer = g_timer_new();
+    GSList *results = log_index_search(jidp->barejid, args[0], SEARCH_MAX_RESULTS);
+    double elapsed = g_timer_elapsed(timer, NULL);
+    g_timer_destroy(timer);
+    jid_destroy(jidp);
+
+    ui_show_search_results(args[0], results, elapsed, log_index_building());
+    log_index_free_results(results);
+
+    return TRUE;
+}
+
+gboolean
+cmd_perf(ProfWin *window, const char * const command, gchar **args)
+{
+    if (args[0] == NULL) {
+        GSList *stats = perf_get_stats();
+        ui_show_perf(stats);
+        perf_free_stats(stats);
+        return TRUE;
+    }
+
+    if (g_strcmp0(args[0], "on") == 0) {
+        perf_enable(TRUE);
+        cons_show("Profiling enabled.");
+    } else if (g_strcmp0(args[0], "off") == 0) {
+        perf_enable(FALSE);
+        cons_show("Profiling disabled.");
+    } else if (g_strcmp0(args[0], "reset") == 0) {
+        perf_reset();
+        cons_show("Profiling times reset.");
+    } else if ((g_strcmp0(args[0], "dump") == 0) && args[1]) {
+        if (perf_dump(args[1])) {
+            cons_show("Profiling times written to %s.", args[1]);
+        } else {
+            cons_show_error("Could not write profiling times to %s.", args[1]);
+        }
+    } else {
+        cons_bad_cmd_usage(command);
+    }
+
+    return TRUE;
+}
+
+gboolean
+cmd_capture(ProfWin *window, const char * const command, gchar **args)
+{
+    if ((g_strcmp0(args[0], "start") == 0) && args[1]) {
+        if (capture_start(args[1])) {
+            cons_show("Capturing received stanzas to %s.", args[1]);
+        } else {
+            cons_show_error("Could not open %s for capture.", args[1]);
+        }
+    } else if (g_strcmp0(args[0], "stop") == 0) {
+        const char *path = capture_path();
+        if (path) {
+            cons_show("Stopped capturing to %s.", path);
+            capture_stop();
+        } else {
+            cons_show("Not capturing.");
+        }
+    } else {
+        cons_bad_cmd_usage(command);
+    }
+
+    return TRUE;
+}
+
 gboolean
 cmd_xmlconsole(ProfWin *window, const char * const command, gchar **args)
 {
@@ -4104,6 +4283,25 @@ cmd_grlog(ProfWin *window, const char * const command, gchar **args)
 gboolean
 cmd_history(ProfWin *window, const char * const command, gchar **args)
 {
+    if (strcmp(args[0], "lines") == 0) {
+        if (args[1] == NULL) {
+            cons_bad_cmd_usage(command);
+            return TRUE;
+        }
+
+        int intval = 0;
+        char *err_msg = NULL;
+        gboolean res = strtoi_range(args[1], &intval, 1, INT_MAX, &err_msg);
+        if (res) {
+            prefs_set_history_lines(intval);
+            cons_show("Chat history lines set to %d", intval);
+        } else {
+            cons_show(err_msg);
+            free(err_msg);
+        }
+        return TRUE;
+    }
+
     gboolean result = _cmd_set_boolean_preference(args[0], command, "Chat history", PREF_HISTORY);
 
     // if set to on, set chlog
@@ -4463,9 +4661,8 @@ cmd_otr(ProfWin *window, const char * const command, gchar **args)
 
     } else if (strcmp(args[0], "policy") == 0) {
         if (args[1] == NULL) {
-            char *policy = prefs_get_string(PREF_OTR_POLICY);
+            const char *policy = prefs_get_string(PREF_OTR_POLICY);
             cons_show("OTR policy is now set to: %s", policy);
-            prefs_free_string(policy);
             return TRUE;
         }
 
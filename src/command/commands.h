@@ -133,6 +133,9 @@ gboolean cmd_winstidy(ProfWin *window, const char * const command, gchar **args)
 gboolean cmd_xa(ProfWin *window, const char * const command, gchar **args);
 gboolean cmd_alias(ProfWin *window, const char * const command, gchar **args);
 gboolean cmd_xmlconsole(ProfWin *window, const char * const command, gchar **args);
+gboolean cmd_search(ProfWin *window, const char * const command, gchar **args);
+gboolean cmd_perf(ProfWin *window, const char * const command, gchar **args);
+gboolean cmd_capture(ProfWin *window, const char * const command, gchar **args);
 gboolean cmd_ping(ProfWin *window, const char * const command, gchar **args);
 gboolean cmd_form(ProfWin *window, const char * const command, gchar **args);
 gboolean cmd_occupants(ProfWin *window, const char * const command, gchar **args);
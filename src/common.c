@@ -41,8 +41,6 @@
 #include <sys/types.h>
 #include <sys/stat.h>
 
-#include <curl/curl.h>
-#include <curl/easy.h>
 #include <glib.h>
 
 #include "tools/p_sha1.h"
@@ -51,16 +49,8 @@
 #include "common.h"
 
 
-struct curl_data_t
-{
-    char *buffer;
-    size_t size;
-};
-
 static unsigned long unique_id = 0;
 
-static size_t _data_callback(void *ptr, size_t size, size_t nmemb, void *data);
-
 // taken from glib 2.30.3
 gchar *
 p_utf8_substring(const gchar *str, glong start_pos, glong end_pos)
@@ -109,6 +99,12 @@ p_hash_table_contains(GHashTable  *hash_table, gconstpointer key)
     return (found != NULL);
 }
 
+GThread *
+p_thread_try_new(const gchar *name, GThreadFunc func, gpointer data, GError **error)
+{
+    return g_thread_create(func, data, TRUE, error);
+}
+
 gboolean
 create_dir(char *name)
 {
@@ -303,34 +299,8 @@ prof_getline(FILE *stream)
     return s;
 }
 
-char *
-release_get_latest()
-{
-    char *url = "http://www.profanity.im/profanity_version.txt";
-
-    CURL *handle = curl_easy_init();
-    struct curl_data_t output;
-    output.buffer = NULL;
-    output.size = 0;
-
-    curl_easy_setopt(handle, CURLOPT_URL, url);
-    curl_easy_setopt(handle, CURLOPT_WRITEFUNCTION, _data_callback);
-    curl_easy_setopt(handle, CURLOPT_TIMEOUT, 2);
-    curl_easy_setopt(handle, CURLOPT_WRITEDATA, (void *)&output);
-
-    curl_easy_perform(handle);
-    curl_easy_cleanup(handle);
-
-    if (output.buffer) {
-        output.buffer[output.size++] = '\0';
-        return output.buffer;
-    } else {
-        return NULL;
-    }
-}
-
 gboolean
-release_is_new(char *found_version)
+release_is_new(const char * const found_version)
 {
     int curr_maj, curr_min, curr_patch, found_maj, found_min, found_patch;
 
@@ -575,23 +545,6 @@ get_next_available_win_num(GList *used)
 }
 
 
-static size_t
-_data_callback(void *ptr, size_t size, size_t nmemb, void *data)
-{
-    size_t realsize = size * nmemb;
-    struct curl_data_t *mem = (struct curl_data_t *) data;
-    mem->buffer = realloc(mem->buffer, mem->size + realsize + 1);
-
-    if ( mem->buffer )
-    {
-        memcpy( &( mem->buffer[ mem->size ] ), ptr, realsize );
-        mem->size += realsize;
-        mem->buffer[ mem->size ] = 0;
-    }
-
-    return realsize;
-}
-
 char*
 get_file_or_linked(char *loc, char *basedir)
 {
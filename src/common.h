@@ -52,6 +52,7 @@
 #if !GLIB_CHECK_VERSION(2,32,0)
 #define g_hash_table_add(hash_table, key)           p_hash_table_add(hash_table, key)
 #define g_hash_table_contains(hash_table, key)      p_hash_table_contains(hash_table, key)
+#define g_thread_try_new(name, func, data, error)   p_thread_try_new(name, func, data, error)
 #endif
 
 #ifndef NOTIFY_CHECK_VERSION
@@ -99,6 +100,7 @@ void p_slist_free_full(GSList *items, GDestroyNotify free_func);
 void p_list_free_full(GList *items, GDestroyNotify free_func);
 gboolean p_hash_table_add(GHashTable *hash_table, gpointer key);
 gboolean p_hash_table_contains(GHashTable  *hash_table, gconstpointer  key);
+GThread* p_thread_try_new(const gchar *name, GThreadFunc func, gpointer data, GError **error);
 
 gboolean create_dir(char *name);
 gboolean mkdir_recursive(const char *dir);
@@ -109,8 +111,7 @@ int str_contains(const char str[], int size, char ch);
 gboolean strtoi_range(char *str, int *saveptr, int min, int max, char **err_msg);
 int utf8_display_len(const char * const str);
 char * prof_getline(FILE *stream);
-char* release_get_latest(void);
-gboolean release_is_new(char *found_version);
+gboolean release_is_new(const char * const found_version);
 gchar * xdg_get_config_home(void);
 gchar * xdg_get_data_home(void);
 
@@ -150,9 +150,57 @@ account_new(const gchar * const name, const gchar * const jid,
         new_account->pgp_keyid = NULL;
     }
 
+    new_account->refcount = 1;
+
     return new_account;
 }
 
+ProfAccount*
+account_ref(ProfAccount *account)
+{
+    if (account) {
+        account->refcount++;
+    }
+
+    return account;
+}
+
+ProfAccount*
+account_copy(ProfAccount *account)
+{
+    if (account == NULL) {
+        return NULL;
+    }
+
+    GList *otr_manual = NULL;
+    GList *curr = account->otr_manual;
+    while (curr) {
+        otr_manual = g_list_append(otr_manual, strdup(curr->data));
+        curr = g_list_next(curr);
+    }
+
+    GList *otr_opportunistic = NULL;
+    curr = account->otr_opportunistic;
+    while (curr) {
+        otr_opportunistic = g_list_append(otr_opportunistic, strdup(curr->data));
+        curr = g_list_next(curr);
+    }
+
+    GList *otr_always = NULL;
+    curr = account->otr_always;
+    while (curr) {
+        otr_always = g_list_append(otr_always, strdup(curr->data));
+        curr = g_list_next(curr);
+    }
+
+    return account_new(account->name, account->jid, account->password, account->eval_password,
+        account->enabled, account->server, account->port, account->resource,
+        account->last_presence, account->login_presence, account->priority_online,
+        account->priority_chat, account->priority_away, account->priority_xa,
+        account->priority_dnd, account->muc_service, account->muc_nick,
+        account->otr_policy, otr_manual, otr_opportunistic, otr_always, account->pgp_keyid);
+}
+
 char *
 account_create_full_jid(ProfAccount *account)
 {
@@ -205,6 +253,11 @@ void
 account_free(ProfAccount *account)
 {
     if (account) {
+        account->refcount--;
+        if (account->refcount > 0) {
+            return;
+        }
+
         free(account->name);
         free(account->jid);
         free(account->password);
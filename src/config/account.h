@@ -60,6 +60,7 @@ typedef struct prof_account_t {
     GList *otr_opportunistic;
     GList *otr_always;
     gchar *pgp_keyid;
+    int refcount;
 } ProfAccount;
 
 ProfAccount* account_new(const gchar * const name, const gchar * const jid,
@@ -70,8 +71,12 @@ ProfAccount* account_new(const gchar * const name, const gchar * const jid,
     const gchar * const muc_service, const gchar * const muc_nick,
     const gchar * const otr_policy, GList *otr_manual, GList *otr_opportunistic,
     GList *otr_always, const gchar * const pgp_keyid);
+ProfAccount* account_ref(ProfAccount *account);
+ProfAccount* account_copy(ProfAccount *account);
 char* account_create_full_jid(ProfAccount *account);
 gboolean account_eval_password(ProfAccount *account);
+
+// drops a reference, the account is freed when the last one goes
 void account_free(ProfAccount *account);
 
 #endif
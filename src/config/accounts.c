@@ -45,6 +45,7 @@
 #include "jid.h"
 #include "log.h"
 #include "tools/autocomplete.h"
+#include "tools/persist.h"
 #include "xmpp/xmpp.h"
 
 static gchar *accounts_loc;
@@ -52,6 +53,10 @@ static GKeyFile *accounts;
 
 static Autocomplete all_ac;
 static Autocomplete enabled_ac;
+static PersistStore accounts_store;
+
+// account name -> ProfAccount snapshot, dropped whenever the key file is saved
+static GHashTable *account_cache;
 
 // used to rename account (copies properties to new account)
 static gchar *string_keys[] = {
@@ -70,6 +75,8 @@ static gchar *string_keys[] = {
 
 static void _fix_legacy_accounts(const char * const account_name);
 static void _save_accounts(void);
+static void _write_accounts(void);
+static ProfAccount* _load_account(const char * const name);
 static gchar * _get_accounts_file(void);
 static void _remove_from_list(GKeyFile *accounts, const char * const account_name, const char * const key, const char * const contact_jid);
 
@@ -80,6 +87,7 @@ accounts_load(void)
     log_info("Loading accounts");
     all_ac = autocomplete_new();
     enabled_ac = autocomplete_new();
+    account_cache = g_hash_table_new_full(g_str_hash, g_str_equal, g_free, (GDestroyNotify)account_free);
     accounts_loc = _get_accounts_file();
 
     if (g_file_test(accounts_loc, G_FILE_TEST_EXISTS)) {
@@ -89,6 +97,7 @@ accounts_load(void)
     accounts = g_key_file_new();
     g_key_file_load_from_file(accounts, accounts_loc, G_KEY_FILE_KEEP_COMMENTS,
         NULL);
+    accounts_store = persist_store_new("accounts", _write_accounts);
 
     // create the logins searchable list for autocompletion
     gsize naccounts;
@@ -113,6 +122,10 @@ accounts_close(void)
 {
     autocomplete_free(all_ac);
     autocomplete_free(enabled_ac);
+    g_hash_table_destroy(account_cache);
+    account_cache = NULL;
+    persist_store_free(accounts_store);
+    accounts_store = NULL;
     g_key_file_free(accounts);
 }
 
@@ -212,6 +225,21 @@ accounts_get_list(void)
 
 ProfAccount*
 accounts_get_account(const char * const name)
+{
+    ProfAccount *account = g_hash_table_lookup(account_cache, name);
+    if (account == NULL) {
+        account = _load_account(name);
+        if (account == NULL) {
+            return NULL;
+        }
+        g_hash_table_insert(account_cache, strdup(name), account);
+    }
+
+    return account_ref(account);
+}
+
+static ProfAccount*
+_load_account(const char * const name)
 {
     if (!g_key_file_has_group(accounts, name)) {
         return NULL;
@@ -725,27 +753,34 @@ gint
 accounts_get_priority_for_presence_type(const char * const account_name,
     resource_presence_t presence_type)
 {
+    ProfAccount *account = accounts_get_account(account_name);
+    if (account == NULL) {
+        return 0;
+    }
+
     gint result;
 
     switch (presence_type)
     {
         case (RESOURCE_ONLINE):
-            result = g_key_file_get_integer(accounts, account_name, "priority.online", NULL);
+            result = account->priority_online;
             break;
         case (RESOURCE_CHAT):
-            result = g_key_file_get_integer(accounts, account_name, "priority.chat", NULL);
+            result = account->priority_chat;
             break;
         case (RESOURCE_AWAY):
-            result = g_key_file_get_integer(accounts, account_name, "priority.away", NULL);
+            result = account->priority_away;
             break;
         case (RESOURCE_XA):
-            result = g_key_file_get_integer(accounts, account_name, "priority.xa", NULL);
+            result = account->priority_xa;
             break;
         default:
-            result = g_key_file_get_integer(accounts, account_name, "priority.dnd", NULL);
+            result = account->priority_dnd;
             break;
     }
 
+    account_free(account);
+
     if (result < JABBER_PRIORITY_MIN || result > JABBER_PRIORITY_MAX)
         result = 0;
 
@@ -773,28 +808,15 @@ accounts_set_login_presence(const char * const account_name, const char * const
 resource_presence_t
 accounts_get_last_presence(const char * const account_name)
 {
-    resource_presence_t result;
-    gchar *setting = g_key_file_get_string(accounts, account_name, "presence.last", NULL);
+    resource_presence_t result = RESOURCE_ONLINE;
 
-    if (setting == NULL || (strcmp(setting, "online") == 0)) {
-        result = RESOURCE_ONLINE;
-    } else if (strcmp(setting, "chat") == 0) {
-        result = RESOURCE_CHAT;
-    } else if (strcmp(setting, "away") == 0) {
-        result = RESOURCE_AWAY;
-    } else if (strcmp(setting, "xa") == 0) {
-        result = RESOURCE_XA;
-    } else if (strcmp(setting, "dnd") == 0) {
-        result = RESOURCE_DND;
-    } else {
-        log_warning("Error reading presence.last for account: '%s', value: '%s', defaulting to 'online'",
-            account_name, setting);
-        result = RESOURCE_ONLINE;
+    // called every main loop iteration, so read from the cached account
+    ProfAccount *account = accounts_get_account(account_name);
+    if (account) {
+        result = resource_presence_from_string(account->last_presence);
+        account_free(account);
     }
 
-    if (setting) {
-        g_free(setting);
-    }
     return result;
 }
 
@@ -880,6 +902,13 @@ _fix_legacy_accounts(const char * const account_name)
 
 static void
 _save_accounts(void)
+{
+    g_hash_table_remove_all(account_cache);
+    persist_store_changed(accounts_store);
+}
+
+static void
+_write_accounts(void)
 {
     gsize g_data_size;
     gchar *g_accounts_data = g_key_file_to_data(accounts, &g_data_size, NULL);
@@ -887,8 +916,7 @@ _save_accounts(void)
     GString *base_str = g_string_new(xdg_data);
     g_string_append(base_str, "/profanity/");
     gchar *true_loc = get_file_or_linked(accounts_loc, base_str->str);
-    g_file_set_contents(true_loc, g_accounts_data, g_data_size, NULL);
-    g_chmod(accounts_loc, S_IRUSR | S_IWUSR);
+    persist_write_file(true_loc, g_accounts_data, g_data_size);
     g_free(xdg_data);
     free(true_loc);
     g_free(g_accounts_data);
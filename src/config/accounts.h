@@ -50,6 +50,7 @@ void accounts_reset_enabled_search(void);
 void accounts_add(const char *jid, const char *altdomain, const int port);
 int  accounts_remove(const char *jid);
 gchar** accounts_get_list(void);
+// returns a shared snapshot, release with account_free and use account_copy before modifying
 ProfAccount* accounts_get_account(const char * const name);
 gboolean accounts_enable(const char * const name);
 gboolean accounts_disable(const char * const name);
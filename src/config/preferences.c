@@ -45,6 +45,7 @@
 #include "log.h"
 #include "preferences.h"
 #include "tools/autocomplete.h"
+#include "tools/persist.h"
 
 // preference groups refer to the sections in .profrc, for example [ui]
 #define PREF_GROUP_LOGGING "logging"
@@ -58,19 +59,59 @@
 #define PREF_GROUP_PGP "pgp"
 
 #define INPBLOCK_DEFAULT 1000
+#define LOG_QUEUE_DEFAULT 1000
+#define HISTORY_LINES_DEFAULT 100
 
 static gchar *prefs_loc;
 static GKeyFile *prefs;
 gint log_maxsize = 0;
 
 static Autocomplete boolean_choice_ac;
+static PersistStore prefs_store;
+
+// values of the boolean and string preferences, indexed by preference_t
+// string preferences only fill string, boolean preferences only fill boolean
+// strings are owned by the cache and replaced when the preference is set
+static struct {
+    gboolean boolean;
+    char *string;
+} pref_cache[PREF_COUNT];
+
+// preferences read with prefs_get_string, and their defaults if not specified
+// in .profrc, all other preferences with a group and key are booleans
+typedef struct string_pref_t {
+    preference_t pref;
+    const char *def;
+} StringPref;
+
+static const StringPref string_prefs[] = {
+    { PREF_THEME, NULL },
+    { PREF_STATUSES_CONSOLE, "all" },
+    { PREF_STATUSES_CHAT, "all" },
+    { PREF_STATUSES_MUC, "all" },
+    { PREF_ROSTER_BY, "presence" },
+    { PREF_TIME, "%H:%M:%S" },
+    { PREF_TIME_STATUSBAR, "%H:%M" },
+    { PREF_NOTIFY_ROOM, "on" },
+    { PREF_AUTOAWAY_MODE, "off" },
+    { PREF_AUTOAWAY_MESSAGE, NULL },
+    { PREF_CONNECT_ACCOUNT, NULL },
+    { PREF_DEFAULT_ACCOUNT, NULL },
+    { PREF_OTR_LOG, "redact" },
+    { PREF_OTR_POLICY, "manual" },
+    { PREF_PGP_LOG, "redact" },
+};
 
 static void _save_prefs(void);
+static void _write_prefs(void);
+static void _cache_load(void);
+static void _cache_update(preference_t pref);
+static void _cache_clear(void);
 static gchar * _get_preferences_file(void);
 static const char * _get_group(preference_t pref);
 static const char * _get_key(preference_t pref);
 static gboolean _get_default_boolean(preference_t pref);
-static char * _get_default_string(preference_t pref);
+static const StringPref * _get_string_pref(preference_t pref);
 
 void
 prefs_load(void)
@@ -85,6 +126,7 @@ prefs_load(void)
     prefs = g_key_file_new();
     g_key_file_load_from_file(prefs, prefs_loc, G_KEY_FILE_KEEP_COMMENTS,
         NULL);
+    prefs_store = persist_store_new("preferences", _write_prefs);
 
     err = NULL;
     log_maxsize = g_key_file_get_integer(prefs, PREF_GROUP_LOGGING, "maxsize", &err);
@@ -113,7 +155,7 @@ prefs_load(void)
         } else if (g_strcmp0(time, "off") == 0) {
             g_key_file_set_string(prefs, PREF_GROUP_UI, "time", "");
         }
-        prefs_free_string(time);
+        g_free(time);
     }
     if (g_key_file_has_key(prefs, PREF_GROUP_UI, "time.statusbar", NULL)) {
         char *time = g_key_file_get_string(prefs, PREF_GROUP_UI, "time.statusbar", NULL);
@@ -124,10 +166,11 @@ prefs_load(void)
         } else if (g_strcmp0(time, "off") == 0) {
             g_key_file_set_string(prefs, PREF_GROUP_UI, "time.statusbar", "");
         }
-        prefs_free_string(time);
+        g_free(time);
     }
 
     _save_prefs();
+    _cache_load();
 
     boolean_choice_ac = autocomplete_new();
     autocomplete_add(boolean_choice_ac, "on");
@@ -138,6 +181,9 @@ void
 prefs_close(void)
 {
     autocomplete_free(boolean_choice_ac);
+    _cache_clear();
+    persist_store_free(prefs_store);
+    prefs_store = NULL;
     g_key_file_free(prefs);
     prefs = NULL;
 }
@@ -157,15 +203,7 @@ prefs_reset_boolean_choice(void)
 gboolean
 prefs_get_boolean(preference_t pref)
 {
-    const char *group = _get_group(pref);
-    const char *key = _get_key(pref);
-    gboolean def = _get_default_boolean(pref);
-
-    if (!g_key_file_has_key(prefs, group, key, NULL)) {
-        return def;
-    }
-
-    return g_key_file_get_boolean(prefs, group, key, NULL);
+    return pref_cache[pref].boolean;
 }
 
 void
@@ -174,39 +212,17 @@ prefs_set_boolean(preference_t pref, gboolean value)
     const char *group = _get_group(pref);
     const char *key = _get_key(pref);
     g_key_file_set_boolean(prefs, group, key, value);
+    _cache_update(pref);
     _save_prefs();
 }
 
-char *
+// the returned string belongs to the cache, it is valid until the preference is next set
+const char *
 prefs_get_string(preference_t pref)
 {
-    const char *group = _get_group(pref);
-    const char *key = _get_key(pref);
-    char *def = _get_default_string(pref);
-
-    char *result = g_key_file_get_string(prefs, group, key, NULL);
-
-    if (result == NULL) {
-        if (def) {
-            return g_strdup(def);
-        } else {
-            return NULL;
-        }
-    } else {
-        return result;
-    }
-}
-
-void
-prefs_free_string(char *pref)
-{
-    if (pref) {
-        g_free(pref);
-    }
-    pref = NULL;
+    return pref_cache[pref].string;
 }
 
-
 void
 prefs_set_string(preference_t pref, char *value)
 {
@@ -217,6 +233,7 @@ prefs_set_string(preference_t pref, char *value)
     } else {
         g_key_file_set_string(prefs, group, key, value);
     }
+    _cache_update(pref);
     _save_prefs();
 }
 
@@ -263,6 +280,44 @@ prefs_set_max_log_size(gint value)
     _save_prefs();
 }
 
+gint
+prefs_get_log_queue_size(void)
+{
+    gint result = g_key_file_get_integer(prefs, PREF_GROUP_LOGGING, "queue", NULL);
+
+    if (result < 1) {
+        return LOG_QUEUE_DEFAULT;
+    } else {
+        return result;
+    }
+}
+
+void
+prefs_set_log_queue_size(gint value)
+{
+    g_key_file_set_integer(prefs, PREF_GROUP_LOGGING, "queue", value);
+    _save_prefs();
+}
+
+gint
+prefs_get_history_lines(void)
+{
+    gint result = g_key_file_get_integer(prefs, PREF_GROUP_UI, "history.lines", NULL);
+
+    if (result < 1) {
+        return HISTORY_LINES_DEFAULT;
+    } else {
+        return result;
+    }
+}
+
+void
+prefs_set_history_lines(gint value)
+{
+    g_key_file_set_integer(prefs, PREF_GROUP_UI, "history.lines", value);
+    _save_prefs();
+}
+
 gint prefs_get_inpblock(void)
 {
     int val = g_key_file_get_integer(prefs, PREF_GROUP_UI, "inpblock", NULL);
@@ -517,6 +572,12 @@ prefs_free_aliases(GList *aliases)
 
 static void
 _save_prefs(void)
+{
+    persist_store_changed(prefs_store);
+}
+
+static void
+_write_prefs(void)
 {
     gsize g_data_size;
     gchar *g_prefs_data = g_key_file_to_data(prefs, &g_data_size, NULL);
@@ -524,14 +585,64 @@ _save_prefs(void)
     GString *base_str = g_string_new(xdg_config);
     g_string_append(base_str, "/profanity/");
     gchar *true_loc = get_file_or_linked(prefs_loc, base_str->str);
-    g_file_set_contents(true_loc, g_prefs_data, g_data_size, NULL);
-    g_chmod(prefs_loc, S_IRUSR | S_IWUSR);
+    persist_write_file(true_loc, g_prefs_data, g_data_size);
     g_free(xdg_config);
     free(true_loc);
     g_free(g_prefs_data);
     g_string_free(base_str, TRUE);
 }
 
+static void
+_cache_load(void)
+{
+    int i;
+    for (i = 0; i < PREF_COUNT; i++) {
+        _cache_update(i);
+    }
+}
+
+// read a single preference from the key file, falling back to its default
+static void
+_cache_update(preference_t pref)
+{
+    const char *group = _get_group(pref);
+    const char *key = _get_key(pref);
+
+    // integer preferences such as PREF_ROSTER_SIZE have no group or key
+    if (group == NULL || key == NULL) {
+        return;
+    }
+
+    const StringPref *string_pref = _get_string_pref(pref);
+    if (!string_pref) {
+        if (g_key_file_has_key(prefs, group, key, NULL)) {
+            pref_cache[pref].boolean = g_key_file_get_boolean(prefs, group, key, NULL);
+        } else {
+            pref_cache[pref].boolean = _get_default_boolean(pref);
+        }
+        return;
+    }
+
+    char *result = g_key_file_get_string(prefs, group, key, NULL);
+    if (result == NULL && string_pref->def) {
+        result = g_strdup(string_pref->def);
+    }
+
+    g_free(pref_cache[pref].string);
+    pref_cache[pref].string = result;
+}
+
+static void
+_cache_clear(void)
+{
+    int i;
+    for (i = 0; i < PREF_COUNT; i++) {
+        g_free(pref_cache[i].string);
+        pref_cache[i].string = NULL;
+        pref_cache[i].boolean = FALSE;
+    }
+}
+
 static gchar *
 _get_preferences_file(void)
 {
@@ -602,6 +713,7 @@ _get_group(preference_t pref)
         case PREF_GRLOG:
         case PREF_LOG_ROTATE:
         case PREF_LOG_SHARED:
+        case PREF_LOG_ASYNC:
             return PREF_GROUP_LOGGING;
         case PREF_AUTOAWAY_CHECK:
         case PREF_AUTOAWAY_MODE:
@@ -714,6 +826,8 @@ _get_key(preference_t pref)
             return "rotate";
         case PREF_LOG_SHARED:
             return "shared";
+        case PREF_LOG_ASYNC:
+            return "async";
         case PREF_PRESENCE:
             return "presence";
         case PREF_WRAP:
@@ -760,6 +874,7 @@ _get_default_boolean(preference_t pref)
         case PREF_AUTOAWAY_CHECK:
         case PREF_LOG_ROTATE:
         case PREF_LOG_SHARED:
+        case PREF_LOG_ASYNC:
         case PREF_NOTIFY_MESSAGE:
         case PREF_NOTIFY_MESSAGE_CURRENT:
         case PREF_NOTIFY_ROOM_CURRENT:
@@ -786,34 +901,16 @@ _get_default_boolean(preference_t pref)
     }
 }
 
-// the default setting for a string type preference
-// if it is not specified in .profrc
-static char *
-_get_default_string(preference_t pref)
+// the entry of string_prefs for the preference, NULL for booleans
+static const StringPref *
+_get_string_pref(preference_t pref)
 {
-    switch (pref)
-    {
-        case PREF_AUTOAWAY_MODE:
-            return "off";
-        case PREF_NOTIFY_ROOM:
-            return "on";
-        case PREF_OTR_LOG:
-            return "redact";
-        case PREF_OTR_POLICY:
-            return "manual";
-        case PREF_STATUSES_CONSOLE:
-        case PREF_STATUSES_CHAT:
-        case PREF_STATUSES_MUC:
-            return "all";
-        case PREF_ROSTER_BY:
-            return "presence";
-        case PREF_TIME:
-            return "%H:%M:%S";
-        case PREF_TIME_STATUSBAR:
-            return "%H:%M";
-        case PREF_PGP_LOG:
-            return "redact";
-        default:
-            return NULL;
+    size_t i;
+    for (i = 0; i < sizeof(string_prefs) / sizeof(string_prefs[0]); i++) {
+        if (string_prefs[i].pref == pref) {
+            return &string_prefs[i];
+        }
     }
+
+    return NULL;
 }
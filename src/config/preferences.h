@@ -97,13 +97,16 @@ typedef enum {
     PREF_DEFAULT_ACCOUNT,
     PREF_LOG_ROTATE,
     PREF_LOG_SHARED,
+    PREF_LOG_ASYNC,
     PREF_OTR_LOG,
     PREF_OTR_POLICY,
     PREF_RESOURCE_TITLE,
     PREF_RESOURCE_MESSAGE,
     PREF_INPBLOCK_DYNAMIC,
     PREF_ENC_WARN,
-    PREF_PGP_LOG
+    PREF_PGP_LOG,
+    // number of preferences, must be last
+    PREF_COUNT
 } preference_t;
 
 typedef struct prof_alias_t {
@@ -127,6 +130,10 @@ gint prefs_get_notify_remind(void);
 
 void prefs_set_max_log_size(gint value);
 gint prefs_get_max_log_size(void);
+void prefs_set_log_queue_size(gint value);
+gint prefs_get_log_queue_size(void);
+void prefs_set_history_lines(gint value);
+gint prefs_get_history_lines(void);
 gint prefs_get_priority(void);
 void prefs_set_reconnect(gint value);
 gint prefs_get_reconnect(void);
@@ -158,8 +165,7 @@ void prefs_free_aliases(GList *aliases);
 
 gboolean prefs_get_boolean(preference_t pref);
 void prefs_set_boolean(preference_t pref, gboolean value);
-char * prefs_get_string(preference_t pref);
-void prefs_free_string(char *pref);
+const char * prefs_get_string(preference_t pref);
 void prefs_set_string(preference_t pref, char *value);
 
 #endif
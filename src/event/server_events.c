@@ -39,11 +39,13 @@
 
 #include "chat_session.h"
 #include "log.h"
+#include "log_index.h"
 #include "muc.h"
 #include "config/preferences.h"
 #include "config/account.h"
 #include "roster_list.h"
 #include "window_list.h"
+#include "tools/perf.h"
 
 #ifdef HAVE_LIBOTR
 #include "otr/otr.h"
@@ -54,9 +56,15 @@
 
 #include "ui/ui.h"
 
+#ifdef HAVE_LIBGPGME
+static void _pgp_waiting_clear(void);
+#endif
+
 void
 sv_ev_login_account_success(char *account_name)
 {
+    gint64 perf = perf_start();
+
     ProfAccount *account = accounts_get_account(account_name);
 
 #ifdef HAVE_LIBOTR
@@ -64,11 +72,15 @@ sv_ev_login_account_success(char *account_name)
 #endif
 
 #ifdef HAVE_LIBGPGME
+    _pgp_waiting_clear();
     p_gpg_on_connect(account->jid);
 #endif
 
     ui_handle_login_account_success(account);
 
+    // searches use whatever has been indexed so far
+    log_index_start(account->jid);
+
     // attempt to rejoin rooms with passwords
     GList *curr = muc_rooms();
     while (curr) {
@@ -83,19 +95,27 @@ sv_ev_login_account_success(char *account_name)
 
     log_info("%s logged in successfully", account->jid);
     account_free(account);
+
+    perf_end(__func__, perf);
 }
 
 void
 sv_ev_roster_received(void)
 {
+    gint64 perf = perf_start();
+
     if (prefs_get_boolean(PREF_ROSTER)) {
         ui_show_roster();
     }
+
+    perf_end(__func__, perf);
 }
 
 void
 sv_ev_lost_connection(void)
 {
+    gint64 perf = perf_start();
+
     cons_show_error("Lost connection.");
     roster_clear();
     muc_invites_clear();
@@ -104,13 +124,19 @@ sv_ev_lost_connection(void)
 #ifdef HAVE_LIBGPGME
     p_gpg_on_disconnect();
 #endif
+
+    perf_end(__func__, perf);
 }
 
 void
 sv_ev_failed_login(void)
 {
+    gint64 perf = perf_start();
+
     cons_show_error("Login failed.");
     log_info("Login failed");
+
+    perf_end(__func__, perf);
 }
 
 void
@@ -118,43 +144,61 @@ sv_ev_room_invite(jabber_invite_t invite_type,
     const char * const invitor, const char * const room,
     const char * const reason, const char * const password)
 {
+    gint64 perf = perf_start();
+
     if (!muc_active(room) && !muc_invites_contain(room)) {
         cons_show_room_invite(invitor, room, reason);
         muc_invites_add(room, password);
     }
+
+    perf_end(__func__, perf);
 }
 
 void
 sv_ev_room_broadcast(const char *const room_jid,
     const char * const message)
 {
+    gint64 perf = perf_start();
+
     if (muc_roster_complete(room_jid)) {
         ui_room_broadcast(room_jid, message);
     } else {
         muc_pending_broadcasts_add(room_jid, message);
     }
+
+    perf_end(__func__, perf);
 }
 
 void
 sv_ev_room_subject(const char * const room, const char * const nick, const char * const subject)
 {
+    gint64 perf = perf_start();
+
     muc_set_subject(room, subject);
     if (muc_roster_complete(room)) {
         ui_room_subject(room, nick, subject);
     }
+
+    perf_end(__func__, perf);
 }
 
 void
 sv_ev_room_history(const char * const room_jid, const char * const nick,
     GDateTime *timestamp, const char * const message)
 {
+    gint64 perf = perf_start();
+
     ui_room_history(room_jid, nick, timestamp, message);
+
+    perf_end(__func__, perf);
 }
 
 void
 sv_ev_room_message(const char * const room_jid, const char * const nick,
     const char * const message)
 {
+    gint64 perf = perf_start();
+
     ui_room_message(room_jid, nick, message);
 
     if (prefs_get_boolean(PREF_GRLOG)) {
@@ -162,22 +206,32 @@ sv_ev_room_message(const char * const room_jid, const char * const nick,
         groupchat_log_chat(jid->barejid, room_jid, nick, message);
         jid_destroy(jid);
     }
+
+    perf_end(__func__, perf);
 }
 
 void
 sv_ev_incoming_private_message(const char * const fulljid, char *message)
 {
+    gint64 perf = perf_start();
+
     ui_incoming_private_msg(fulljid, message, NULL);
+
+    perf_end(__func__, perf);
 }
 
 void
 sv_ev_outgoing_carbon(char *barejid, char *message)
 {
+    gint64 perf = perf_start();
+
     ui_outgoing_chat_msg_carbon(barejid, message);
+
+    perf_end(__func__, perf);
 }
 
-void
-sv_ev_incoming_carbon(char *barejid, char *resource, char *message)
+static void
+_sv_ev_incoming_carbon(char *barejid, char *resource, char *message)
 {
     gboolean new_win = FALSE;
     ProfChatWin *chatwin = wins_get_chat(barejid);
@@ -191,11 +245,25 @@ sv_ev_incoming_carbon(char *barejid, char *resource, char *message)
     chat_log_msg_in(barejid, message);
 }
 
+static void
+_sv_ev_delayed_message(char *barejid, char *message, GDateTime *timestamp)
+{
+    gboolean new_win = FALSE;
+    ProfChatWin *chatwin = wins_get_chat(barejid);
+    if (!chatwin) {
+        ProfWin *window = wins_new_chat(barejid);
+        chatwin = (ProfChatWin*)window;
+        new_win = TRUE;
+    }
+
+    ui_incoming_msg(chatwin, NULL, message, timestamp, new_win, PROF_ENC_NONE);
+    chat_log_msg_in_delayed(barejid, message, timestamp);
+}
+
 #ifdef HAVE_LIBGPGME
 static void
-_sv_ev_incoming_pgp(ProfChatWin *chatwin, gboolean new_win, char *barejid, char *resource, char *message, char *pgp_message)
+_sv_ev_incoming_pgp(ProfChatWin *chatwin, gboolean new_win, char *barejid, char *resource, char *message, char *decrypted)
 {
-    char *decrypted = p_gpg_decrypt(pgp_message);
     if (decrypted) {
         if (chatwin->enc_mode == PROF_ENC_NONE) {
             win_println((ProfWin*)chatwin, 0, "PGP encryption enabled.");
@@ -203,7 +271,6 @@ _sv_ev_incoming_pgp(ProfChatWin *chatwin, gboolean new_win, char *barejid, char
         ui_incoming_msg(chatwin, resource, decrypted, NULL, new_win, PROF_ENC_PGP);
         chat_log_pgp_msg_in(barejid, decrypted);
         chatwin->enc_mode = PROF_ENC_PGP;
-        p_gpg_free_decrypted(decrypted);
     } else {
         ui_incoming_msg(chatwin, resource, message, NULL, new_win, PROF_ENC_NONE);
         chat_log_msg_in(barejid, message);
@@ -238,8 +305,9 @@ _sv_ev_incoming_plain(ProfChatWin *chatwin, gboolean new_win, char *barejid, cha
     chatwin->enc_mode = PROF_ENC_NONE;
 }
 
-void
-sv_ev_incoming_message(char *barejid, char *resource, char *message, char *pgp_message)
+// decrypted holds the result for a PGP message, which has already been through the gpg workers
+static void
+_sv_ev_incoming_message(char *barejid, char *resource, char *message, char *pgp_message, char *decrypted)
 {
     gboolean new_win = FALSE;
     ProfChatWin *chatwin = wins_get_chat(barejid);
@@ -256,7 +324,7 @@ sv_ev_incoming_message(char *barejid, char *resource, char *message, char *pgp_m
         if (chatwin->enc_mode == PROF_ENC_OTR) {
             win_println((ProfWin*)chatwin, 0, "PGP encrypted message received whilst in OTR session.");
         } else { // PROF_ENC_NONE, PROF_ENC_PGP
-            _sv_ev_incoming_pgp(chatwin, new_win, barejid, resource, message, pgp_message);
+            _sv_ev_incoming_pgp(chatwin, new_win, barejid, resource, message, decrypted);
         }
     } else {
         if (chatwin->enc_mode == PROF_ENC_PGP) {
@@ -282,7 +350,7 @@ sv_ev_incoming_message(char *barejid, char *resource, char *message, char *pgp_m
 #ifndef HAVE_LIBOTR
 #ifdef HAVE_LIBGPGME
     if (pgp_message) {
-        _sv_ev_incoming_pgp(chatwin, new_win, barejid, resource, message, pgp_message);
+        _sv_ev_incoming_pgp(chatwin, new_win, barejid, resource, message, decrypted);
     } else {
         _sv_ev_incoming_plain(chatwin, new_win, barejid, resource, message);
     }
@@ -299,78 +367,323 @@ sv_ev_incoming_message(char *barejid, char *resource, char *message, char *pgp_m
 #endif
 }
 
+#ifdef HAVE_LIBGPGME
+typedef enum {
+    PGP_INCOMING_MESSAGE,
+    PGP_INCOMING_CARBON,
+    PGP_INCOMING_DELAYED
+} pgp_incoming_kind_t;
+
+// an incoming message held until earlier PGP messages from the same contact are decrypted
+typedef struct pgp_incoming_t {
+    pgp_incoming_kind_t kind;
+    char *barejid;
+    char *resource;
+    char *message;
+    char *pgp_message;
+    char *decrypted;
+    // delayed messages only
+    GDateTime *timestamp;
+    // ready to be shown
+    gboolean done;
+    // a gpg job still refers to the message
+    gboolean decrypting;
+    // discarded while decrypting, freed when the job lets go
+    gboolean orphaned;
+} PGPIncoming;
+
+// barejid to queue of PGPIncoming, in arrival order
+static GHashTable *pgp_waiting;
+
+static void
+_pgp_incoming_free(PGPIncoming *incoming)
+{
+    if (incoming) {
+        free(incoming->barejid);
+        free(incoming->resource);
+        free(incoming->message);
+        free(incoming->pgp_message);
+        free(incoming->decrypted);
+        if (incoming->timestamp) {
+            g_date_time_unref(incoming->timestamp);
+        }
+        free(incoming);
+    }
+}
+
+static void
+_pgp_waiting_remove(const char * const barejid)
+{
+    GQueue *waiting = g_hash_table_lookup(pgp_waiting, barejid);
+    PGPIncoming *incoming = NULL;
+    while ((incoming = g_queue_pop_head(waiting)) != NULL) {
+        if (incoming->decrypting) {
+            incoming->orphaned = TRUE;
+        } else {
+            _pgp_incoming_free(incoming);
+        }
+    }
+    g_queue_free(waiting);
+    g_hash_table_remove(pgp_waiting, barejid);
+
+    if (g_hash_table_size(pgp_waiting) == 0) {
+        g_hash_table_destroy(pgp_waiting);
+        pgp_waiting = NULL;
+    }
+}
+
+// discard everything still waiting, the results belong to the previous session
+static void
+_pgp_waiting_clear(void)
+{
+    while (pgp_waiting) {
+        GList *barejids = g_hash_table_get_keys(pgp_waiting);
+        char *barejid = strdup(barejids->data);
+        g_list_free(barejids);
+        _pgp_waiting_remove(barejid);
+        free(barejid);
+    }
+}
+
+// show messages from the front of the queue until one is still being decrypted
+static void
+_pgp_waiting_flush(const char * const barejid)
+{
+    GQueue *waiting = g_hash_table_lookup(pgp_waiting, barejid);
+    PGPIncoming *incoming = g_queue_peek_head(waiting);
+    while (incoming && incoming->done) {
+        g_queue_pop_head(waiting);
+        switch (incoming->kind) {
+        case PGP_INCOMING_CARBON:
+            _sv_ev_incoming_carbon(incoming->barejid, incoming->resource, incoming->message);
+            break;
+        case PGP_INCOMING_DELAYED:
+            _sv_ev_delayed_message(incoming->barejid, incoming->message, incoming->timestamp);
+            break;
+        default:
+            _sv_ev_incoming_message(incoming->barejid, incoming->resource, incoming->message,
+                incoming->pgp_message, incoming->decrypted);
+            break;
+        }
+        _pgp_incoming_free(incoming);
+        incoming = g_queue_peek_head(waiting);
+    }
+
+    if (g_queue_is_empty(waiting)) {
+        _pgp_waiting_remove(barejid);
+    }
+}
+
+// PGP messages are decrypted by the gpg workers, anything arriving from the same contact
+// meanwhile, including carbons and delayed messages, waits behind them so messages are
+// shown in arrival order
+// returns NULL when the message can be shown straight away
+static PGPIncoming *
+_pgp_waiting_push(pgp_incoming_kind_t kind, char *barejid, char *resource, char *message,
+    char *pgp_message, GDateTime *timestamp)
+{
+    GQueue *waiting = pgp_waiting ? g_hash_table_lookup(pgp_waiting, barejid) : NULL;
+    if (!pgp_message && !waiting) {
+        return NULL;
+    }
+
+    if (!waiting) {
+        if (!pgp_waiting) {
+            pgp_waiting = g_hash_table_new_full(g_str_hash, g_str_equal, free, NULL);
+        }
+        waiting = g_queue_new();
+        g_hash_table_insert(pgp_waiting, strdup(barejid), waiting);
+    }
+
+    PGPIncoming *incoming = malloc(sizeof(PGPIncoming));
+    incoming->kind = kind;
+    incoming->barejid = strdup(barejid);
+    incoming->resource = resource ? strdup(resource) : NULL;
+    incoming->message = message ? strdup(message) : NULL;
+    incoming->pgp_message = pgp_message ? strdup(pgp_message) : NULL;
+    incoming->decrypted = NULL;
+    incoming->timestamp = timestamp ? g_date_time_ref(timestamp) : NULL;
+    incoming->done = (pgp_message == NULL);
+    incoming->decrypting = (pgp_message != NULL);
+    incoming->orphaned = FALSE;
+    g_queue_push_tail(waiting, incoming);
+
+    return incoming;
+}
+
+static void
+_sv_ev_pgp_decrypted(const char * const decrypted, void *userdata)
+{
+    PGPIncoming *incoming = userdata;
+    incoming->decrypted = decrypted ? strdup(decrypted) : NULL;
+    incoming->done = TRUE;
+}
+
+// called when the gpg job is freed, after _sv_ev_pgp_decrypted unless the result was dropped
+static void
+_sv_ev_pgp_released(PGPIncoming *incoming)
+{
+    incoming->decrypting = FALSE;
+    if (incoming->orphaned) {
+        _pgp_incoming_free(incoming);
+        return;
+    }
+
+    char *barejid = strdup(incoming->barejid);
+    if (incoming->done) {
+        _pgp_waiting_flush(barejid);
+    } else {
+        // dropped after a disconnect or at shutdown, nothing behind it is shown
+        _pgp_waiting_remove(barejid);
+    }
+    free(barejid);
+}
+#endif
+
+void
+sv_ev_incoming_message(char *barejid, char *resource, char *message, char *pgp_message)
+{
+    gint64 perf = perf_start();
+
+#ifdef HAVE_LIBGPGME
+    PGPIncoming *incoming = _pgp_waiting_push(PGP_INCOMING_MESSAGE, barejid, resource, message,
+        pgp_message, NULL);
+    if (incoming) {
+        if (pgp_message) {
+            p_gpg_decrypt_async(pgp_message, _sv_ev_pgp_decrypted, incoming, (GDestroyNotify)_sv_ev_pgp_released);
+        }
+
+        perf_end(__func__, perf);
+        return;
+    }
+#endif
+
+    _sv_ev_incoming_message(barejid, resource, message, pgp_message, NULL);
+
+    perf_end(__func__, perf);
+}
+
+void
+sv_ev_incoming_carbon(char *barejid, char *resource, char *message)
+{
+    gint64 perf = perf_start();
+
+#ifdef HAVE_LIBGPGME
+    if (_pgp_waiting_push(PGP_INCOMING_CARBON, barejid, resource, message, NULL, NULL)) {
+        perf_end(__func__, perf);
+        return;
+    }
+#endif
+
+    _sv_ev_incoming_carbon(barejid, resource, message);
+
+    perf_end(__func__, perf);
+}
+
 void
 sv_ev_delayed_private_message(const char * const fulljid, char *message, GDateTime *timestamp)
 {
+    gint64 perf = perf_start();
+
     ui_incoming_private_msg(fulljid, message, timestamp);
+
+    perf_end(__func__, perf);
 }
 
 void
 sv_ev_delayed_message(char *barejid, char *message, GDateTime *timestamp)
 {
-    gboolean new_win = FALSE;
-    ProfChatWin *chatwin = wins_get_chat(barejid);
-    if (!chatwin) {
-        ProfWin *window = wins_new_chat(barejid);
-        chatwin = (ProfChatWin*)window;
-        new_win = TRUE;
+    gint64 perf = perf_start();
+
+#ifdef HAVE_LIBGPGME
+    if (_pgp_waiting_push(PGP_INCOMING_DELAYED, barejid, NULL, message, NULL, timestamp)) {
+        perf_end(__func__, perf);
+        return;
     }
+#endif
 
-    ui_incoming_msg(chatwin, NULL, message, timestamp, new_win, PROF_ENC_NONE);
-    chat_log_msg_in_delayed(barejid, message, timestamp);
+    _sv_ev_delayed_message(barejid, message, timestamp);
+
+    perf_end(__func__, perf);
 }
 
 void
 sv_ev_message_receipt(char *barejid, char *id)
 {
+    gint64 perf = perf_start();
+
     ui_message_receipt(barejid, id);
+
+    perf_end(__func__, perf);
 }
 
 void
 sv_ev_typing(char *barejid, char *resource)
 {
+    gint64 perf = perf_start();
+
     ui_contact_typing(barejid, resource);
     if (ui_chat_win_exists(barejid)) {
         chat_session_recipient_typing(barejid, resource);
     }
+
+    perf_end(__func__, perf);
 }
 
 void
 sv_ev_paused(char *barejid, char *resource)
 {
+    gint64 perf = perf_start();
+
     if (ui_chat_win_exists(barejid)) {
         chat_session_recipient_paused(barejid, resource);
     }
+
+    perf_end(__func__, perf);
 }
 
 void
 sv_ev_inactive(char *barejid, char *resource)
 {
+    gint64 perf = perf_start();
+
     if (ui_chat_win_exists(barejid)) {
         chat_session_recipient_inactive(barejid, resource);
     }
+
+    perf_end(__func__, perf);
 }
 
 void
 sv_ev_gone(const char * const barejid, const char * const resource)
 {
+    gint64 perf = perf_start();
+
     ui_recipient_gone(barejid, resource);
     if (ui_chat_win_exists(barejid)) {
         chat_session_recipient_gone(barejid, resource);
     }
+
+    perf_end(__func__, perf);
 }
 
 void
 sv_ev_activity(const char * const barejid, const char * const resource, gboolean send_states)
 {
+    gint64 perf = perf_start();
+
     if (ui_chat_win_exists(barejid)) {
         chat_session_recipient_active(barejid, resource, send_states);
     }
+
+    perf_end(__func__, perf);
 }
 
 void
 sv_ev_subscription(const char *barejid, jabber_subscr_t type)
 {
+    gint64 perf = perf_start();
+
     switch (type) {
     case PRESENCE_SUBSCRIBE:
         /* TODO: auto-subscribe if needed */
@@ -395,24 +708,32 @@ sv_ev_subscription(const char *barejid, jabber_subscr_t type)
         /* unknown type */
         break;
     }
+
+    perf_end(__func__, perf);
 }
 
 void
 sv_ev_contact_offline(char *barejid, char *resource, char *status)
 {
+    gint64 perf = perf_start();
+
     gboolean updated = roster_contact_offline(barejid, resource, status);
 
     if (resource && updated) {
         ui_contact_offline(barejid, resource, status);
     }
 
-    rosterwin_roster();
+    rosterwin_roster_changed();
     chat_session_remove(barejid);
+
+    perf_end(__func__, perf);
 }
 
 void
 sv_ev_contact_online(char *barejid, Resource *resource, GDateTime *last_activity, char *pgpsig)
 {
+    gint64 perf = perf_start();
+
     gboolean updated = roster_update_presence(barejid, resource, last_activity);
 
     if (updated) {
@@ -425,90 +746,131 @@ sv_ev_contact_online(char *barejid, Resource *resource, GDateTime *last_activity
     }
 #endif
 
-    rosterwin_roster();
+    rosterwin_roster_changed();
     chat_session_remove(barejid);
+
+    perf_end(__func__, perf);
 }
 
 void
 sv_ev_leave_room(const char * const room)
 {
+    gint64 perf = perf_start();
+
     muc_leave(room);
     ui_leave_room(room);
+
+    perf_end(__func__, perf);
 }
 
 void
 sv_ev_room_destroy(const char * const room)
 {
+    gint64 perf = perf_start();
+
     muc_leave(room);
     ui_room_destroy(room);
+
+    perf_end(__func__, perf);
 }
 
 void
 sv_ev_room_destroyed(const char * const room, const char * const new_jid, const char * const password,
     const char * const reason)
 {
+    gint64 perf = perf_start();
+
     muc_leave(room);
     ui_room_destroyed(room, reason, new_jid, password);
+
+    perf_end(__func__, perf);
 }
 
 void
 sv_ev_room_kicked(const char * const room, const char * const actor, const char * const reason)
 {
+    gint64 perf = perf_start();
+
     muc_leave(room);
     ui_room_kicked(room, actor, reason);
+
+    perf_end(__func__, perf);
 }
 
 void
 sv_ev_room_banned(const char * const room, const char * const actor, const char * const reason)
 {
+    gint64 perf = perf_start();
+
     muc_leave(room);
     ui_room_banned(room, actor, reason);
+
+    perf_end(__func__, perf);
 }
 
 void
 sv_ev_room_occupant_offline(const char * const room, const char * const nick,
     const char * const show, const char * const status)
 {
+    gint64 perf = perf_start();
+
     muc_roster_remove(room, nick);
 
-    char *muc_status_pref = prefs_get_string(PREF_STATUSES_MUC);
+    const char *muc_status_pref = prefs_get_string(PREF_STATUSES_MUC);
     if (g_strcmp0(muc_status_pref, "none") != 0) {
         ui_room_member_offline(room, nick);
     }
-    prefs_free_string(muc_status_pref);
-    occupantswin_occupants(room);
+    occupantswin_occupants_changed(room);
+
+    perf_end(__func__, perf);
 }
 
 void
 sv_ev_room_occupent_kicked(const char * const room, const char * const nick, const char * const actor,
     const char * const reason)
 {
+    gint64 perf = perf_start();
+
     muc_roster_remove(room, nick);
     ui_room_member_kicked(room, nick, actor, reason);
-    occupantswin_occupants(room);
+    occupantswin_occupants_changed(room);
+
+    perf_end(__func__, perf);
 }
 
 void
 sv_ev_room_occupent_banned(const char * const room, const char * const nick, const char * const actor,
     const char * const reason)
 {
+    gint64 perf = perf_start();
+
     muc_roster_remove(room, nick);
     ui_room_member_banned(room, nick, actor, reason);
-    occupantswin_occupants(room);
+    occupantswin_occupants_changed(room);
+
+    perf_end(__func__, perf);
 }
 
 void
 sv_ev_roster_update(const char * const barejid, const char * const name,
     GSList *groups, const char * const subscription, gboolean pending_out)
 {
+    gint64 perf = perf_start();
+
     roster_update(barejid, name, groups, subscription, pending_out);
-    rosterwin_roster();
+    rosterwin_roster_changed();
+
+    perf_end(__func__, perf);
 }
 
 void
 sv_ev_xmpp_stanza(const char * const msg)
 {
+    gint64 perf = perf_start();
+
     ui_handle_stanza(msg);
+
+    perf_end(__func__, perf);
 }
 
 void
@@ -516,6 +878,8 @@ sv_ev_muc_self_online(const char * const room, const char * const nick, gboolean
     const char * const role, const char * const affiliation, const char * const actor, const char * const reason,
     const char * const jid, const char * const show, const char * const status)
 {
+    gint64 perf = perf_start();
+
     muc_roster_add(room, nick, jid, role, affiliation, show, status);
     char *old_role = muc_role_str(room);
     char *old_affiliation = muc_affiliation_str(room);
@@ -585,7 +949,9 @@ sv_ev_muc_self_online(const char * const room, const char * const nick, gboolean
         }
     }
 
-    occupantswin_occupants(room);
+    occupantswin_occupants_changed(room);
+
+    perf_end(__func__, perf);
 }
 
 void
@@ -593,6 +959,8 @@ sv_ev_muc_occupant_online(const char * const room, const char * const nick, cons
     const char * const role, const char * const affiliation, const char * const actor, const char * const reason,
     const char * const show, const char * const status)
 {
+    gint64 perf = perf_start();
+
     Occupant *occupant = muc_roster_item(room, nick);
 
     const char *old_role = NULL;
@@ -606,6 +974,7 @@ sv_ev_muc_occupant_online(const char * const room, const char * const nick, cons
 
     // not yet finished joining room
     if (!muc_roster_complete(room)) {
+        perf_end(__func__, perf);
         return;
     }
 
@@ -614,29 +983,29 @@ sv_ev_muc_occupant_online(const char * const room, const char * const nick, cons
     if (old_nick) {
         ui_room_member_nick_change(room, old_nick, nick);
         free(old_nick);
-        occupantswin_occupants(room);
+        occupantswin_occupants_changed(room);
+        perf_end(__func__, perf);
         return;
     }
 
     // joined room
     if (!occupant) {
-        char *muc_status_pref = prefs_get_string(PREF_STATUSES_MUC);
+        const char *muc_status_pref = prefs_get_string(PREF_STATUSES_MUC);
         if (g_strcmp0(muc_status_pref, "none") != 0) {
             ui_room_member_online(room, nick, role, affiliation, show, status);
         }
-        prefs_free_string(muc_status_pref);
-        occupantswin_occupants(room);
+        occupantswin_occupants_changed(room);
+        perf_end(__func__, perf);
         return;
     }
 
     // presence updated
     if (updated) {
-        char *muc_status_pref = prefs_get_string(PREF_STATUSES_MUC);
+        const char *muc_status_pref = prefs_get_string(PREF_STATUSES_MUC);
         if (g_strcmp0(muc_status_pref, "all") == 0) {
             ui_room_member_presence(room, nick, show, status);
         }
-        prefs_free_string(muc_status_pref);
-        occupantswin_occupants(room);
+        occupantswin_occupants_changed(room);
 
     // presence unchanged, check for role/affiliation change
     } else {
@@ -654,6 +1023,8 @@ sv_ev_muc_occupant_online(const char * const room, const char * const nick, cons
                 ui_room_occupant_affiliation_change(room, nick, affiliation, actor, reason);
             }
         }
-        occupantswin_occupants(room);
+        occupantswin_occupants_changed(room);
     }
+
+    perf_end(__func__, perf);
 }
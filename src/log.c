@@ -44,6 +44,7 @@
 #include "glib/gstdio.h"
 
 #include "log.h"
+#include "log_index.h"
 
 #include "common.h"
 #include "config/preferences.h"
@@ -51,16 +52,41 @@
 
 #define PROF "prof"
 
+// maximum number of chat log files kept open at once
+#define CHAT_LOG_MAX_OPEN 32
+// seconds between flushes of buffered chat log writes
+#define CHAT_LOG_FLUSH_INTERVAL 2
+
 static FILE *logp;
 GString *mainlogfile;
 
 static GTimeZone *tz;
-static GDateTime *dt;
 static log_level_t level_filter;
 
+// async mode, lines are written into preallocated records taken from
+// free_records and passed to the writer thread through pending_records
+// log_async and pushes to pending_records are guarded by log_queue
+G_LOCK_DEFINE_STATIC(log_queue);
+static gboolean log_async;
+static GThread *writer_thread;
+static GAsyncQueue *free_records;
+static GAsyncQueue *pending_records;
+// pushed after the last record when the queue closes
+static GString writer_stop;
+
+// logp, mainlogfile and the rotate settings are guarded by log_file
+G_LOCK_DEFINE_STATIC(log_file);
+
+// copies of the rotate prefs, so the writer thread does not read preferences
+static gboolean rotate_enabled;
+static gint rotate_max_size;
+
 static GHashTable *logs;
 static GHashTable *groupchat_logs;
-static GDateTime *session_started;
+
+// open chat logs, most recently written first
+static GQueue *open_logs;
+static GTimer *flush_timer;
 
 enum {
     STDERR_BUFSIZE = 4000,
@@ -75,12 +101,19 @@ static GString *stderr_msg;
 struct dated_chat_log {
     gchar *filename;
     GDateTime *date;
+    FILE *logp;
+    GList *open_link;
+    gboolean dirty;
 };
 
 static gboolean _log_roll_needed(struct dated_chat_log *dated_log);
 static struct dated_chat_log * _create_log(const char * const other, const  char * const login);
-static struct dated_chat_log * _create_groupchat_log(char *room, const char * const login);
+static struct dated_chat_log * _create_groupchat_log(const char * const room, const char * const login);
 static void _free_chat_log(struct dated_chat_log *dated_log);
+static FILE * _open_chat_log(struct dated_chat_log *dated_log);
+static void _close_chat_log(struct dated_chat_log *dated_log);
+static void _flush_chat_log(struct dated_chat_log *dated_log);
+static void _write_chat_log(struct dated_chat_log *dated_log, FILE *logp, const char * const line);
 static gboolean _key_equals(void *key1, void *key2);
 static char * _get_log_filename(const char * const other, const char * const login,
     GDateTime *dt, gboolean create);
@@ -88,7 +121,15 @@ static char * _get_groupchat_log_filename(const char * const room,
     const char * const login, GDateTime *dt, gboolean create);
 static gchar * _get_chatlog_dir(void);
 static gchar * _get_main_log_file(void);
+static void _log_open(void);
+static void _log_shut(void);
 static void _rotate_log_file(void);
+static void _check_log_size(gboolean rotate, gint max_size);
+static void _queue_init(void);
+static void _queue_close(void);
+static gboolean _queue_push(const char * const date_fmt, const char * const area,
+    const char * const level_str, const char * const msg);
+static gpointer _writer_run(gpointer data);
 static char* _log_string_from_level(log_level_t level);
 static void _chat_log_chat(const char * const login, const char * const other,
     const gchar * const msg, chat_log_direction_t direction, GDateTime *timestamp);
@@ -146,18 +187,62 @@ log_init(log_level_t filter)
 {
     level_filter = filter;
     tz = g_time_zone_new_local();
+    _log_open();
+}
+
+// level_filter and tz are left alone, worker threads may be reading them
+static void
+_log_open(void)
+{
     gchar *log_file = _get_main_log_file();
+    G_LOCK(log_file);
     logp = fopen(log_file, "a");
     g_chmod(log_file, S_IRUSR | S_IWUSR);
     mainlogfile = g_string_new(log_file);
+    gboolean opened = (logp != NULL);
+    G_UNLOCK(log_file);
     free(log_file);
+    log_update_rotate();
+
+    if (prefs_get_boolean(PREF_LOG_ASYNC) && opened) {
+        _queue_init();
+    }
+}
+
+static void
+_log_shut(void)
+{
+    // writes out anything still queued
+    _queue_close();
+
+    G_LOCK(log_file);
+    g_string_free(mainlogfile, TRUE);
+    mainlogfile = NULL;
+    if (logp) {
+        fclose(logp);
+        logp = NULL;
+    }
+    G_UNLOCK(log_file);
+}
+
+// call on the main thread whenever the rotate or maxsize prefs change
+void
+log_update_rotate(void)
+{
+    gboolean enabled = prefs_get_boolean(PREF_LOG_ROTATE);
+    gint max_size = prefs_get_max_log_size();
+
+    G_LOCK(log_file);
+    rotate_enabled = enabled;
+    rotate_max_size = max_size;
+    G_UNLOCK(log_file);
 }
 
 void
 log_reinit(void)
 {
-    log_close();
-    log_init(level_filter);
+    _log_shut();
+    _log_open();
 }
 
 char *
@@ -175,35 +260,33 @@ log_get_filter(void)
 void
 log_close(void)
 {
-    g_string_free(mainlogfile, TRUE);
+    _log_shut();
     g_time_zone_unref(tz);
-    if (logp) {
-        fclose(logp);
-    }
 }
 
+// may be called from worker threads, direct writes and rotation are done under log_file
 void
 log_msg(log_level_t level, const char * const area, const char * const msg)
 {
-    if (level >= level_filter && logp) {
-        dt = g_date_time_new_now(tz);
+    if (level >= level_filter) {
+        GDateTime *now = g_date_time_new_now(tz);
 
         char *level_str = _log_string_from_level(level);
 
-        gchar *date_fmt = g_date_time_format(dt, "%d/%m/%Y %H:%M:%S");
-
-        fprintf(logp, "%s: %s: %s: %s\n", date_fmt, area, level_str, msg);
-        g_date_time_unref(dt);
+        gchar *date_fmt = g_date_time_format(now, "%d/%m/%Y %H:%M:%S");
+        g_date_time_unref(now);
 
-        fflush(logp);
-        g_free(date_fmt);
-
-        if (prefs_get_boolean(PREF_LOG_ROTATE)) {
-            long result = ftell(logp);
-            if (result != -1 && result >= prefs_get_max_log_size()) {
-                _rotate_log_file();
+        if (!_queue_push(date_fmt, area, level_str, msg)) {
+            G_LOCK(log_file);
+            if (logp) {
+                fprintf(logp, "%s: %s: %s: %s\n", date_fmt, area, level_str, msg);
+                fflush(logp);
+                _check_log_size(rotate_enabled, rotate_max_size);
             }
+            G_UNLOCK(log_file);
         }
+
+        g_free(date_fmt);
     }
 }
 
@@ -224,10 +307,23 @@ log_level_from_string(char *log_level)
     }
 }
 
+// called after writing, under log_file
+static void
+_check_log_size(gboolean rotate, gint max_size)
+{
+    if (rotate) {
+        long result = ftell(logp);
+        if (result != -1 && result >= max_size) {
+            _rotate_log_file();
+        }
+    }
+}
+
+// reopens the log file in place, under log_file
 static void
 _rotate_log_file(void)
 {
-    gchar *log_file = _get_main_log_file();
+    char *log_file = mainlogfile->str;
     size_t len = strlen(log_file);
     char *log_file_new = malloc(len + 3);
 
@@ -236,20 +332,154 @@ _rotate_log_file(void)
     log_file_new[len+1] = '1';
     log_file_new[len+2] = 0;
 
-    log_close();
+    fclose(logp);
     rename(log_file, log_file_new);
-    log_init(log_get_filter());
+    logp = fopen(log_file, "a");
+    g_chmod(log_file, S_IRUSR | S_IWUSR);
 
     free(log_file_new);
-    free(log_file);
-    log_info("Log has been rotated");
+
+    if (logp) {
+        GDateTime *now = g_date_time_new_now(tz);
+        gchar *date_fmt = g_date_time_format(now, "%d/%m/%Y %H:%M:%S");
+        fprintf(logp, "%s: %s: %s: %s\n", date_fmt, PROF,
+            _log_string_from_level(PROF_LEVEL_INFO), "Log has been rotated");
+        fflush(logp);
+        g_free(date_fmt);
+        g_date_time_unref(now);
+    }
+}
+
+static void
+_queue_init(void)
+{
+    int size = prefs_get_log_queue_size();
+    free_records = g_async_queue_new();
+    pending_records = g_async_queue_new();
+    int i;
+    for (i = 0; i < size; i++) {
+        g_async_queue_push(free_records, g_string_sized_new(256));
+    }
+
+    writer_thread = g_thread_try_new("log writer", _writer_run, NULL, NULL);
+    if (writer_thread) {
+        G_LOCK(log_queue);
+        log_async = TRUE;
+        G_UNLOCK(log_queue);
+    } else {
+        _queue_close();
+    }
+}
+
+// stops the writer once it has written every queued record, later lines
+// are written directly
+static void
+_queue_close(void)
+{
+    G_LOCK(log_queue);
+    gboolean running = log_async;
+    log_async = FALSE;
+    if (running) {
+        g_async_queue_push(pending_records, &writer_stop);
+    }
+    G_UNLOCK(log_queue);
+
+    if (running) {
+        g_thread_join(writer_thread);
+        writer_thread = NULL;
+    }
+
+    GString *record;
+    if (free_records) {
+        while ((record = g_async_queue_try_pop(free_records)) != NULL) {
+            g_string_free(record, TRUE);
+        }
+        g_async_queue_unref(free_records);
+        free_records = NULL;
+    }
+    if (pending_records) {
+        while ((record = g_async_queue_try_pop(pending_records)) != NULL) {
+            if (record != &writer_stop) {
+                g_string_free(record, TRUE);
+            }
+        }
+        g_async_queue_unref(pending_records);
+        pending_records = NULL;
+    }
+}
+
+// returns FALSE when the line must be written directly, because async logging
+// is off or closed, or every record is waiting for the writer
+// a line written directly can land ahead of lines still queued
+static gboolean
+_queue_push(const char * const date_fmt, const char * const area,
+    const char * const level_str, const char * const msg)
+{
+    gboolean queued = FALSE;
+
+    G_LOCK(log_queue);
+    if (log_async) {
+        GString *record = g_async_queue_try_pop(free_records);
+        if (record) {
+            g_string_printf(record, "%s: %s: %s: %s\n", date_fmt, area, level_str, msg);
+            g_async_queue_push(pending_records, record);
+            queued = TRUE;
+        }
+    }
+    G_UNLOCK(log_queue);
+
+    return queued;
+}
+
+// writes pending records in batches and hands them back to free_records
+static gpointer
+_writer_run(gpointer data)
+{
+    GPtrArray *batch = g_ptr_array_new();
+    gboolean running = TRUE;
+
+    while (running) {
+        GString *record = g_async_queue_pop(pending_records);
+        while (record) {
+            if (record == &writer_stop) {
+                running = FALSE;
+                break;
+            }
+            g_ptr_array_add(batch, record);
+            record = g_async_queue_try_pop(pending_records);
+        }
+
+        G_LOCK(log_file);
+        guint i;
+        for (i = 0; i < batch->len; i++) {
+            record = g_ptr_array_index(batch, i);
+            if (logp) {
+                fwrite(record->str, 1, record->len, logp);
+            }
+        }
+        if (logp && batch->len > 0) {
+            fflush(logp);
+            _check_log_size(rotate_enabled, rotate_max_size);
+        }
+        G_UNLOCK(log_file);
+
+        for (i = 0; i < batch->len; i++) {
+            g_async_queue_push(free_records, g_ptr_array_index(batch, i));
+        }
+        g_ptr_array_set_size(batch, 0);
+    }
+
+    g_ptr_array_free(batch, TRUE);
+
+    return NULL;
 }
 
 void
 chat_log_init(void)
 {
-    session_started = g_date_time_new_now_local();
     log_info("Initialising chat logs");
+    open_logs = g_queue_new();
+    flush_timer = g_timer_new();
     logs = g_hash_table_new_full(g_str_hash, (GEqualFunc) _key_equals, free,
         (GDestroyNotify)_free_chat_log);
 }
@@ -279,13 +509,12 @@ chat_log_otr_msg_out(const char * const barejid, const char * const msg)
     if (prefs_get_boolean(PREF_CHLOG)) {
         const char *jid = jabber_get_fulljid();
         Jid *jidp = jid_create(jid);
-        char *pref_otr_log = prefs_get_string(PREF_OTR_LOG);
+        const char *pref_otr_log = prefs_get_string(PREF_OTR_LOG);
         if (strcmp(pref_otr_log, "on") == 0) {
             _chat_log_chat(jidp->barejid, barejid, msg, PROF_OUT_LOG, NULL);
         } else if (strcmp(pref_otr_log, "redact") == 0) {
             _chat_log_chat(jidp->barejid, barejid, "[redacted]", PROF_OUT_LOG, NULL);
         }
-        prefs_free_string(pref_otr_log);
         jid_destroy(jidp);
     }
 }
@@ -296,13 +525,12 @@ chat_log_pgp_msg_out(const char * const barejid, const char * const msg)
     if (prefs_get_boolean(PREF_CHLOG)) {
         const char *jid = jabber_get_fulljid();
         Jid *jidp = jid_create(jid);
-        char *pref_pgp_log = prefs_get_string(PREF_PGP_LOG);
+        const char *pref_pgp_log = prefs_get_string(PREF_PGP_LOG);
         if (strcmp(pref_pgp_log, "on") == 0) {
             _chat_log_chat(jidp->barejid, barejid, msg, PROF_OUT_LOG, NULL);
         } else if (strcmp(pref_pgp_log, "redact") == 0) {
             _chat_log_chat(jidp->barejid, barejid, "[redacted]", PROF_OUT_LOG, NULL);
         }
-        prefs_free_string(pref_pgp_log);
         jid_destroy(jidp);
     }
 }
@@ -313,13 +541,12 @@ chat_log_otr_msg_in(const char * const barejid, const char * const msg, gboolean
     if (prefs_get_boolean(PREF_CHLOG)) {
         const char *jid = jabber_get_fulljid();
         Jid *jidp = jid_create(jid);
-        char *pref_otr_log = prefs_get_string(PREF_OTR_LOG);
+        const char *pref_otr_log = prefs_get_string(PREF_OTR_LOG);
         if (!was_decrypted || (strcmp(pref_otr_log, "on") == 0)) {
             _chat_log_chat(jidp->barejid, barejid, msg, PROF_IN_LOG, NULL);
         } else if (strcmp(pref_otr_log, "redact") == 0) {
             _chat_log_chat(jidp->barejid, barejid, "[redacted]", PROF_IN_LOG, NULL);
         }
-        prefs_free_string(pref_otr_log);
         jid_destroy(jidp);
     }
 }
@@ -330,13 +557,12 @@ chat_log_pgp_msg_in(const char * const barejid, const char * const msg)
     if (prefs_get_boolean(PREF_CHLOG)) {
         const char *jid = jabber_get_fulljid();
         Jid *jidp = jid_create(jid);
-        char *pref_pgp_log = prefs_get_string(PREF_PGP_LOG);
+        const char *pref_pgp_log = prefs_get_string(PREF_PGP_LOG);
         if (strcmp(pref_pgp_log, "on") == 0) {
             _chat_log_chat(jidp->barejid, barejid, msg, PROF_IN_LOG, NULL);
         } else if (strcmp(pref_pgp_log, "redact") == 0) {
             _chat_log_chat(jidp->barejid, barejid, "[redacted]", PROF_IN_LOG, NULL);
         }
-        prefs_free_string(pref_pgp_log);
         jid_destroy(jidp);
     }
 }
@@ -387,27 +613,24 @@ _chat_log_chat(const char * const login, const char * const other,
     }
 
     gchar *date_fmt = g_date_time_format(timestamp, "%H:%M:%S");
-    FILE *logp = fopen(dated_log->filename, "a");
-    g_chmod(dated_log->filename, S_IRUSR | S_IWUSR);
+    FILE *logp = _open_chat_log(dated_log);
     if (logp) {
+        gchar *line = NULL;
         if (direction == PROF_IN_LOG) {
             if (strncmp(msg, "/me ", 4) == 0) {
-                fprintf(logp, "%s - *%s %s\n", date_fmt, other, msg + 4);
+                line = g_strdup_printf("%s - *%s %s\n", date_fmt, other, msg + 4);
             } else {
-                fprintf(logp, "%s - %s: %s\n", date_fmt, other, msg);
+                line = g_strdup_printf("%s - %s: %s\n", date_fmt, other, msg);
             }
         } else {
             if (strncmp(msg, "/me ", 4) == 0) {
-                fprintf(logp, "%s - *me %s\n", date_fmt, msg + 4);
+                line = g_strdup_printf("%s - *me %s\n", date_fmt, msg + 4);
             } else {
-                fprintf(logp, "%s - me: %s\n", date_fmt, msg);
+                line = g_strdup_printf("%s - me: %s\n", date_fmt, msg);
             }
         }
-        fflush(logp);
-        int result = fclose(logp);
-        if (result == EOF) {
-            log_error("Error closing file %s, errno = %d", dated_log->filename, errno);
-        }
+        _write_chat_log(dated_log, logp, line);
+        g_free(line);
     }
 
     g_free(date_fmt);
@@ -418,38 +641,33 @@ void
 groupchat_log_chat(const gchar * const login, const gchar * const room,
     const gchar * const nick, const gchar * const msg)
 {
-    gchar *room_copy = strdup(room);
-    struct dated_chat_log *dated_log = g_hash_table_lookup(groupchat_logs, room_copy);
+    struct dated_chat_log *dated_log = g_hash_table_lookup(groupchat_logs, room);
 
     // no log for room
     if (dated_log == NULL) {
-        dated_log = _create_groupchat_log(room_copy, login);
-        g_hash_table_insert(groupchat_logs, room_copy, dated_log);
+        dated_log = _create_groupchat_log(room, login);
+        g_hash_table_insert(groupchat_logs, strdup(room), dated_log);
 
     // log exists but needs rolling
     } else if (_log_roll_needed(dated_log)) {
-        dated_log = _create_groupchat_log(room_copy, login);
-        g_hash_table_replace(logs, room_copy, dated_log);
+        dated_log = _create_groupchat_log(room, login);
+        g_hash_table_replace(groupchat_logs, strdup(room), dated_log);
     }
 
     GDateTime *dt = g_date_time_new_now_local();
 
     gchar *date_fmt = g_date_time_format(dt, "%H:%M:%S");
 
-    FILE *logp = fopen(dated_log->filename, "a");
-    g_chmod(dated_log->filename, S_IRUSR | S_IWUSR);
+    FILE *logp = _open_chat_log(dated_log);
     if (logp) {
+        gchar *line = NULL;
         if (strncmp(msg, "/me ", 4) == 0) {
-            fprintf(logp, "%s - *%s %s\n", date_fmt, nick, msg + 4);
+            line = g_strdup_printf("%s - *%s %s\n", date_fmt, nick, msg + 4);
         } else {
-            fprintf(logp, "%s - %s: %s\n", date_fmt, nick, msg);
-        }
-
-        fflush(logp);
-        int result = fclose(logp);
-        if (result == EOF) {
-            log_error("Error closing file %s, errno = %d", dated_log->filename, errno);
+            line = g_strdup_printf("%s - %s: %s\n", date_fmt, nick, msg);
         }
+        _write_chat_log(dated_log, logp, line);
+        g_free(line);
     }
 
     g_free(date_fmt);
@@ -457,60 +675,39 @@ groupchat_log_chat(const gchar * const login, const gchar * const room,
 }
 
 
-GSList *
-chat_log_get_previous(const gchar * const login, const gchar * const recipient)
+void
+chat_log_flush(void)
 {
-    GSList *history = NULL;
-    GDateTime *now = g_date_time_new_now_local();
-    GDateTime *log_date = g_date_time_new(tz,
-        g_date_time_get_year(session_started),
-        g_date_time_get_month(session_started),
-        g_date_time_get_day_of_month(session_started),
-        g_date_time_get_hour(session_started),
-        g_date_time_get_minute(session_started),
-        g_date_time_get_second(session_started));
-
-    // get data from all logs from the day the session was started to today
-    while (g_date_time_compare(log_date, now) != 1) {
-        char *filename = _get_log_filename(recipient, login, log_date, FALSE);
-
-        FILE *logp = fopen(filename, "r");
-        if (logp) {
-            GString *header = g_string_new("");
-            g_string_append_printf(header, "%d/%d/%d:",
-                g_date_time_get_day_of_month(log_date),
-                g_date_time_get_month(log_date),
-                g_date_time_get_year(log_date));
-            history = g_slist_append(history, header->str);
-            g_string_free(header, FALSE);
-
-            char *line;
-            while ((line = prof_getline(logp)) != NULL) {
-                history = g_slist_append(history, line);
-            }
-
-            fclose(logp);
-        }
+    if (g_timer_elapsed(flush_timer, NULL) < CHAT_LOG_FLUSH_INTERVAL) {
+        return;
+    }
 
-        free(filename);
+    chat_log_flush_all();
+}
 
-        GDateTime *next = g_date_time_add_days(log_date, 1);
-        g_date_time_unref(log_date);
-        log_date = next;
+void
+chat_log_flush_all(void)
+{
+    GList *curr = g_queue_peek_head_link(open_logs);
+    while (curr) {
+        _flush_chat_log(curr->data);
+        curr = g_list_next(curr);
     }
+    // after the logs, so indexed lines are on disk before their postings
+    log_index_flush();
 
-    g_date_time_unref(log_date);
-    g_date_time_unref(now);
-
-    return history;
+    g_timer_start(flush_timer);
 }
 
 void
 chat_log_close(void)
 {
+    // closing each log flushes any buffered writes
     g_hash_table_destroy(logs);
     g_hash_table_destroy(groupchat_logs);
-    g_date_time_unref(session_started);
+    g_queue_free(open_logs);
+    g_timer_destroy(flush_timer);
+    log_index_close();
 }
 
 static struct dated_chat_log *
@@ -522,6 +719,9 @@ _create_log(const char * const other, const char * const login)
     struct dated_chat_log *new_log = malloc(sizeof(struct dated_chat_log));
     new_log->filename = strdup(filename);
     new_log->date = now;
+    new_log->logp = NULL;
+    new_log->open_link = NULL;
+    new_log->dirty = FALSE;
 
     free(filename);
 
@@ -529,7 +729,7 @@ _create_log(const char * const other, const char * const login)
 }
 
 static struct dated_chat_log *
-_create_groupchat_log(char *room, const char * const login)
+_create_groupchat_log(const char * const room, const char * const login)
 {
     GDateTime *now = g_date_time_new_now_local();
     char *filename = _get_groupchat_log_filename(room, login, now, TRUE);
@@ -537,6 +737,9 @@ _create_groupchat_log(char *room, const char * const login)
     struct dated_chat_log *new_log = malloc(sizeof(struct dated_chat_log));
     new_log->filename = strdup(filename);
     new_log->date = now;
+    new_log->logp = NULL;
+    new_log->open_link = NULL;
+    new_log->dirty = FALSE;
 
     free(filename);
 
@@ -557,10 +760,75 @@ _log_roll_needed(struct dated_chat_log *dated_log)
     return result;
 }
 
+// open the log for appending and mark it as most recently used,
+// closing the least recently used log when too many are open
+static FILE *
+_open_chat_log(struct dated_chat_log *dated_log)
+{
+    if (dated_log->logp) {
+        g_queue_unlink(open_logs, dated_log->open_link);
+        g_queue_push_head_link(open_logs, dated_log->open_link);
+    } else {
+        dated_log->logp = fopen(dated_log->filename, "a");
+        if (dated_log->logp == NULL) {
+            log_error("Error opening file %s, errno = %d", dated_log->filename, errno);
+            return NULL;
+        }
+        g_chmod(dated_log->filename, S_IRUSR | S_IWUSR);
+        // so ftell reports where each line starts for the search index
+        fseek(dated_log->logp, 0, SEEK_END);
+        g_queue_push_head(open_logs, dated_log);
+        dated_log->open_link = g_queue_peek_head_link(open_logs);
+
+        if (g_queue_get_length(open_logs) > CHAT_LOG_MAX_OPEN) {
+            _close_chat_log(g_queue_peek_tail(open_logs));
+        }
+    }
+
+    dated_log->dirty = TRUE;
+
+    return dated_log->logp;
+}
+
+static void
+_flush_chat_log(struct dated_chat_log *dated_log)
+{
+    if (dated_log->logp && dated_log->dirty) {
+        fflush(dated_log->logp);
+        dated_log->dirty = FALSE;
+    }
+}
+
+static void
+_write_chat_log(struct dated_chat_log *dated_log, FILE *logp, const char * const line)
+{
+    long offset = ftell(logp);
+    if (fputs(line, logp) != EOF && offset != -1) {
+        log_index_append(dated_log->filename, offset, line);
+    }
+}
+
+static void
+_close_chat_log(struct dated_chat_log *dated_log)
+{
+    if (dated_log->logp) {
+        g_queue_delete_link(open_logs, dated_log->open_link);
+        dated_log->open_link = NULL;
+
+        int result = fclose(dated_log->logp);
+        if (result == EOF) {
+            log_error("Error closing file %s, errno = %d", dated_log->filename, errno);
+        }
+        dated_log->logp = NULL;
+        dated_log->dirty = FALSE;
+    }
+}
+
 static void
 _free_chat_log(struct dated_chat_log *dated_log)
 {
     if (dated_log) {
+        _close_chat_log(dated_log);
         if (dated_log->filename) {
             g_free(dated_log->filename);
             dated_log->filename = NULL;
@@ -54,6 +54,7 @@ void log_init(log_level_t filter);
 log_level_t log_get_filter(void);
 void log_close(void);
 void log_reinit(void);
+void log_update_rotate(void);
 char * get_log_file_location(void);
 void log_debug(const char * const msg, ...);
 void log_info(const char * const msg, ...);
@@ -78,9 +79,11 @@ void chat_log_msg_in_delayed(const char * const barejid, const char * msg, GDate
 void chat_log_otr_msg_in(const char * const barejid, const char * const msg, gboolean was_decrypted);
 void chat_log_pgp_msg_in(const char * const barejid, const char * const msg);
 
+// flush buffered chat log writes, at most once every few seconds
+void chat_log_flush(void);
+// flush buffered chat log writes now
+void chat_log_flush_all(void);
 void chat_log_close(void);
-GSList * chat_log_get_previous(const gchar * const login,
-    const gchar * const recipient);
 
 void groupchat_log_init(void);
 void groupchat_log_chat(const gchar * const login, const gchar * const room,
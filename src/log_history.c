@@ -0,0 +1,234 @@
+/*
+ * log_history.c
+ *
+ * Copyright (C) 2012 - 2015 James Booth <boothj5@gmail.com>
+ *
+ * This file is part of Profanity.
+ *
+ * Profanity is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Profanity is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Profanity.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * In addition, as a special exception, the copyright holders give permission to
+ * link the code of portions of this program with the OpenSSL library under
+ * certain conditions as described in each individual source file, and
+ * distribute linked combinations including the two.
+ *
+ * You must obey the GNU General Public License in all respects for all of the
+ * code used other than OpenSSL. If you modify file(s) with this exception, you
+ * may extend this exception to your version of the file(s), but you are not
+ * obligated to do so. If you do not wish to do so, delete this exception
+ * statement from your version. If you delete this exception statement from all
+ * source files in the program, then also delete it here.
+ *
+ */
+
+#include "config.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <glib.h>
+
+#include "common.h"
+#include "log.h"
+#include "log_history.h"
+
+// bytes read at a time when walking a chat log backwards
+#define CHAT_LOG_HISTORY_CHUNK 4096
+
+struct chat_log_history_t {
+    gchar *dir;
+    GSList *files;
+    FILE *logp;
+    char *header;
+    long offset;
+    GString *partial;
+};
+
+static gboolean _history_open_next(ChatLogHistory *history);
+static void _history_close_file(ChatLogHistory *history);
+static char * _history_prev_line(ChatLogHistory *history);
+static gint _history_compare_newest(const char *a, const char *b);
+
+ChatLogHistory *
+chat_log_history_open(const gchar * const login, const gchar * const recipient)
+{
+    // make sure buffered writes are on disk before reading them back
+    chat_log_flush_all();
+
+    ChatLogHistory *history = malloc(sizeof(ChatLogHistory));
+    history->files = NULL;
+    history->logp = NULL;
+    history->header = NULL;
+    history->offset = -1;
+    history->partial = g_string_new("");
+
+    gchar *xdg_data = xdg_get_data_home();
+    gchar *login_dir = str_replace(login, "@", "_at_");
+    gchar *recipient_dir = str_replace(recipient, "@", "_at_");
+    history->dir = g_strdup_printf("%s/profanity/chatlogs/%s/%s", xdg_data, login_dir, recipient_dir);
+    g_free(xdg_data);
+    free(login_dir);
+    free(recipient_dir);
+
+    // one file per day, named YYYY_MM_DD.log so newest first is reverse name order
+    GDir *dir = g_dir_open(history->dir, 0, NULL);
+    if (dir) {
+        const gchar *name;
+        while ((name = g_dir_read_name(dir)) != NULL) {
+            if (strlen(name) == 14 && name[4] == '_' && name[7] == '_' && g_str_has_suffix(name, ".log")) {
+                history->files = g_slist_insert_sorted(history->files, strdup(name), (GCompareFunc)_history_compare_newest);
+            }
+        }
+        g_dir_close(dir);
+    }
+
+    return history;
+}
+
+GSList *
+chat_log_history_older(ChatLogHistory *history, int max_lines)
+{
+    GSList *lines = NULL;
+    int count = 0;
+
+    while (count < max_lines) {
+        if (!history->logp && !_history_open_next(history)) {
+            break;
+        }
+
+        char *line = _history_prev_line(history);
+        if (line) {
+            lines = g_slist_prepend(lines, line);
+        } else {
+            // whole day read, its date goes above it
+            lines = g_slist_prepend(lines, strdup(history->header));
+            _history_close_file(history);
+        }
+        count++;
+    }
+
+    return lines;
+}
+
+void
+chat_log_history_close(ChatLogHistory *history)
+{
+    if (history) {
+        _history_close_file(history);
+        g_slist_free_full(history->files, free);
+        g_string_free(history->partial, TRUE);
+        g_free(history->dir);
+        free(history);
+    }
+}
+
+static gint
+_history_compare_newest(const char *a, const char *b)
+{
+    return strcmp(b, a);
+}
+
+static gboolean
+_history_open_next(ChatLogHistory *history)
+{
+    while (history->files) {
+        char *name = history->files->data;
+        history->files = g_slist_delete_link(history->files, history->files);
+
+        gchar *path = g_strdup_printf("%s/%s", history->dir, name);
+        FILE *logp = fopen(path, "r");
+        g_free(path);
+        if (!logp) {
+            free(name);
+            continue;
+        }
+
+        // start from the end, an empty log has no lines and no date
+        fseek(logp, 0, SEEK_END);
+        long size = ftell(logp);
+        if (size <= 0) {
+            fclose(logp);
+            free(name);
+            continue;
+        }
+
+        int year = 0, month = 0, day = 0;
+        sscanf(name, "%4d_%2d_%2d", &year, &month, &day);
+        history->header = g_strdup_printf("%d/%d/%d:", day, month, year);
+        free(name);
+
+        // skipping the newline that ends the last line
+        history->offset = size;
+        fseek(logp, history->offset - 1, SEEK_SET);
+        if (fgetc(logp) == '\n') {
+            history->offset--;
+        }
+        history->logp = logp;
+        g_string_truncate(history->partial, 0);
+
+        return TRUE;
+    }
+
+    return FALSE;
+}
+
+static void
+_history_close_file(ChatLogHistory *history)
+{
+    if (history->logp) {
+        fclose(history->logp);
+        history->logp = NULL;
+    }
+    g_free(history->header);
+    history->header = NULL;
+    history->offset = -1;
+}
+
+// previous line of the open file, NULL once its first line has been returned
+static char *
+_history_prev_line(ChatLogHistory *history)
+{
+    while (TRUE) {
+        char *newline = strrchr(history->partial->str, '\n');
+        if (newline) {
+            char *line = strdup(newline + 1);
+            g_string_truncate(history->partial, newline - history->partial->str);
+            return line;
+        }
+
+        if (history->offset < 0) {
+            return NULL;
+        }
+
+        // the first line of the file has no newline before it
+        if (history->offset == 0) {
+            history->offset = -1;
+            char *line = strdup(history->partial->str);
+            g_string_truncate(history->partial, 0);
+            return line;
+        }
+
+        char chunk[CHAT_LOG_HISTORY_CHUNK];
+        long len = history->offset < CHAT_LOG_HISTORY_CHUNK ? history->offset : CHAT_LOG_HISTORY_CHUNK;
+        history->offset -= len;
+        if (fseek(history->logp, history->offset, SEEK_SET) != 0 ||
+                fread(chunk, 1, len, history->logp) != (size_t)len) {
+            log_error("Error reading chat history");
+            history->offset = -1;
+            return NULL;
+        }
+        g_string_prepend_len(history->partial, chunk, len);
+    }
+}
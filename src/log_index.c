@@ -0,0 +1,831 @@
+/*
+ * log_index.c
+ *
+ * Copyright (C) 2012 - 2015 James Booth <boothj5@gmail.com>
+ *
+ * This file is part of Profanity.
+ *
+ * Profanity is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Profanity is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Profanity.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * In addition, as a special exception, the copyright holders give permission to
+ * link the code of portions of this program with the OpenSSL library under
+ * certain conditions as described in each individual source file, and
+ * distribute linked combinations including the two.
+ *
+ * You must obey the GNU General Public License in all respects for all of the
+ * code used other than OpenSSL. If you modify file(s) with this exception, you
+ * may extend this exception to your version of the file(s), but you are not
+ * obligated to do so. If you do not wish to do so, delete this exception
+ * statement from your version. If you delete this exception statement from all
+ * source files in the program, then also delete it here.
+ *
+ */
+
+#include "config.h"
+
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <glib.h>
+
+#include "common.h"
+#include "log.h"
+#include "log_index.h"
+#include "tools/persist.h"
+#include "tools/wakeup.h"
+
+// kept next to the daily logs of each contact and room
+#define INDEX_FILES "index.files"
+#define INDEX_WORDS "index.words"
+
+// shorter words are not indexed
+#define INDEX_MIN_WORD 2
+
+// bytes of log indexed by each call to log_index_process, visiting a log costs INDEX_FILE_COST
+#define INDEX_CHUNK (128 * 1024)
+#define INDEX_FILE_COST 1024
+
+typedef struct log_posting_t {
+    guint32 file;
+    guint32 offset;
+} LogPosting;
+
+typedef struct log_index_file_t {
+    char *name;
+    long indexed;
+} LogIndexFile;
+
+typedef struct log_index_t {
+    char *dir;
+    char *contact;
+    GPtrArray *files;
+    GHashTable *file_ids;
+    // opened when postings are written, closed when they are saved
+    FILE *words_file;
+    gboolean files_dirty;
+} LogIndex;
+
+typedef struct log_mapping_t {
+    char *data;
+    size_t len;
+} LogMapping;
+
+// directory -> LogIndex, only the indexed offsets are kept in memory,
+// postings are read back from INDEX_WORDS when searching
+static GHashTable *indexes;
+
+// logs still to be indexed by log_index_process, oldest day of each directory first
+static GQueue *pending;
+static GHashTable *pending_paths;
+// the account whose logs have been queued
+static char *started_login;
+
+static gchar * _logs_dir(const char * const login);
+static void _queue_dir(const char * const dir, gboolean rooms);
+static void _queue_log(const char * const path);
+static gboolean _index_log(const char * const path, long *budget);
+static LogIndex * _index_get(const char * const dir);
+static LogIndex * _index_get_log(const char * const path, guint *id);
+static void _index_free(LogIndex *index);
+static void _index_load(LogIndex *index);
+static void _index_save(LogIndex *index);
+static guint _index_file_id(LogIndex *index, const char * const name);
+static void _index_text(LogIndex *index, guint id, long offset, const char *text, size_t len);
+static GPtrArray * _index_read_postings(LogIndex *index, GPtrArray *terms);
+static void _index_search(LogIndex *index, GPtrArray *terms, int max_results, GSList **results);
+static void _search_dir(const char * const dir, gboolean rooms, GPtrArray *terms, int max_results,
+    GSList **results);
+static gboolean _next_word(const char **pos, const char *end, GString *word);
+static GPtrArray * _words(const char *text, size_t len);
+static gboolean _is_log_name(const char * const name);
+static gboolean _map_file(const char * const path, LogMapping *mapping);
+static gint _compare_results(LogSearchResult *a, LogSearchResult *b);
+static void _free_result(LogSearchResult *result);
+
+void
+log_index_start(const char * const login)
+{
+    if (g_strcmp0(started_login, login) == 0) {
+        return;
+    }
+    free(started_login);
+    started_login = strdup(login);
+
+    gchar *logs_dir = _logs_dir(login);
+    gchar *rooms_dir = g_strdup_printf("%s/rooms", logs_dir);
+    _queue_dir(logs_dir, FALSE);
+    _queue_dir(rooms_dir, TRUE);
+    g_free(logs_dir);
+    g_free(rooms_dir);
+}
+
+void
+log_index_process(void)
+{
+    long budget = INDEX_CHUNK;
+    while (pending && budget > 0) {
+        gchar *path = g_queue_peek_head(pending);
+        budget -= INDEX_FILE_COST;
+        if (!_index_log(path, &budget)) {
+            continue;
+        }
+
+        g_queue_pop_head(pending);
+        g_hash_table_remove(pending_paths, path);
+        g_free(path);
+        if (g_queue_is_empty(pending)) {
+            g_queue_free(pending);
+            pending = NULL;
+            g_hash_table_destroy(pending_paths);
+            pending_paths = NULL;
+        }
+    }
+
+    // come straight back for the next chunk rather than waiting for input
+    if (pending) {
+        wakeup_signal();
+    }
+}
+
+gboolean
+log_index_building(void)
+{
+    return pending != NULL;
+}
+
+void
+log_index_append(const char * const filename, long offset, const char * const line)
+{
+    guint id;
+    LogIndex *index = _index_get_log(filename, &id);
+
+    LogIndexFile *file = g_ptr_array_index(index->files, id);
+    if (file->indexed == offset) {
+        size_t len = strlen(line);
+        _index_text(index, id, offset, line, len);
+        file->indexed = offset + len;
+        index->files_dirty = TRUE;
+    } else {
+        // earlier lines of the log are not indexed yet, catch up from the main loop
+        _queue_log(filename);
+    }
+}
+
+void
+log_index_flush(void)
+{
+    if (!indexes) {
+        return;
+    }
+
+    GList *values = g_hash_table_get_values(indexes);
+    GList *curr = values;
+    while (curr) {
+        _index_save(curr->data);
+        curr = g_list_next(curr);
+    }
+    g_list_free(values);
+}
+
+GSList *
+log_index_search(const char * const login, const char * const query, int max_results)
+{
+    GPtrArray *terms = _words(query, strlen(query));
+    if (terms->len == 0) {
+        g_ptr_array_free(terms, TRUE);
+        return NULL;
+    }
+
+    // anything not indexed yet is found by later searches
+    log_index_start(login);
+
+    gchar *logs_dir = _logs_dir(login);
+    gchar *rooms_dir = g_strdup_printf("%s/rooms", logs_dir);
+
+    GSList *results = NULL;
+    _search_dir(logs_dir, FALSE, terms, max_results, &results);
+    _search_dir(rooms_dir, TRUE, terms, max_results, &results);
+    g_free(logs_dir);
+    g_free(rooms_dir);
+    g_ptr_array_free(terms, TRUE);
+
+    results = g_slist_sort(results, (GCompareFunc)_compare_results);
+    GSList *extra = g_slist_nth(results, max_results - 1);
+    if (extra && extra->next) {
+        log_index_free_results(extra->next);
+        extra->next = NULL;
+    }
+
+    return results;
+}
+
+void
+log_index_free_results(GSList *results)
+{
+    g_slist_free_full(results, (GDestroyNotify)_free_result);
+}
+
+void
+log_index_close(void)
+{
+    if (indexes) {
+        g_hash_table_destroy(indexes);
+        indexes = NULL;
+    }
+    if (pending) {
+        gchar *path;
+        while ((path = g_queue_pop_head(pending)) != NULL) {
+            g_free(path);
+        }
+        g_queue_free(pending);
+        pending = NULL;
+        g_hash_table_destroy(pending_paths);
+        pending_paths = NULL;
+    }
+    free(started_login);
+    started_login = NULL;
+}
+
+static gchar *
+_logs_dir(const char * const login)
+{
+    gchar *xdg_data = xdg_get_data_home();
+    gchar *login_dir = str_replace(login, "@", "_at_");
+    gchar *logs_dir = g_strdup_printf("%s/profanity/chatlogs/%s", xdg_data, login_dir);
+    g_free(xdg_data);
+    free(login_dir);
+
+    return logs_dir;
+}
+
+// queue the logs of every contact or room directory in dir
+static void
+_queue_dir(const char * const dir, gboolean rooms)
+{
+    GDir *logs = g_dir_open(dir, 0, NULL);
+    if (!logs) {
+        return;
+    }
+
+    const gchar *name;
+    while ((name = g_dir_read_name(logs)) != NULL) {
+        if (!rooms && strcmp(name, "rooms") == 0) {
+            continue;
+        }
+
+        gchar *path = g_strdup_printf("%s/%s", dir, name);
+        GDir *contact_dir = g_dir_open(path, 0, NULL);
+        if (contact_dir) {
+            GSList *names = NULL;
+            const gchar *log_name;
+            while ((log_name = g_dir_read_name(contact_dir)) != NULL) {
+                if (_is_log_name(log_name)) {
+                    names = g_slist_insert_sorted(names, g_strdup(log_name), (GCompareFunc)strcmp);
+                }
+            }
+            g_dir_close(contact_dir);
+
+            GSList *curr = names;
+            while (curr) {
+                gchar *log_path = g_strdup_printf("%s/%s", path, (char *)curr->data);
+                _queue_log(log_path);
+                g_free(log_path);
+                curr = g_slist_next(curr);
+            }
+            g_slist_free_full(names, g_free);
+        }
+        g_free(path);
+    }
+
+    g_dir_close(logs);
+}
+
+static void
+_queue_log(const char * const path)
+{
+    if (!pending) {
+        pending = g_queue_new();
+        pending_paths = g_hash_table_new(g_str_hash, g_str_equal);
+    }
+    if (g_hash_table_lookup(pending_paths, path)) {
+        return;
+    }
+
+    gchar *queued = g_strdup(path);
+    g_queue_push_tail(pending, queued);
+    g_hash_table_insert(pending_paths, queued, queued);
+}
+
+// index up to budget bytes of the log, returns TRUE once every complete line is indexed
+static gboolean
+_index_log(const char * const path, long *budget)
+{
+    LogMapping log;
+    if (!_map_file(path, &log)) {
+        return TRUE;
+    }
+
+    guint id;
+    LogIndex *index = _index_get_log(path, &id);
+    LogIndexFile *file = g_ptr_array_index(index->files, id);
+
+    gboolean done = TRUE;
+    if ((size_t)file->indexed < log.len) {
+        const char *start = log.data + file->indexed;
+        const char *last = log.data + log.len;
+        if (last - start > *budget) {
+            const char *eol = memchr(start + *budget, '\n', last - (start + *budget));
+            if (eol && eol + 1 < last) {
+                last = eol + 1;
+                done = FALSE;
+            }
+        }
+
+        // only complete lines, a partly written one is picked up when it is appended
+        while (last > start && *(last - 1) != '\n') {
+            last--;
+        }
+        if (last > start) {
+            _index_text(index, id, file->indexed, start, last - start);
+            file->indexed += last - start;
+            index->files_dirty = TRUE;
+            *budget -= last - start;
+        }
+    }
+    munmap(log.data, log.len);
+
+    if (done) {
+        _index_save(index);
+    }
+
+    return done;
+}
+
+static void
+_search_dir(const char * const dir, gboolean rooms, GPtrArray *terms, int max_results, GSList **results)
+{
+    GDir *logs = g_dir_open(dir, 0, NULL);
+    if (!logs) {
+        return;
+    }
+
+    const gchar *name;
+    while ((name = g_dir_read_name(logs)) != NULL) {
+        if (!rooms && strcmp(name, "rooms") == 0) {
+            continue;
+        }
+
+        gchar *path = g_strdup_printf("%s/%s", dir, name);
+        if (g_file_test(path, G_FILE_TEST_IS_DIR)) {
+            LogIndex *index = _index_get(path);
+            _index_save(index);
+            _index_search(index, terms, max_results, results);
+        }
+        g_free(path);
+    }
+
+    g_dir_close(logs);
+}
+
+static LogIndex *
+_index_get(const char * const dir)
+{
+    if (!indexes) {
+        indexes = g_hash_table_new_full(g_str_hash, g_str_equal, NULL, (GDestroyNotify)_index_free);
+    }
+
+    LogIndex *index = g_hash_table_lookup(indexes, dir);
+    if (index) {
+        return index;
+    }
+
+    gchar *name = g_path_get_basename(dir);
+    index = malloc(sizeof(LogIndex));
+    index->dir = strdup(dir);
+    index->contact = str_replace(name, "_at_", "@");
+    index->files = g_ptr_array_new();
+    index->file_ids = g_hash_table_new(g_str_hash, g_str_equal);
+    index->words_file = NULL;
+    index->files_dirty = FALSE;
+    g_free(name);
+    _index_load(index);
+
+    g_hash_table_insert(indexes, index->dir, index);
+
+    return index;
+}
+
+static LogIndex *
+_index_get_log(const char * const path, guint *id)
+{
+    gchar *dir = g_path_get_dirname(path);
+    LogIndex *index = _index_get(dir);
+    g_free(dir);
+
+    gchar *name = g_path_get_basename(path);
+    *id = _index_file_id(index, name);
+    g_free(name);
+
+    return index;
+}
+
+static void
+_index_free(LogIndex *index)
+{
+    _index_save(index);
+
+    guint i;
+    for (i = 0; i < index->files->len; i++) {
+        LogIndexFile *file = g_ptr_array_index(index->files, i);
+        free(file->name);
+        free(file);
+    }
+    g_ptr_array_free(index->files, TRUE);
+    g_hash_table_destroy(index->file_ids);
+    free(index->contact);
+    free(index->dir);
+    free(index);
+}
+
+// INDEX_FILES has a "name indexed_bytes" line per log file, the line number is the file id
+// INDEX_WORDS has a "file_id offset word" line per posting and is only ever appended to
+static void
+_index_load(LogIndex *index)
+{
+    gchar *files_path = g_strdup_printf("%s/%s", index->dir, INDEX_FILES);
+    FILE *files = fopen(files_path, "r");
+    g_free(files_path);
+    if (files) {
+        char *line;
+        while ((line = prof_getline(files)) != NULL) {
+            char *space = strrchr(line, ' ');
+            if (space) {
+                *space = '\0';
+                guint id = _index_file_id(index, line);
+                LogIndexFile *file = g_ptr_array_index(index->files, id);
+                file->indexed = strtol(space + 1, NULL, 10);
+            }
+            free(line);
+        }
+        fclose(files);
+    }
+
+    // offsets loaded from disk are already saved
+    index->files_dirty = FALSE;
+}
+
+// the postings are synced before the offsets that cover them are written, so a crash
+// in between only leaves postings that are indexed again, searches skip the duplicates
+static void
+_index_save(LogIndex *index)
+{
+    if (index->words_file) {
+        gboolean synced = fflush(index->words_file) == 0 && fsync(fileno(index->words_file)) == 0;
+        fclose(index->words_file);
+        index->words_file = NULL;
+        if (!synced) {
+            log_error("Error writing chat log index %s/%s", index->dir, INDEX_WORDS);
+            return;
+        }
+    }
+
+    if (!index->files_dirty) {
+        return;
+    }
+
+    GString *files = g_string_new("");
+    guint i;
+    for (i = 0; i < index->files->len; i++) {
+        LogIndexFile *file = g_ptr_array_index(index->files, i);
+        g_string_append_printf(files, "%s %ld\n", file->name, file->indexed);
+    }
+
+    gchar *files_path = g_strdup_printf("%s/%s", index->dir, INDEX_FILES);
+    if (persist_write_file(files_path, files->str, files->len)) {
+        index->files_dirty = FALSE;
+    }
+    g_free(files_path);
+    g_string_free(files, TRUE);
+}
+
+static guint
+_index_file_id(LogIndex *index, const char * const name)
+{
+    gpointer id = g_hash_table_lookup(index->file_ids, name);
+    if (id) {
+        return GPOINTER_TO_UINT(id) - 1;
+    }
+
+    LogIndexFile *file = malloc(sizeof(LogIndexFile));
+    file->name = strdup(name);
+    file->indexed = 0;
+    g_ptr_array_add(index->files, file);
+    g_hash_table_insert(index->file_ids, file->name, GUINT_TO_POINTER(index->files->len));
+    index->files_dirty = TRUE;
+
+    return index->files->len - 1;
+}
+
+static void
+_index_text(LogIndex *index, guint id, long offset, const char *text, size_t len)
+{
+    if (!index->words_file) {
+        gchar *words_path = g_strdup_printf("%s/%s", index->dir, INDEX_WORDS);
+        index->words_file = fopen(words_path, "a");
+        if (!index->words_file) {
+            log_error("Error opening chat log index %s", words_path);
+        }
+        g_free(words_path);
+    }
+    if (!index->words_file) {
+        return;
+    }
+
+    const char *line = text;
+    const char *end = text + len;
+
+    while (line < end) {
+        const char *eol = memchr(line, '\n', end - line);
+        if (!eol) {
+            eol = end;
+        }
+
+        // skip the "HH:MM:SS - " prefix of entries
+        const char *words_start = line;
+        if (eol - line > 11 && line[2] == ':' && line[5] == ':') {
+            words_start += 11;
+        }
+
+        GPtrArray *words = _words(words_start, eol - words_start);
+        long line_offset = offset + (line - text);
+        guint i;
+        for (i = 0; i < words->len; i++) {
+            fprintf(index->words_file, "%u %ld %s\n", id, line_offset, (char *)g_ptr_array_index(words, i));
+        }
+        g_ptr_array_free(words, TRUE);
+
+        line = eol + 1;
+    }
+}
+
+// the postings of each term in the order they were written, oldest first
+static GPtrArray *
+_index_read_postings(LogIndex *index, GPtrArray *terms)
+{
+    GPtrArray *postings = g_ptr_array_new_with_free_func((GDestroyNotify)g_array_unref);
+    guint t;
+    for (t = 0; t < terms->len; t++) {
+        g_ptr_array_add(postings, g_array_new(FALSE, FALSE, sizeof(LogPosting)));
+    }
+
+    gchar *words_path = g_strdup_printf("%s/%s", index->dir, INDEX_WORDS);
+    LogMapping words;
+    if (_map_file(words_path, &words)) {
+        const char *pos = words.data;
+        const char *end = words.data + words.len;
+        while (pos < end) {
+            const char *eol = memchr(pos, '\n', end - pos);
+            if (!eol) {
+                break;
+            }
+
+            const char *word = memchr(pos, ' ', eol - pos);
+            if (word) {
+                word = memchr(word + 1, ' ', eol - word - 1);
+            }
+            if (word) {
+                word++;
+                size_t len = eol - word;
+                for (t = 0; t < terms->len; t++) {
+                    const char *term = g_ptr_array_index(terms, t);
+                    if (strncmp(term, word, len) == 0 && term[len] == '\0') {
+                        char *next = NULL;
+                        LogPosting posting;
+                        posting.file = strtoul(pos, &next, 10);
+                        posting.offset = strtoul(next, NULL, 10);
+                        if (posting.file < index->files->len) {
+                            g_array_append_val(g_ptr_array_index(postings, t), posting);
+                        }
+                        break;
+                    }
+                }
+            }
+            pos = eol + 1;
+        }
+        munmap(words.data, words.len);
+    }
+    g_free(words_path);
+
+    return postings;
+}
+
+static void
+_index_search(LogIndex *index, GPtrArray *terms, int max_results, GSList **results)
+{
+    // walk the rarest term and check the others against each line
+    GPtrArray *postings = _index_read_postings(index, terms);
+    GArray *rarest = NULL;
+    guint i;
+    for (i = 0; i < postings->len; i++) {
+        GArray *term_postings = g_ptr_array_index(postings, i);
+        if (!rarest || term_postings->len < rarest->len) {
+            rarest = term_postings;
+        }
+    }
+
+    // lines indexed again after a crash have their postings written twice
+    GHashTable *seen = g_hash_table_new_full(g_int64_hash, g_int64_equal, g_free, NULL);
+    GHashTable *mappings = g_hash_table_new_full(g_direct_hash, g_direct_equal, NULL, free);
+    int found = 0;
+    guint p = rarest->len;
+
+    while (p > 0 && found < max_results) {
+        LogPosting posting = g_array_index(rarest, LogPosting, --p);
+        gint64 key = ((gint64)posting.file << 32) | posting.offset;
+        if (g_hash_table_lookup(seen, &key)) {
+            continue;
+        }
+        gint64 *seen_key = g_malloc(sizeof(gint64));
+        *seen_key = key;
+        g_hash_table_insert(seen, seen_key, seen_key);
+
+        LogIndexFile *file = g_ptr_array_index(index->files, posting.file);
+        LogMapping *mapping = g_hash_table_lookup(mappings, GUINT_TO_POINTER(posting.file + 1));
+        if (!mapping) {
+            mapping = malloc(sizeof(LogMapping));
+            gchar *path = g_strdup_printf("%s/%s", index->dir, file->name);
+            if (!_map_file(path, mapping)) {
+                mapping->data = NULL;
+                mapping->len = 0;
+            }
+            g_free(path);
+            g_hash_table_insert(mappings, GUINT_TO_POINTER(posting.file + 1), mapping);
+        }
+        if (posting.offset >= mapping->len) {
+            continue;
+        }
+
+        const char *line = mapping->data + posting.offset;
+        const char *eol = memchr(line, '\n', mapping->len - posting.offset);
+        size_t len = eol ? (size_t)(eol - line) : mapping->len - posting.offset;
+
+        if (terms->len > 1) {
+            GPtrArray *words = _words(line, len);
+            gboolean all = TRUE;
+            guint t, w;
+            for (t = 0; t < terms->len && all; t++) {
+                gboolean has = FALSE;
+                for (w = 0; w < words->len && !has; w++) {
+                    has = g_strcmp0(g_ptr_array_index(terms, t), g_ptr_array_index(words, w)) == 0;
+                }
+                all = has;
+            }
+            g_ptr_array_free(words, TRUE);
+            if (!all) {
+                continue;
+            }
+        }
+
+        LogSearchResult *result = malloc(sizeof(LogSearchResult));
+        result->contact = strdup(index->contact);
+        result->date = g_strndup(file->name, 10);
+        result->offset = posting.offset;
+        result->line = g_strndup(line, len);
+        *results = g_slist_prepend(*results, result);
+        found++;
+    }
+
+    GList *values = g_hash_table_get_values(mappings);
+    GList *curr = values;
+    while (curr) {
+        LogMapping *mapping = curr->data;
+        if (mapping->data) {
+            munmap(mapping->data, mapping->len);
+        }
+        curr = g_list_next(curr);
+    }
+    g_list_free(values);
+    g_hash_table_destroy(mappings);
+    g_hash_table_destroy(seen);
+    g_ptr_array_free(postings, TRUE);
+}
+
+// words are runs of letters, digits and non ascii bytes, lower cased
+static gboolean
+_next_word(const char **pos, const char *end, GString *word)
+{
+    g_string_truncate(word, 0);
+
+    while (*pos < end) {
+        unsigned char c = **pos;
+        (*pos)++;
+        if (g_ascii_isalnum(c) || c >= 0x80) {
+            g_string_append_c(word, g_ascii_tolower(c));
+        } else if (word->len >= INDEX_MIN_WORD) {
+            return TRUE;
+        } else {
+            g_string_truncate(word, 0);
+        }
+    }
+
+    return word->len >= INDEX_MIN_WORD;
+}
+
+// distinct words of text
+static GPtrArray *
+_words(const char *text, size_t len)
+{
+    GPtrArray *words = g_ptr_array_new_with_free_func(g_free);
+    GString *word = g_string_new("");
+    const char *pos = text;
+    const char *end = text + len;
+
+    while (_next_word(&pos, end, word)) {
+        gboolean seen = FALSE;
+        guint i;
+        for (i = 0; i < words->len && !seen; i++) {
+            seen = strcmp(g_ptr_array_index(words, i), word->str) == 0;
+        }
+        if (!seen) {
+            g_ptr_array_add(words, g_strdup(word->str));
+        }
+    }
+
+    g_string_free(word, TRUE);
+    return words;
+}
+
+static gboolean
+_is_log_name(const char * const name)
+{
+    return strlen(name) == 14 && name[4] == '_' && name[7] == '_' && g_str_has_suffix(name, ".log");
+}
+
+static gboolean
+_map_file(const char * const path, LogMapping *mapping)
+{
+    int fd = open(path, O_RDONLY);
+    if (fd == -1) {
+        return FALSE;
+    }
+
+    struct stat st;
+    if (fstat(fd, &st) != 0 || st.st_size == 0) {
+        close(fd);
+        return FALSE;
+    }
+
+    void *data = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (data == MAP_FAILED) {
+        log_error("Error mapping %s", path);
+        return FALSE;
+    }
+
+    mapping->data = data;
+    mapping->len = st.st_size;
+
+    return TRUE;
+}
+
+// newest first
+static gint
+_compare_results(LogSearchResult *a, LogSearchResult *b)
+{
+    int result = strcmp(b->date, a->date);
+
+    // lines of the same day start with their HH:MM:SS time
+    if (result == 0) {
+        result = strncmp(b->line, a->line, 8);
+    }
+    if (result == 0) {
+        result = (b->offset > a->offset) - (b->offset < a->offset);
+    }
+
+    return result;
+}
+
+static void
+_free_result(LogSearchResult *result)
+{
+    free(result->contact);
+    g_free(result->date);
+    g_free(result->line);
+    free(result);
+}
@@ -50,6 +50,11 @@ static char *account_name = NULL;
 int
 main(int argc, char **argv)
 {
+#if !GLIB_CHECK_VERSION(2,32,0)
+    // glib locks are no-ops until threads are initialised, automatic from 2.32
+    g_thread_init(NULL);
+#endif
+
     if (argc == 2 && g_strcmp0(argv[1], "docgen") == 0 && g_strcmp0(PACKAGE_STATUS, "development") == 0) {
         command_docgen();
         return 0;
@@ -59,6 +59,9 @@ typedef struct _muc_room_t {
     gboolean autojoin;
     gboolean pending_nick_change;
     GHashTable *roster;
+    GSequence *occupants;
+    GSequence *role_occupants[MUC_ROLE_MODERATOR + 1];
+    GHashTable *occupant_iters;
     Autocomplete nick_ac;
     Autocomplete jid_ac;
     GHashTable *nick_changes;
@@ -66,6 +69,12 @@ typedef struct _muc_room_t {
     muc_member_type_t member_type;
 } ChatRoom;
 
+// position of an occupant in the room's sorted occupant sequences
+typedef struct _occupant_iters_t {
+    GSequenceIter *all;
+    GSequenceIter *role;
+} OccupantIters;
+
 GHashTable *rooms = NULL;
 GHashTable *invite_passwords = NULL;
 Autocomplete invite_ac;
@@ -79,6 +88,11 @@ static char* _affiliation_to_string(muc_affiliation_t affiliation);
 static Occupant* _muc_occupant_new(const char *const nick, const char * const jid,
     muc_role_t role, muc_affiliation_t affiliation, resource_presence_t presence, const char * const status);
 static void _occupant_free(Occupant *occupant);
+static void _occupant_index_add(ChatRoom *chat_room, Occupant *occupant);
+static void _occupant_index_remove(ChatRoom *chat_room, Occupant *occupant);
+static void _roster_replace(ChatRoom *chat_room, const char * const nick, Occupant *occupant);
+static void _roster_remove(ChatRoom *chat_room, const char * const nick);
+static gint _compare_occupants_data(gconstpointer a, gconstpointer b, gpointer data);
 
 void
 muc_init(void)
@@ -190,6 +204,12 @@ muc_join(const char * const room, const char * const nick,
     new_room->pending_broadcasts = NULL;
     new_room->pending_config = FALSE;
     new_room->roster = g_hash_table_new_full(g_str_hash, g_str_equal, g_free, (GDestroyNotify)_occupant_free);
+    new_room->occupants = g_sequence_new(NULL);
+    int i;
+    for (i = 0; i <= MUC_ROLE_MODERATOR; i++) {
+        new_room->role_occupants[i] = g_sequence_new(NULL);
+    }
+    new_room->occupant_iters = g_hash_table_new_full(g_direct_hash, g_direct_equal, NULL, free);
     new_room->nick_ac = autocomplete_new();
     new_room->jid_ac = autocomplete_new();
     new_room->nick_changes = g_hash_table_new_full(g_str_hash, g_str_equal, g_free, g_free);
@@ -356,7 +376,7 @@ muc_nick_change_complete(const char * const room, const char * const nick)
 {
     ChatRoom *chat_room = g_hash_table_lookup(rooms, room);
     if (chat_room) {
-        g_hash_table_remove(chat_room->roster, chat_room->nick);
+        _roster_remove(chat_room, chat_room->nick);
         autocomplete_remove(chat_room->nick_ac, chat_room->nick);
         free(chat_room->nick);
         chat_room->nick = strdup(nick);
@@ -447,7 +467,7 @@ muc_roster_add(const char * const room, const char * const nick, const char * co
         muc_role_t role_t = _role_from_string(role);
         muc_affiliation_t affiliation_t = _affiliation_from_string(affiliation);
         Occupant *occupant = _muc_occupant_new(nick, jid, role_t, affiliation_t, presence, status);
-        g_hash_table_replace(chat_room->roster, strdup(nick), occupant);
+        _roster_replace(chat_room, nick, occupant);
 
         if (jid) {
             Jid *jidp = jid_create(jid);
@@ -469,7 +489,7 @@ muc_roster_remove(const char * const room, const char * const nick)
 {
     ChatRoom *chat_room = g_hash_table_lookup(rooms, room);
     if (chat_room) {
-        g_hash_table_remove(chat_room->roster, nick);
+        _roster_remove(chat_room, nick);
         autocomplete_remove(chat_room->nick_ac, nick);
     }
 }
@@ -495,16 +515,14 @@ muc_roster(const char * const room)
     ChatRoom *chat_room = g_hash_table_lookup(rooms, room);
     if (chat_room) {
         GList *result = NULL;
-        GList *occupants = g_hash_table_get_values(chat_room->roster);
 
-        GList *curr = occupants;
-        while (curr) {
-            result = g_list_insert_sorted(result, curr->data, (GCompareFunc)_compare_occupants);
-            curr = g_list_next(curr);
+        // occupants are already sorted, build the list from the end
+        GSequenceIter *curr = g_sequence_get_end_iter(chat_room->occupants);
+        while (!g_sequence_iter_is_begin(curr)) {
+            curr = g_sequence_iter_prev(curr);
+            result = g_list_prepend(result, g_sequence_get(curr));
         }
 
-        g_list_free(occupants);
-
         return result;
     } else {
         return NULL;
@@ -586,17 +604,13 @@ muc_occupants_by_role(const char * const room, muc_role_t role)
     ChatRoom *chat_room = g_hash_table_lookup(rooms, room);
     if (chat_room) {
         GSList *result = NULL;
-        GHashTableIter iter;
-        gpointer key;
-        gpointer value;
-
-        g_hash_table_iter_init(&iter, chat_room->roster);
-        while (g_hash_table_iter_next(&iter, &key, &value)) {
-            Occupant *occupant = (Occupant *)value;
-            if (occupant->role == role) {
-                result = g_slist_insert_sorted(result, value, (GCompareFunc)_compare_occupants);
-            }
+
+        GSequenceIter *curr = g_sequence_get_end_iter(chat_room->role_occupants[role]);
+        while (!g_sequence_iter_is_begin(curr)) {
+            curr = g_sequence_iter_prev(curr);
+            result = g_slist_prepend(result, g_sequence_get(curr));
         }
+
         return result;
     } else {
         return NULL;
@@ -609,17 +623,16 @@ muc_occupants_by_affiliation(const char * const room, muc_affiliation_t affiliat
     ChatRoom *chat_room = g_hash_table_lookup(rooms, room);
     if (chat_room) {
         GSList *result = NULL;
-        GHashTableIter iter;
-        gpointer key;
-        gpointer value;
 
-        g_hash_table_iter_init(&iter, chat_room->roster);
-        while (g_hash_table_iter_next(&iter, &key, &value)) {
-            Occupant *occupant = (Occupant *)value;
+        GSequenceIter *curr = g_sequence_get_end_iter(chat_room->occupants);
+        while (!g_sequence_iter_is_begin(curr)) {
+            curr = g_sequence_iter_prev(curr);
+            Occupant *occupant = g_sequence_get(curr);
             if (occupant->affiliation == affiliation) {
-                result = g_slist_insert_sorted(result, value, (GCompareFunc)_compare_occupants);
+                result = g_slist_prepend(result, occupant);
             }
         }
+
         return result;
     } else {
         return NULL;
@@ -820,6 +833,12 @@ _free_room(ChatRoom *room)
         if (room->roster) {
             g_hash_table_destroy(room->roster);
         }
+        g_sequence_free(room->occupants);
+        int i;
+        for (i = 0; i <= MUC_ROLE_MODERATOR; i++) {
+            g_sequence_free(room->role_occupants[i]);
+        }
+        g_hash_table_destroy(room->occupant_iters);
         autocomplete_free(room->nick_ac);
         autocomplete_free(room->jid_ac);
         if (room->nick_changes) {
@@ -843,6 +862,57 @@ gint _compare_occupants(Occupant *a, Occupant *b)
     return result;
 }
 
+static gint
+_compare_occupants_data(gconstpointer a, gconstpointer b, gpointer data)
+{
+    return _compare_occupants((Occupant*)a, (Occupant*)b);
+}
+
+static void
+_occupant_index_add(ChatRoom *chat_room, Occupant *occupant)
+{
+    OccupantIters *iters = malloc(sizeof(OccupantIters));
+    iters->all = g_sequence_insert_sorted(chat_room->occupants, occupant,
+        _compare_occupants_data, NULL);
+    iters->role = g_sequence_insert_sorted(chat_room->role_occupants[occupant->role], occupant,
+        _compare_occupants_data, NULL);
+    g_hash_table_insert(chat_room->occupant_iters, occupant, iters);
+}
+
+static void
+_occupant_index_remove(ChatRoom *chat_room, Occupant *occupant)
+{
+    OccupantIters *iters = g_hash_table_lookup(chat_room->occupant_iters, occupant);
+    if (iters) {
+        g_sequence_remove(iters->all);
+        g_sequence_remove(iters->role);
+        g_hash_table_remove(chat_room->occupant_iters, occupant);
+    }
+}
+
+// all roster changes go through these, the roster frees occupants so they
+// must leave the sorted sequences first
+static void
+_roster_replace(ChatRoom *chat_room, const char * const nick, Occupant *occupant)
+{
+    Occupant *old = g_hash_table_lookup(chat_room->roster, nick);
+    if (old) {
+        _occupant_index_remove(chat_room, old);
+    }
+    g_hash_table_replace(chat_room->roster, strdup(nick), occupant);
+    _occupant_index_add(chat_room, occupant);
+}
+
+static void
+_roster_remove(ChatRoom *chat_room, const char * const nick)
+{
+    Occupant *occupant = g_hash_table_lookup(chat_room->roster, nick);
+    if (occupant) {
+        _occupant_index_remove(chat_room, occupant);
+        g_hash_table_remove(chat_room->roster, nick);
+    }
+}
+
 static muc_role_t
 _role_from_string(const char * const role)
 {
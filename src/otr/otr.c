@@ -37,6 +37,7 @@
 #include <libotr/message.h>
 #include <libotr/sm.h>
 #include <glib.h>
+#include <pthread.h>
 
 #include "otr/otr.h"
 #include "otr/otrlib.h"
@@ -46,6 +47,7 @@
 #include "ui/ui.h"
 #include "config/preferences.h"
 #include "chat_session.h"
+#include "tools/wakeup.h"
 
 #define PRESENCE_ONLINE 1
 #define PRESENCE_OFFLINE 0
@@ -57,6 +59,31 @@ static char *jid;
 static gboolean data_loaded;
 static GHashTable *smp_initiators;
 
+// how often the console is told key generation is still running
+#define KEYGEN_PROGRESS_SECS 5
+
+// private key generation running on a worker thread, done and err are set by the worker
+// and abandoned by the main thread, all three under keygen_lock
+static struct {
+    gboolean running;
+    gboolean done;
+    gboolean abandoned;
+    gcry_error_t err;
+    pthread_t thread;
+    OtrlUserState user_state;
+    void *newkey;
+    char *jid;
+    char *keysfilename;
+    char *fpsfilename;
+    GTimer *timer;
+    int reported;
+} keygen;
+static pthread_mutex_t keygen_lock = PTHREAD_MUTEX_INITIALIZER;
+
+static void * _keygen_run(void *arg);
+static void _keygen_check(void);
+static void _keygen_free(void);
+
 OtrlUserState
 otr_userstate(void)
 {
@@ -182,6 +209,16 @@ otr_init(void)
 void
 otr_shutdown(void)
 {
+    // libotr cannot interrupt the calculation, leave the worker to the exiting process
+    if (keygen.running) {
+        log_info("Abandoning OTR key generation in progress");
+        pthread_mutex_lock(&keygen_lock);
+        keygen.abandoned = TRUE;
+        pthread_mutex_unlock(&keygen_lock);
+        pthread_detach(keygen.thread);
+        keygen.running = FALSE;
+    }
+
     if (jid) {
         free(jid);
         jid = NULL;
@@ -192,6 +229,7 @@ void
 otr_poll(void)
 {
     otrlib_poll();
+    _keygen_check();
 }
 
 void
@@ -363,6 +401,11 @@ otr_keygen(ProfAccount *account)
         return;
     }
 
+    if (keygen.running) {
+        cons_show("OTR key generation already in progress.");
+        return;
+    }
+
     if (jid) {
         free(jid);
     }
@@ -386,63 +429,162 @@ otr_keygen(ProfAccount *account)
         return;
     }
 
-    gcry_error_t err = 0;
-
     GString *keysfilename = g_string_new(basedir->str);
     g_string_append(keysfilename, "keys.txt");
-    log_debug("Generating private key file %s for %s", keysfilename->str, jid);
-    cons_show("Generating private key, this may take some time.");
-    cons_show("Moving the mouse randomly around the screen may speed up the process!");
-    ui_update();
-    err = otrl_privkey_generate(user_state, keysfilename->str, account->jid, "xmpp");
-    if (!err == GPG_ERR_NO_ERROR) {
-        g_string_free(basedir, TRUE);
+    GString *fpsfilename = g_string_new(basedir->str);
+    g_string_append(fpsfilename, "fingerprints.txt");
+    g_string_free(basedir, TRUE);
+
+    // the new key must be finished against the userstate it was started on,
+    // a reconnect replaces user_state while the key is calculated
+    keygen.user_state = user_state;
+    gcry_error_t err = otrlib_keygen_start(keygen.user_state, account->jid, &keygen.newkey);
+    if (err != GPG_ERR_NO_ERROR) {
+        keygen.user_state = NULL;
         g_string_free(keysfilename, TRUE);
+        g_string_free(fpsfilename, TRUE);
+        log_error("Failed to start private key generation");
+        cons_show_error("Failed to generate private key");
+        return;
+    }
+
+    keygen.jid = strdup(jid);
+    keygen.keysfilename = keysfilename->str;
+    keygen.fpsfilename = fpsfilename->str;
+    g_string_free(keysfilename, FALSE);
+    g_string_free(fpsfilename, FALSE);
+    keygen.done = FALSE;
+    keygen.abandoned = FALSE;
+    keygen.err = GPG_ERR_NO_ERROR;
+    keygen.reported = 0;
+    keygen.timer = g_timer_new();
+
+    log_debug("Generating private key file %s for %s", keygen.keysfilename, jid);
+    if (pthread_create(&keygen.thread, NULL, _keygen_run, NULL) != 0) {
+        otrlib_keygen_cancel(keygen.user_state, keygen.newkey);
+        _keygen_free();
+        log_error("Could not start OTR key generation thread");
+        cons_show_error("Failed to generate private key");
+        return;
+    }
+    keygen.running = TRUE;
+
+    cons_show("Generating private key in the background, this may take some time.");
+    cons_show("Moving the mouse randomly around the screen may speed up the process!");
+}
+
+static void *
+_keygen_run(void *arg)
+{
+    gcry_error_t err = otrlib_keygen_calculate(keygen.newkey, keygen.keysfilename);
+
+    // the wakeup pipe is closed once the main thread abandons the key
+    pthread_mutex_lock(&keygen_lock);
+    keygen.err = err;
+    keygen.done = TRUE;
+    if (!keygen.abandoned) {
+        wakeup_signal();
+    }
+    pthread_mutex_unlock(&keygen_lock);
+
+    return NULL;
+}
+
+static void
+_keygen_check(void)
+{
+    if (!keygen.running) {
+        return;
+    }
+
+    pthread_mutex_lock(&keygen_lock);
+    gboolean done = keygen.done;
+    gcry_error_t err = keygen.err;
+    pthread_mutex_unlock(&keygen_lock);
+
+    if (!done) {
+        int elapsed = g_timer_elapsed(keygen.timer, NULL);
+        if (elapsed >= keygen.reported + KEYGEN_PROGRESS_SECS) {
+            keygen.reported = elapsed - (elapsed % KEYGEN_PROGRESS_SECS);
+            cons_show("Still generating private key (%ds)...", keygen.reported);
+        }
+        return;
+    }
+
+    pthread_join(keygen.thread, NULL);
+    keygen.running = FALSE;
+
+    if (err != GPG_ERR_NO_ERROR) {
+        otrlib_keygen_cancel(keygen.user_state, keygen.newkey);
+        _keygen_free();
         log_error("Failed to generate private key");
         cons_show_error("Failed to generate private key");
         return;
     }
+
+    err = otrlib_keygen_finish(keygen.user_state, keygen.newkey, keygen.keysfilename);
+    if (err != GPG_ERR_NO_ERROR) {
+        _keygen_free();
+        log_error("Failed to save private key");
+        cons_show_error("Failed to generate private key");
+        return;
+    }
     log_info("Private key generated");
     cons_show("");
     cons_show("Private key generation complete.");
 
-    GString *fpsfilename = g_string_new(basedir->str);
-    g_string_append(fpsfilename, "fingerprints.txt");
-    log_debug("Generating fingerprints file %s for %s", fpsfilename->str, jid);
-    err = otrl_privkey_write_fingerprints(user_state, fpsfilename->str);
-    if (!err == GPG_ERR_NO_ERROR) {
-        g_string_free(basedir, TRUE);
-        g_string_free(keysfilename, TRUE);
+    // the key file is saved, but the account may have changed while it was generated
+    if (g_strcmp0(jid, keygen.jid) != 0) {
+        log_info("OTR key generated for %s, now connected as %s, not loading", keygen.jid, jid);
+        _keygen_free();
+        return;
+    }
+
+    log_debug("Generating fingerprints file %s for %s", keygen.fpsfilename, jid);
+    err = otrl_privkey_write_fingerprints(user_state, keygen.fpsfilename);
+    if (err != GPG_ERR_NO_ERROR) {
+        _keygen_free();
         log_error("Failed to create fingerprints file");
         cons_show_error("Failed to create fingerprints file");
         return;
     }
     log_info("Fingerprints file created");
 
-    err = otrl_privkey_read(user_state, keysfilename->str);
-    if (!err == GPG_ERR_NO_ERROR) {
-        g_string_free(basedir, TRUE);
-        g_string_free(keysfilename, TRUE);
+    err = otrl_privkey_read(user_state, keygen.keysfilename);
+    if (err != GPG_ERR_NO_ERROR) {
+        _keygen_free();
         log_error("Failed to load private key");
         data_loaded = FALSE;
         return;
     }
 
-    err = otrl_privkey_read_fingerprints(user_state, fpsfilename->str, NULL, NULL);
-    if (!err == GPG_ERR_NO_ERROR) {
-        g_string_free(basedir, TRUE);
-        g_string_free(keysfilename, TRUE);
+    err = otrl_privkey_read_fingerprints(user_state, keygen.fpsfilename, NULL, NULL);
+    if (err != GPG_ERR_NO_ERROR) {
+        _keygen_free();
         log_error("Failed to load fingerprints");
         data_loaded = FALSE;
         return;
     }
 
     data_loaded = TRUE;
+    _keygen_free();
+}
 
-    g_string_free(basedir, TRUE);
-    g_string_free(keysfilename, TRUE);
-    g_string_free(fpsfilename, TRUE);
-    return;
+static void
+_keygen_free(void)
+{
+    free(keygen.jid);
+    keygen.jid = NULL;
+    free(keygen.keysfilename);
+    keygen.keysfilename = NULL;
+    free(keygen.fpsfilename);
+    keygen.fpsfilename = NULL;
+    if (keygen.timer) {
+        g_timer_destroy(keygen.timer);
+        keygen.timer = NULL;
+    }
+    keygen.newkey = NULL;
+    keygen.user_state = NULL;
 }
 
 gboolean
@@ -679,7 +821,7 @@ otr_get_policy(const char * const recipient)
     account_free(account);
 
     // check global setting
-    char *pref_otr_policy = prefs_get_string(PREF_OTR_POLICY);
+    const char *pref_otr_policy = prefs_get_string(PREF_OTR_POLICY);
 
     // pref defaults to manual
     prof_otrpolicy_t result = PROF_OTRPOLICY_MANUAL;
@@ -690,8 +832,6 @@ otr_get_policy(const char * const recipient)
         result = PROF_OTRPOLICY_ALWAYS;
     }
 
-    prefs_free_string(pref_otr_policy);
-
     return result;
 }
 
@@ -54,6 +54,12 @@ gcry_error_t otrlib_encrypt_message(OtrlUserState user_state, OtrlMessageAppOps
 int otrlib_decrypt_message(OtrlUserState user_state, OtrlMessageAppOps *ops, char *jid, const char * const from,
     const char * const message, char **decrypted, OtrlTLV **tlvs);
 
+// private key generation, start and finish on the main thread, calculate on any thread
+gcry_error_t otrlib_keygen_start(OtrlUserState user_state, const char * const accountname, void **newkey);
+gcry_error_t otrlib_keygen_calculate(void *newkey, const char * const filename);
+gcry_error_t otrlib_keygen_finish(OtrlUserState user_state, void *newkey, const char * const filename);
+void otrlib_keygen_cancel(OtrlUserState user_state, void *newkey);
+
 void otrlib_handle_tlvs(OtrlUserState user_state, OtrlMessageAppOps *ops, ConnContext *context, OtrlTLV *tlvs, GHashTable *smp_initiators);
 
 #endif
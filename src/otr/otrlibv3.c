@@ -31,6 +31,9 @@
  * source files in the program, then also delete it here.
  *
  */
+#include <stdlib.h>
+#include <string.h>
+
 #include <libotr/proto.h>
 #include <libotr/privkey.h>
 #include <libotr/message.h>
@@ -210,3 +213,49 @@ otrlib_handle_tlvs(OtrlUserState user_state, OtrlMessageAppOps *ops, ConnContext
         otr_untrust(context->username);
     }
 }
+
+// libotr 3 has no split key generation, generate into a private user state
+// on the calling thread and let the main thread read the written key file
+typedef struct otrlib_keygen_t {
+    char *accountname;
+    OtrlUserState user_state;
+} OtrlibKeygen;
+
+gcry_error_t
+otrlib_keygen_start(OtrlUserState user_state, const char * const accountname, void **newkey)
+{
+    OtrlibKeygen *keygen = malloc(sizeof(OtrlibKeygen));
+    keygen->accountname = strdup(accountname);
+    keygen->user_state = NULL;
+    *newkey = keygen;
+
+    return gcry_error(GPG_ERR_NO_ERROR);
+}
+
+gcry_error_t
+otrlib_keygen_calculate(void *newkey, const char * const filename)
+{
+    OtrlibKeygen *keygen = newkey;
+    keygen->user_state = otrl_userstate_create();
+
+    return otrl_privkey_generate(keygen->user_state, filename, keygen->accountname, "xmpp");
+}
+
+gcry_error_t
+otrlib_keygen_finish(OtrlUserState user_state, void *newkey, const char * const filename)
+{
+    OtrlibKeygen *keygen = newkey;
+    if (keygen->user_state) {
+        otrl_userstate_free(keygen->user_state);
+    }
+    free(keygen->accountname);
+    free(keygen);
+
+    return gcry_error(GPG_ERR_NO_ERROR);
+}
+
+void
+otrlib_keygen_cancel(OtrlUserState user_state, void *newkey)
+{
+    otrlib_keygen_finish(user_state, newkey, NULL);
+}
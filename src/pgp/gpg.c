@@ -45,9 +45,11 @@
 #include <gpgme.h>
 
 #include "pgp/gpg.h"
+#include "pgp/gpg_jobs.h"
 #include "log.h"
 #include "common.h"
 #include "tools/autocomplete.h"
+#include "tools/persist.h"
 
 #define PGP_SIGNATURE_HEADER "-----BEGIN PGP SIGNATURE-----"
 #define PGP_SIGNATURE_FOOTER "-----END PGP SIGNATURE-----"
@@ -59,12 +61,52 @@ static GHashTable *pubkeys;
 
 static gchar *pubsloc;
 static GKeyFile *pubkeyfile;
+static PersistStore pubkeys_store;
 
 static Autocomplete key_ac;
 
+// verify and decrypt run on worker threads, each with its own context
+#define GPG_WORKERS 2
+
+typedef enum {
+    GPG_JOB_VERIFY,
+    GPG_JOB_DECRYPT
+} gpg_job_type_t;
+
+typedef struct gpg_job_t {
+    gpg_job_type_t type;
+    char *barejid;
+    char *input;
+    char *output;
+    // logged on the main thread by _job_deliver, workers must not log
+    char *error;
+    char *debug;
+    p_gpg_decrypt_callback callback;
+    void *userdata;
+    GDestroyNotify free_userdata;
+} GPGJob;
+
+// each worker has its own context
+typedef struct gpg_worker_t {
+    gpgme_ctx_t ctx;
+    char *error;
+} GPGWorker;
+
+// context for the operations still run on the main thread
+static gpgme_ctx_t main_ctx;
+
 static char* _remove_header_footer(char *str, const char * const footer);
 static char* _add_header_footer(const char * const str, const char * const header, const char * const footer);
 static void _save_pubkeys(void);
+static void _write_pubkeys(void);
+static gpgme_ctx_t _main_ctx(void);
+static void * _worker_new(void);
+static void _worker_free(void *data);
+static void _job_run(void *worker_data, void *job_data);
+static void _job_deliver(void *data);
+static void _job_free(void *data);
+static char* _verify(gpgme_ctx_t ctx, GPGJob *job);
+static char* _decrypt(gpgme_ctx_t ctx, GPGJob *job);
 
 void
 _p_gpg_free_pubkeyid(ProfPGPPubKeyId *pubkeyid)
@@ -84,19 +126,39 @@ p_gpg_init(void)
 
     pubkeys = g_hash_table_new_full(g_str_hash, g_str_equal, g_free, (GDestroyNotify)_p_gpg_free_pubkeyid);
 
+    pubkeys_store = persist_store_new("PGP public keys", _write_pubkeys);
+
     key_ac = autocomplete_new();
     GHashTable *keys = p_gpg_list_keys();
     p_gpg_free_keys(keys);
+
+    GPGJobFuncs funcs;
+    funcs.worker_new = _worker_new;
+    funcs.worker_free = _worker_free;
+    funcs.run = _job_run;
+    funcs.deliver = _job_deliver;
+    funcs.free = _job_free;
+    gpg_jobs_start(&funcs, GPG_WORKERS);
 }
 
 void
 p_gpg_close(void)
 {
+    gpg_jobs_stop();
+
+    if (main_ctx) {
+        gpgme_release(main_ctx);
+        main_ctx = NULL;
+    }
+
     if (pubkeys) {
         g_hash_table_destroy(pubkeys);
         pubkeys = NULL;
     }
 
+    persist_store_free(pubkeys_store);
+    pubkeys_store = NULL;
+
     if (pubkeyfile) {
         g_key_file_free(pubkeyfile);
         pubkeyfile = NULL;
@@ -193,11 +255,17 @@ p_gpg_on_connect(const char * const barejid)
 void
 p_gpg_on_disconnect(void)
 {
+    // results still being worked on belong to this account
+    gpg_jobs_new_generation();
+
     if (pubkeys) {
         g_hash_table_destroy(pubkeys);
         pubkeys = g_hash_table_new_full(g_str_hash, g_str_equal, g_free, (GDestroyNotify)_p_gpg_free_pubkeyid);
     }
 
+    // the key file belongs to the account, write it before it goes
+    persist_store_flush(pubkeys_store);
+
     if (pubkeyfile) {
         g_key_file_free(pubkeyfile);
         pubkeyfile = NULL;
@@ -412,15 +480,48 @@ p_gpg_verify(const char * const barejid, const char *const sign)
         return;
     }
 
-    gpgme_ctx_t ctx;
-    gpgme_error_t error = gpgme_new(&ctx);
+    GPGJob *job = malloc(sizeof(GPGJob));
+    job->type = GPG_JOB_VERIFY;
+    job->barejid = strdup(barejid);
+    job->input = strdup(sign);
+    job->output = NULL;
+    job->error = NULL;
+    job->debug = NULL;
+    job->callback = NULL;
+    job->userdata = NULL;
+    job->free_userdata = NULL;
 
-    if (error) {
-        log_error("GPG: Failed to create gpgme context. %s %s", gpgme_strsource(error), gpgme_strerror(error));
-        return;
-    }
+    gpg_jobs_submit(GPG_JOBS_VERIFY, job);
+}
+
+void
+p_gpg_decrypt_async(const char * const cipher, p_gpg_decrypt_callback callback, void *userdata,
+    GDestroyNotify free_userdata)
+{
+    GPGJob *job = malloc(sizeof(GPGJob));
+    job->type = GPG_JOB_DECRYPT;
+    job->barejid = NULL;
+    job->input = strdup(cipher);
+    job->output = NULL;
+    job->error = NULL;
+    job->debug = NULL;
+    job->callback = callback;
+    job->userdata = userdata;
+    job->free_userdata = free_userdata;
+
+    gpg_jobs_submit(GPG_JOBS_DECRYPT, job);
+}
 
-    char *sign_with_header_footer = _add_header_footer(sign, PGP_SIGNATURE_HEADER, PGP_SIGNATURE_FOOTER);
+void
+p_gpg_process_completed(void)
+{
+    gpg_jobs_process_completed();
+}
+
+static char*
+_verify(gpgme_ctx_t ctx, GPGJob *job)
+{
+    char *sign_with_header_footer = _add_header_footer(job->input, PGP_SIGNATURE_HEADER, PGP_SIGNATURE_FOOTER);
     gpgme_data_t sign_data;
     gpgme_data_new_from_mem(&sign_data, sign_with_header_footer, strlen(sign_with_header_footer), 1);
     free(sign_with_header_footer);
@@ -428,54 +529,48 @@ p_gpg_verify(const char * const barejid, const char *const sign)
     gpgme_data_t plain_data;
     gpgme_data_new(&plain_data);
 
-    error = gpgme_op_verify(ctx, sign_data, NULL, plain_data);
+    gpgme_error_t error = gpgme_op_verify(ctx, sign_data, NULL, plain_data);
     gpgme_data_release(sign_data);
     gpgme_data_release(plain_data);
 
     if (error) {
-        log_error("GPG: Failed to verify. %s %s", gpgme_strsource(error), gpgme_strerror(error));
-        gpgme_release(ctx);
-        return;
+        job->error = g_strdup_printf("GPG: Failed to verify. %s %s", gpgme_strsource(error), gpgme_strerror(error));
+        return NULL;
     }
 
+    char *keyid = NULL;
     gpgme_verify_result_t result = gpgme_op_verify_result(ctx);
     if (result) {
         if (result->signatures) {
             gpgme_key_t key = NULL;
             error = gpgme_get_key(ctx, result->signatures->fpr, &key, 0);
             if (error) {
-                log_debug("Could not find PGP key with ID %s for %s", result->signatures->fpr, barejid);
+                job->debug = g_strdup_printf("Could not find PGP key with ID %s for %s", result->signatures->fpr, job->barejid);
             } else {
-                log_debug("Fingerprint found for %s: %s ", barejid, key->subkeys->fpr);
-                ProfPGPPubKeyId *pubkeyid = malloc(sizeof(ProfPGPPubKeyId));
-                pubkeyid->id = strdup(key->subkeys->keyid);
-                pubkeyid->received = TRUE;
-                g_hash_table_replace(pubkeys, strdup(barejid), pubkeyid);
+                job->debug = g_strdup_printf("Fingerprint found for %s: %s ", job->barejid, key->subkeys->fpr);
+                keyid = strdup(key->subkeys->keyid);
             }
 
             gpgme_key_unref(key);
         }
     }
 
-    gpgme_release(ctx);
+    return keyid;
 }
 
 char*
 p_gpg_sign(const char * const str, const char * const fp)
 {
-    gpgme_ctx_t ctx;
-    gpgme_error_t error = gpgme_new(&ctx);
-    if (error) {
-        log_error("GPG: Failed to create gpgme context. %s %s", gpgme_strsource(error), gpgme_strerror(error));
+    gpgme_ctx_t ctx = _main_ctx();
+    if (ctx == NULL) {
         return NULL;
     }
 
     gpgme_key_t key = NULL;
-    error = gpgme_get_key(ctx, fp, &key, 1);
+    gpgme_error_t error = gpgme_get_key(ctx, fp, &key, 1);
 
     if (error || key == NULL) {
         log_error("GPG: Failed to get key. %s %s", gpgme_strsource(error), gpgme_strerror(error));
-        gpgme_release(ctx);
         return NULL;
     }
 
@@ -485,7 +580,7 @@ p_gpg_sign(const char * const str, const char * const fp)
 
     if (error) {
         log_error("GPG: Failed to load signer. %s %s", gpgme_strsource(error), gpgme_strerror(error));
-        gpgme_release(ctx);
+        gpgme_signers_clear(ctx);
         return NULL;
     }
 
@@ -505,7 +600,7 @@ p_gpg_sign(const char * const str, const char * const fp)
     gpgme_set_armor(ctx,1);
     error = gpgme_op_sign(ctx, str_data, signed_data, GPGME_SIG_MODE_DETACH);
     gpgme_data_release(str_data);
-    gpgme_release(ctx);
+    gpgme_signers_clear(ctx);
 
     if (error) {
         log_error("GPG: Failed to sign string. %s %s", gpgme_strsource(error), gpgme_strerror(error));
@@ -544,19 +639,16 @@ p_gpg_encrypt(const char * const barejid, const char * const message)
     keys[0] = NULL;
     keys[1] = NULL;
 
-    gpgme_ctx_t ctx;
-    gpgme_error_t error = gpgme_new(&ctx);
-    if (error) {
-        log_error("GPG: Failed to create gpgme context. %s %s", gpgme_strsource(error), gpgme_strerror(error));
+    gpgme_ctx_t ctx = _main_ctx();
+    if (ctx == NULL) {
         return NULL;
     }
 
     gpgme_key_t key;
-    error = gpgme_get_key(ctx, pubkeyid->id, &key, 0);
+    gpgme_error_t error = gpgme_get_key(ctx, pubkeyid->id, &key, 0);
 
     if (error || key == NULL) {
         log_error("GPG: Failed to get key. %s %s", gpgme_strsource(error), gpgme_strerror(error));
-        gpgme_release(ctx);
         return NULL;
     }
 
@@ -571,7 +663,6 @@ p_gpg_encrypt(const char * const barejid, const char * const message)
     gpgme_set_armor(ctx, 1);
     error = gpgme_op_encrypt(ctx, keys, GPGME_ENCRYPT_ALWAYS_TRUST, plain, cipher);
     gpgme_data_release(plain);
-    gpgme_release(ctx);
     gpgme_key_unref(key);
 
     if (error) {
@@ -594,18 +685,10 @@ p_gpg_encrypt(const char * const barejid, const char * const message)
     return result;
 }
 
-char *
-p_gpg_decrypt(const char * const cipher)
+static char *
+_decrypt(gpgme_ctx_t ctx, GPGJob *job)
 {
-    gpgme_ctx_t ctx;
-    gpgme_error_t error = gpgme_new(&ctx);
-
-    if (error) {
-        log_error("GPG: Failed to create gpgme context. %s %s", gpgme_strsource(error), gpgme_strerror(error));
-        return NULL;
-    }
-
-    char *cipher_with_headers = _add_header_footer(cipher, PGP_MESSAGE_HEADER, PGP_MESSAGE_FOOTER);
+    char *cipher_with_headers = _add_header_footer(job->input, PGP_MESSAGE_HEADER, PGP_MESSAGE_FOOTER);
     gpgme_data_t cipher_data;
     gpgme_data_new_from_mem(&cipher_data, cipher_with_headers, strlen(cipher_with_headers), 1);
     free(cipher_with_headers);
@@ -613,13 +696,12 @@ p_gpg_decrypt(const char * const cipher)
     gpgme_data_t plain_data;
     gpgme_data_new(&plain_data);
 
-    error = gpgme_op_decrypt(ctx, cipher_data, plain_data);
+    gpgme_error_t error = gpgme_op_decrypt(ctx, cipher_data, plain_data);
     gpgme_data_release(cipher_data);
 
     if (error) {
-        log_error("GPG: Failed to encrypt message. %s %s", gpgme_strsource(error), gpgme_strerror(error));
+        job->error = g_strdup_printf("GPG: Failed to decrypt message. %s %s", gpgme_strsource(error), gpgme_strerror(error));
         gpgme_data_release(plain_data);
-        gpgme_release(ctx);
         return NULL;
     }
 
@@ -633,13 +715,12 @@ p_gpg_decrypt(const char * const cipher)
             if (!error && key) {
                 const char *addr = gpgme_key_get_string_attr(key, GPGME_ATTR_EMAIL, NULL, 0);
                 if (addr) {
-                    log_debug("GPG: Decrypted message for recipient: %s", addr);
+                    job->debug = g_strdup_printf("GPG: Decrypted message for recipient: %s", addr);
                 }
                 gpgme_key_unref(key);
             }
         }
     }
-    gpgme_release(ctx);
 
     size_t len = 0;
     char *plain_str = gpgme_data_release_and_get_mem(plain_data, &len);
@@ -653,12 +734,6 @@ p_gpg_decrypt(const char * const cipher)
     return result;
 }
 
-void
-p_gpg_free_decrypted(char *decrypted)
-{
-    g_free(decrypted);
-}
-
 char *
 p_gpg_autocomplete_key(const char * const search_str)
 {
@@ -715,9 +790,117 @@ _add_header_footer(const char * const str, const char * const header, const char
 static void
 _save_pubkeys(void)
 {
+    persist_store_changed(pubkeys_store);
+}
+
+static void
+_write_pubkeys(void)
+{
+    if (pubkeyfile == NULL) {
+        return;
+    }
+
     gsize g_data_size;
     gchar *g_pubkeys_data = g_key_file_to_data(pubkeyfile, &g_data_size, NULL);
-    g_file_set_contents(pubsloc, g_pubkeys_data, g_data_size, NULL);
-    g_chmod(pubsloc, S_IRUSR | S_IWUSR);
+    persist_write_file(pubsloc, g_pubkeys_data, g_data_size);
     g_free(g_pubkeys_data);
 }
+
+static gpgme_ctx_t
+_main_ctx(void)
+{
+    if (main_ctx == NULL) {
+        gpgme_error_t error = gpgme_new(&main_ctx);
+        if (error) {
+            log_error("GPG: Failed to create gpgme context. %s %s", gpgme_strsource(error), gpgme_strerror(error));
+            main_ctx = NULL;
+        }
+    }
+
+    return main_ctx;
+}
+
+static void *
+_worker_new(void)
+{
+    GPGWorker *worker = malloc(sizeof(GPGWorker));
+    worker->error = NULL;
+    gpgme_error_t error = gpgme_new(&worker->ctx);
+    if (error) {
+        worker->error = g_strdup_printf("GPG: Failed to create gpgme context. %s %s", gpgme_strsource(error), gpgme_strerror(error));
+        worker->ctx = NULL;
+    }
+
+    return worker;
+}
+
+static void
+_worker_free(void *data)
+{
+    GPGWorker *worker = data;
+    if (worker) {
+        if (worker->ctx) {
+            gpgme_release(worker->ctx);
+        }
+        g_free(worker->error);
+        free(worker);
+    }
+}
+
+static void
+_job_run(void *worker_data, void *job_data)
+{
+    GPGWorker *worker = worker_data;
+    GPGJob *job = job_data;
+    if (worker->ctx == NULL) {
+        job->error = g_strdup(worker->error);
+    } else if (job->type == GPG_JOB_VERIFY) {
+        job->output = _verify(worker->ctx, job);
+    } else {
+        job->output = _decrypt(worker->ctx, job);
+    }
+}
+
+static void
+_job_deliver(void *data)
+{
+    GPGJob *job = data;
+    if (job->error) {
+        log_error("%s", job->error);
+    }
+    if (job->debug) {
+        log_debug("%s", job->debug);
+    }
+
+    if (job->type == GPG_JOB_VERIFY) {
+        if (job->output && pubkeys) {
+            ProfPGPPubKeyId *pubkeyid = malloc(sizeof(ProfPGPPubKeyId));
+            pubkeyid->id = strdup(job->output);
+            pubkeyid->received = TRUE;
+            g_hash_table_replace(pubkeys, strdup(job->barejid), pubkeyid);
+        }
+    } else {
+        job->callback(job->output, job->userdata);
+    }
+}
+
+static void
+_job_free(void *data)
+{
+    GPGJob *job = data;
+    if (job) {
+        if (job->free_userdata) {
+            job->free_userdata(job->userdata);
+        }
+        free(job->barejid);
+        free(job->input);
+        g_free(job->error);
+        g_free(job->debug);
+        if (job->type == GPG_JOB_DECRYPT) {
+            g_free(job->output);
+        } else {
+            free(job->output);
+        }
+        free(job);
+    }
+}
@@ -51,6 +51,10 @@ typedef struct pgp_pubkeyid_t {
     gboolean received;
 } ProfPGPPubKeyId;
 
+// decrypted is NULL when decryption failed, it is freed after the callback returns
+// the callback is not called for messages decrypted after a disconnect, free_userdata still is
+typedef void (*p_gpg_decrypt_callback)(const char * const decrypted, void *userdata);
+
 void p_gpg_init(void);
 void p_gpg_close(void);
 void p_gpg_on_connect(const char * const barejid);
@@ -63,10 +67,14 @@ gboolean p_gpg_valid_key(const char * const keyid);
 gboolean p_gpg_available(const char * const barejid);
 const char* p_gpg_libver(void);
 char* p_gpg_sign(const char * const str, const char * const fp);
+// verification runs on a worker, the key id is recorded by p_gpg_process_completed
 void p_gpg_verify(const char * const barejid, const char *const sign);
 char* p_gpg_encrypt(const char * const barejid, const char * const message);
-char* p_gpg_decrypt(const char * const cipher);
-void p_gpg_free_decrypted(char *decrypted);
+void p_gpg_decrypt_async(const char * const cipher, p_gpg_decrypt_callback callback, void *userdata,
+    GDestroyNotify free_userdata);
+// deliver finished results, verify and decrypt results each in the order they were queued,
+// called from the main loop
+void p_gpg_process_completed(void);
 char* p_gpg_autocomplete_key(const char * const search_str);
 void p_gpg_autocomplete_key_reset(void);
 
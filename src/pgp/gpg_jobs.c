@@ -0,0 +1,233 @@
+/*
+ * gpg_jobs.c
+ *
+ * Copyright (C) 2012 - 2015 James Booth <boothj5@gmail.com>
+ *
+ * This file is part of Profanity.
+ *
+ * Profanity is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Profanity is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Profanity.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * In addition, as a special exception, the copyright holders give permission to
+ * link the code of portions of this program with the OpenSSL library under
+ * certain conditions as described in each individual source file, and
+ * distribute linked combinations including the two.
+ *
+ * You must obey the GNU General Public License in all respects for all of the
+ * code used other than OpenSSL. If you modify file(s) with this exception, you
+ * may extend this exception to your version of the file(s), but you are not
+ * obligated to do so. If you do not wish to do so, delete this exception
+ * statement from your version. If you delete this exception statement from all
+ * source files in the program, then also delete it here.
+ *
+ */
+
+#include "config.h"
+
+#include <stdlib.h>
+#include <pthread.h>
+
+#include <glib.h>
+
+#include "pgp/gpg_jobs.h"
+#include "log.h"
+#include "tools/wakeup.h"
+
+#define GPG_JOBS_MAX_WORKERS 8
+#define GPG_JOBS_QUEUES 2
+
+typedef struct gpg_job_entry_t {
+    void *job;
+    unsigned int generation;
+    gboolean done;
+} GPGJobEntry;
+
+static GPGJobFuncs funcs;
+static pthread_t workers[GPG_JOBS_MAX_WORKERS];
+static int worker_count;
+static gboolean workers_running;
+// worker state for running jobs on the main thread when no worker started
+static void *main_worker;
+static pthread_mutex_t jobs_lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t jobs_ready = PTHREAD_COND_INITIALIZER;
+// entries waiting for a worker
+static GQueue *jobs_pending;
+// entries of each queue in submission order, owned here, jobs_pending only borrows them
+static GQueue *jobs_ordered[GPG_JOBS_QUEUES];
+static unsigned int jobs_generation;
+
+static void * _worker_run(void *arg);
+static void _entry_free(GPGJobEntry *entry);
+
+void
+gpg_jobs_start(const GPGJobFuncs * const job_funcs, int count)
+{
+    funcs = *job_funcs;
+    jobs_pending = g_queue_new();
+    int i;
+    for (i = 0; i < GPG_JOBS_QUEUES; i++) {
+        jobs_ordered[i] = g_queue_new();
+    }
+    workers_running = TRUE;
+    worker_count = 0;
+
+    if (count > GPG_JOBS_MAX_WORKERS) {
+        count = GPG_JOBS_MAX_WORKERS;
+    }
+    for (i = 0; i < count; i++) {
+        if (pthread_create(&workers[i], NULL, _worker_run, NULL) != 0) {
+            log_error("GPG: Could not start worker thread, %d running", worker_count);
+            break;
+        }
+        worker_count++;
+    }
+}
+
+void
+gpg_jobs_stop(void)
+{
+    if (jobs_pending == NULL) {
+        return;
+    }
+
+    pthread_mutex_lock(&jobs_lock);
+    workers_running = FALSE;
+    pthread_cond_broadcast(&jobs_ready);
+    pthread_mutex_unlock(&jobs_lock);
+
+    int i;
+    for (i = 0; i < worker_count; i++) {
+        pthread_join(workers[i], NULL);
+    }
+    worker_count = 0;
+
+    if (main_worker) {
+        funcs.worker_free(main_worker);
+        main_worker = NULL;
+    }
+
+    for (i = 0; i < GPG_JOBS_QUEUES; i++) {
+        GPGJobEntry *entry = NULL;
+        while ((entry = g_queue_pop_head(jobs_ordered[i])) != NULL) {
+            _entry_free(entry);
+        }
+        g_queue_free(jobs_ordered[i]);
+        jobs_ordered[i] = NULL;
+    }
+    g_queue_free(jobs_pending);
+    jobs_pending = NULL;
+}
+
+void
+gpg_jobs_submit(gpg_jobs_queue_t queue, void *job)
+{
+    if (jobs_pending == NULL) {
+        funcs.free(job);
+        return;
+    }
+
+    GPGJobEntry *entry = malloc(sizeof(GPGJobEntry));
+    entry->job = job;
+    entry->generation = jobs_generation;
+    entry->done = FALSE;
+
+    // without workers run the job here, it is still delivered in order
+    if (worker_count == 0) {
+        if (main_worker == NULL) {
+            main_worker = funcs.worker_new();
+        }
+        funcs.run(main_worker, job);
+        entry->done = TRUE;
+        g_queue_push_tail(jobs_ordered[queue], entry);
+        return;
+    }
+
+    pthread_mutex_lock(&jobs_lock);
+    g_queue_push_tail(jobs_ordered[queue], entry);
+    g_queue_push_tail(jobs_pending, entry);
+    pthread_cond_signal(&jobs_ready);
+    pthread_mutex_unlock(&jobs_lock);
+}
+
+void
+gpg_jobs_process_completed(void)
+{
+    if (jobs_pending == NULL) {
+        return;
+    }
+
+    // only take finished entries from the front, so each queue keeps submission order
+    GQueue *finished = g_queue_new();
+    pthread_mutex_lock(&jobs_lock);
+    int i;
+    for (i = 0; i < GPG_JOBS_QUEUES; i++) {
+        GPGJobEntry *entry = g_queue_peek_head(jobs_ordered[i]);
+        while (entry && entry->done) {
+            g_queue_push_tail(finished, g_queue_pop_head(jobs_ordered[i]));
+            entry = g_queue_peek_head(jobs_ordered[i]);
+        }
+    }
+    pthread_mutex_unlock(&jobs_lock);
+
+    GPGJobEntry *entry = NULL;
+    while ((entry = g_queue_pop_head(finished)) != NULL) {
+        if (entry->generation == jobs_generation) {
+            funcs.deliver(entry->job);
+        }
+        _entry_free(entry);
+    }
+    g_queue_free(finished);
+}
+
+void
+gpg_jobs_new_generation(void)
+{
+    jobs_generation++;
+}
+
+static void *
+_worker_run(void *arg)
+{
+    void *worker = funcs.worker_new();
+
+    while (TRUE) {
+        pthread_mutex_lock(&jobs_lock);
+        while (workers_running && g_queue_is_empty(jobs_pending)) {
+            pthread_cond_wait(&jobs_ready, &jobs_lock);
+        }
+        if (!workers_running) {
+            pthread_mutex_unlock(&jobs_lock);
+            break;
+        }
+        GPGJobEntry *entry = g_queue_pop_head(jobs_pending);
+        pthread_mutex_unlock(&jobs_lock);
+
+        funcs.run(worker, entry->job);
+
+        pthread_mutex_lock(&jobs_lock);
+        entry->done = TRUE;
+        pthread_mutex_unlock(&jobs_lock);
+        wakeup_signal();
+    }
+
+    funcs.worker_free(worker);
+
+    return NULL;
+}
+
+static void
+_entry_free(GPGJobEntry *entry)
+{
+    funcs.free(entry->job);
+    free(entry);
+}
@@ -0,0 +1,64 @@
+/*
+ * gpg_jobs.h
+ *
+ * Copyright (C) 2012 - 2015 James Booth <boothj5@gmail.com>
+ *
+ * This file is part of Profanity.
+ *
+ * Profanity is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Profanity is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Profanity.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * In addition, as a special exception, the copyright holders give permission to
+ * link the code of portions of this program with the OpenSSL library under
+ * certain conditions as described in each individual source file, and
+ * distribute linked combinations including the two.
+ *
+ * You must obey the GNU General Public License in all respects for all of the
+ * code used other than OpenSSL. If you modify file(s) with this exception, you
+ * may extend this exception to your version of the file(s), but you are not
+ * obligated to do so. If you do not wish to do so, delete this exception
+ * statement from your version. If you delete this exception statement from all
+ * source files in the program, then also delete it here.
+ *
+ */
+
+#ifndef GPG_JOBS_H
+#define GPG_JOBS_H
+
+// pool of worker threads for gpg operations, results are handed back to the
+// main thread in submission order within each queue
+typedef enum {
+    GPG_JOBS_VERIFY,
+    GPG_JOBS_DECRYPT
+} gpg_jobs_queue_t;
+
+typedef struct gpg_job_funcs_t {
+    // per worker state, created and freed on the thread that uses it
+    void* (*worker_new)(void);
+    void (*worker_free)(void *worker);
+    // called on a worker, or on the main thread when no worker could be started
+    void (*run)(void *worker, void *job);
+    // called on the main thread for jobs submitted since the last new generation
+    void (*deliver)(void *job);
+    void (*free)(void *job);
+} GPGJobFuncs;
+
+void gpg_jobs_start(const GPGJobFuncs * const job_funcs, int count);
+void gpg_jobs_stop(void);
+void gpg_jobs_submit(gpg_jobs_queue_t queue, void *job);
+// deliver finished jobs from the front of each queue, called from the main loop
+void gpg_jobs_process_completed(void);
+// jobs submitted before this are freed without being delivered
+void gpg_jobs_new_generation(void);
+
+#endif
@@ -56,7 +56,12 @@
 #include "contact.h"
 #include "roster_list.h"
 #include "log.h"
+#include "log_index.h"
 #include "muc.h"
+#include "tools/http.h"
+#include "tools/perf.h"
+#include "tools/persist.h"
+#include "tools/wakeup.h"
 #ifdef HAVE_LIBOTR
 #include "otr/otr.h"
 #endif
@@ -104,9 +109,22 @@ prof_run(const int disable_tls, char *log_level, char *account_name)
 
 #ifdef HAVE_LIBOTR
         otr_poll();
+#endif
+#ifdef HAVE_LIBGPGME
+        p_gpg_process_completed();
 #endif
         notify_remind();
-        jabber_process_events(10);
+        chat_log_flush();
+        log_index_process();
+        persist_flush();
+        http_process_completed();
+
+        // when the xmpp socket is watched by ui_readline, drain what is waiting without blocking
+        if (jabber_get_socket() != -1) {
+            jabber_process_events(0);
+        } else {
+            jabber_process_events(10);
+        }
         ui_update();
     }
 }
@@ -152,10 +170,9 @@ _connect_default(const char * const account)
     if (account) {
         cmd_execute_connect(window, account);
     } else {
-        char *pref_connect_account = prefs_get_string(PREF_CONNECT_ACCOUNT);
+        const char *pref_connect_account = prefs_get_string(PREF_CONNECT_ACCOUNT);
         if (pref_connect_account) {
             cmd_execute_connect(window, pref_connect_account);
-            prefs_free_string(pref_connect_account);
         }
     }
 }
@@ -170,14 +187,14 @@ _check_autoaway()
 
     gint prefs_time = prefs_get_autoaway_time() * 60000;
     unsigned long idle_ms = ui_get_idle_time();
-    char *pref_autoaway_mode = prefs_get_string(PREF_AUTOAWAY_MODE);
+    const char *pref_autoaway_mode = prefs_get_string(PREF_AUTOAWAY_MODE);
 
     if (!idle) {
         resource_presence_t current_presence = accounts_get_last_presence(jabber_get_account_name());
         if ((current_presence == RESOURCE_ONLINE) || (current_presence == RESOURCE_CHAT)) {
             if (idle_ms >= prefs_time) {
                 idle = TRUE;
-                char *pref_autoaway_message = prefs_get_string(PREF_AUTOAWAY_MESSAGE);
+                const char *pref_autoaway_message = prefs_get_string(PREF_AUTOAWAY_MESSAGE);
 
                 // handle away mode
                 if (strcmp(pref_autoaway_mode, "away") == 0) {
@@ -188,8 +205,6 @@ _check_autoaway()
                 } else if (strcmp(pref_autoaway_mode, "idle") == 0) {
                     cl_ev_presence_send(RESOURCE_ONLINE, pref_autoaway_message, idle_ms / 1000);
                 }
-
-                prefs_free_string(pref_autoaway_message);
             }
         }
 
@@ -209,8 +224,6 @@ _check_autoaway()
             }
         }
     }
-
-    prefs_free_string(pref_autoaway_mode);
 }
 
 static void
@@ -227,6 +240,7 @@ _init(const int disable_tls, char *log_level)
     prefs_load();
     log_init(prof_log_level);
     log_stderr_init(PROF_LEVEL_ERROR);
+    wakeup_init();
     if (strcmp(PACKAGE_STATUS, "development") == 0) {
 #ifdef HAVE_GIT_VERSION
             log_info("Starting Profanity (%sdev.%s.%s)...", PACKAGE_VERSION, PROF_GIT_BRANCH, PROF_GIT_REVISION);
@@ -239,9 +253,8 @@ _init(const int disable_tls, char *log_level)
     chat_log_init();
     groupchat_log_init();
     accounts_load();
-    char *theme = prefs_get_string(PREF_THEME);
+    const char *theme = prefs_get_string(PREF_THEME);
     theme_init(theme);
-    prefs_free_string(theme);
     ui_init();
     jabber_init(disable_tls);
     cmd_init();
@@ -261,6 +274,7 @@ _init(const int disable_tls, char *log_level)
 static void
 _shutdown(void)
 {
+    persist_flush_all();
     if (prefs_get_boolean(PREF_TITLEBAR_SHOW)) {
         if (prefs_get_boolean(PREF_TITLEBAR_GOODBYE)) {
             ui_goodbye_title();
@@ -271,6 +285,8 @@ _shutdown(void)
     ui_close_all_wins();
     jabber_disconnect();
     jabber_shutdown();
+    http_close();
+    perf_close();
     roster_free();
     muc_close();
     caps_close();
@@ -285,6 +301,7 @@ _shutdown(void)
     theme_close();
     accounts_close();
     cmd_uninit();
+    wakeup_close();
     log_stderr_close();
     log_close();
     prefs_close();
@@ -33,6 +33,7 @@
  */
 
 
+#include <stdlib.h>
 #include <string.h>
 #include <glib.h>
 #include <assert.h>
@@ -62,6 +63,29 @@ static GHashTable *contacts;
 // nickname to jid map
 static GHashTable *name_to_barejid;
 
+// sorted views of the roster, kept up to date as contacts change
+typedef struct roster_view_entry_t {
+    GSequenceIter *all_iter;
+    GSequenceIter *presence_iter;
+    GSequenceIter *nogroup_iter;
+    GSList *group_iters;
+} RosterViewEntry;
+
+// all contacts
+static GSequence *all_view;
+
+// contacts with no group
+static GSequence *nogroup_view;
+
+// presence string to contacts
+static GHashTable *presence_views;
+
+// group name to contacts
+static GHashTable *group_views;
+
+// contact to its positions in the views
+static GHashTable *view_entries;
+
 static gboolean _key_equals(void *key1, void *key2);
 static gboolean _datetimes_equal(GDateTime *dt1, GDateTime *dt2);
 static void _replace_name(const char * const current_name,
@@ -69,6 +93,16 @@ static void _replace_name(const char * const current_name,
 static void _add_name_and_barejid(const char * const name,
     const char * const barejid);
 static gint _compare_contacts(PContact a, PContact b);
+static gint _compare_contacts_data(gconstpointer a, gconstpointer b, gpointer user_data);
+static void _views_init(void);
+static void _views_destroy(void);
+static void _views_add(PContact contact);
+static GSequenceIter* _view_insert(GSequence *view, PContact contact);
+static void _views_remove(PContact contact);
+static void _views_update_presence(PContact contact, const char * const old_presence);
+static GSList* _view_to_list(GSequence *view);
+static void _view_entry_free(RosterViewEntry *entry);
+static void _contact_free(PContact contact);
 
 void
 roster_clear(void)
@@ -79,7 +113,9 @@ roster_clear(void)
     autocomplete_clear(groups_ac);
     g_hash_table_destroy(contacts);
     contacts = g_hash_table_new_full(g_str_hash, (GEqualFunc)_key_equals, g_free,
-        (GDestroyNotify)p_contact_free);
+        (GDestroyNotify)_contact_free);
+    _views_destroy();
+    _views_init();
     g_hash_table_destroy(name_to_barejid);
     name_to_barejid = g_hash_table_new_full(g_str_hash, g_str_equal, g_free,
         g_free);
@@ -99,7 +135,9 @@ roster_update_presence(const char * const barejid, Resource *resource,
     if (!_datetimes_equal(p_contact_last_activity(contact), last_activity)) {
         p_contact_set_last_activity(contact, last_activity);
     }
+    const char *old_presence = p_contact_presence(contact);
     p_contact_set_presence(contact, resource);
+    _views_update_presence(contact, old_presence);
     Jid *jid = jid_create_from_bare_and_resource(barejid, resource->name);
     autocomplete_add(fulljid_ac, jid->fulljid);
     jid_destroy(jid);
@@ -156,7 +194,9 @@ roster_contact_offline(const char * const barejid,
     if (resource == NULL) {
         return TRUE;
     } else {
+        const char *old_presence = p_contact_presence(contact);
         gboolean result = p_contact_remove_resource(contact, resource);
+        _views_update_presence(contact, old_presence);
         if (result == TRUE) {
             Jid *jid = jid_create_from_bare_and_resource(barejid, resource);
             autocomplete_remove(fulljid_ac, jid->fulljid);
@@ -184,9 +224,10 @@ roster_init(void)
     fulljid_ac = autocomplete_new();
     groups_ac = autocomplete_new();
     contacts = g_hash_table_new_full(g_str_hash, (GEqualFunc)_key_equals, g_free,
-        (GDestroyNotify)p_contact_free);
+        (GDestroyNotify)_contact_free);
     name_to_barejid = g_hash_table_new_full(g_str_hash, g_str_equal, g_free,
         g_free);
+    _views_init();
 }
 
 void
@@ -196,6 +237,7 @@ roster_free(void)
     autocomplete_free(barejid_ac);
     autocomplete_free(fulljid_ac);
     autocomplete_free(groups_ac);
+    _views_destroy();
 }
 
 void
@@ -210,7 +252,9 @@ roster_change_name(PContact contact, const char * const new_name)
         current_name = strdup(p_contact_name(contact));
     }
 
+    _views_remove(contact);
     p_contact_set_name(contact, new_name);
+    _views_add(contact);
     _replace_name(current_name, new_name, barejid);
 }
 
@@ -256,8 +300,10 @@ roster_update(const char * const barejid, const char * const name,
         current_name = strdup(p_contact_name(contact));
     }
 
+    _views_remove(contact);
     p_contact_set_name(contact, new_name);
     p_contact_set_groups(contact, groups);
+    _views_add(contact);
     _replace_name(current_name, new_name, barejid);
 
     // add groups
@@ -286,12 +332,73 @@ roster_add(const char * const barejid, const char * const name, GSList *groups,
     }
 
     g_hash_table_insert(contacts, strdup(barejid), contact);
+    _views_add(contact);
     autocomplete_add(barejid_ac, barejid);
     _add_name_and_barejid(name, barejid);
 
     return TRUE;
 }
 
+gint
+roster_add_all(GSList *new_contacts)
+{
+    // sort once so that each view is filled by appending
+    GSList *sorted = g_slist_sort(g_slist_copy(new_contacts), (GCompareFunc)_compare_contacts);
+
+    GSList *names = NULL;
+    GSList *barejids = NULL;
+    GSList *groups = NULL;
+    gint added = 0;
+
+    GSList *curr = new_contacts;
+    while (curr) {
+        PContact contact = curr->data;
+        const char *barejid = p_contact_barejid(contact);
+
+        if (g_hash_table_lookup(contacts, barejid)) {
+            sorted = g_slist_remove(sorted, contact);
+            p_contact_free(contact);
+        } else {
+            g_hash_table_insert(contacts, strdup(barejid), contact);
+            barejids = g_slist_prepend(barejids, (gpointer)barejid);
+
+            const char *name = p_contact_name(contact);
+            if (name) {
+                names = g_slist_prepend(names, (gpointer)name);
+                g_hash_table_insert(name_to_barejid, strdup(name), strdup(barejid));
+            } else {
+                names = g_slist_prepend(names, (gpointer)barejid);
+                g_hash_table_insert(name_to_barejid, strdup(barejid), strdup(barejid));
+            }
+
+            GSList *curr_group = p_contact_groups(contact);
+            while (curr_group) {
+                groups = g_slist_prepend(groups, curr_group->data);
+                curr_group = g_slist_next(curr_group);
+            }
+            added++;
+        }
+        curr = g_slist_next(curr);
+    }
+    g_slist_free(new_contacts);
+
+    curr = sorted;
+    while (curr) {
+        _views_add(curr->data);
+        curr = g_slist_next(curr);
+    }
+    g_slist_free(sorted);
+
+    autocomplete_add_all(barejid_ac, barejids);
+    autocomplete_add_all(name_ac, names);
+    autocomplete_add_all(groups_ac, groups);
+    g_slist_free(barejids);
+    g_slist_free(names);
+    g_slist_free(groups);
+
+    return added;
+}
+
 char *
 roster_barejid_from_name(const char * const name)
 {
@@ -305,56 +412,30 @@ roster_barejid_from_name(const char * const name)
 GSList *
 roster_get_contacts_by_presence(const char * const presence)
 {
-    GSList *result = NULL;
-    GHashTableIter iter;
-    gpointer key;
-    gpointer value;
-
-    g_hash_table_iter_init(&iter, contacts);
-    while (g_hash_table_iter_next(&iter, &key, &value)) {
-        PContact contact = (PContact)value;
-        if (g_strcmp0(p_contact_presence(contact), presence) == 0) {
-            result = g_slist_insert_sorted(result, value, (GCompareFunc)_compare_contacts);
-        }
-    }
-
-    // return all contact structs
-    return result;
+    return _view_to_list(g_hash_table_lookup(presence_views, presence));
 }
 
 GSList *
 roster_get_contacts(void)
 {
-    GSList *result = NULL;
-    GHashTableIter iter;
-    gpointer key;
-    gpointer value;
-
-    g_hash_table_iter_init(&iter, contacts);
-    while (g_hash_table_iter_next(&iter, &key, &value)) {
-        result = g_slist_insert_sorted(result, value, (GCompareFunc)_compare_contacts);
-    }
-
-    // return all contact structs
-    return result;
+    return _view_to_list(all_view);
 }
 
 GSList *
 roster_get_contacts_online(void)
 {
     GSList *result = NULL;
-    GHashTableIter iter;
-    gpointer key;
-    gpointer value;
-
-    g_hash_table_iter_init(&iter, contacts);
-    while (g_hash_table_iter_next(&iter, &key, &value)) {
-        if(strcmp(p_contact_presence(value), "offline"))
-            result = g_slist_insert_sorted(result, value, (GCompareFunc)_compare_contacts);
+    GSequenceIter *curr = g_sequence_get_begin_iter(all_view);
+    while (!g_sequence_iter_is_end(curr)) {
+        PContact contact = g_sequence_get(curr);
+        if (strcmp(p_contact_presence(contact), "offline")) {
+            result = g_slist_prepend(result, contact);
+        }
+        curr = g_sequence_iter_next(curr);
     }
 
     // return all contact structs
-    return result;
+    return g_slist_reverse(result);
 }
 
 gboolean
@@ -390,45 +471,13 @@ roster_fulljid_autocomplete(const char * const search_str)
 GSList *
 roster_get_nogroup(void)
 {
-    GSList *result = NULL;
-    GHashTableIter iter;
-    gpointer key;
-    gpointer value;
-
-    g_hash_table_iter_init(&iter, contacts);
-    while (g_hash_table_iter_next(&iter, &key, &value)) {
-        GSList *groups = p_contact_groups(value);
-        if (groups == NULL) {
-            result = g_slist_insert_sorted(result, value, (GCompareFunc)_compare_contacts);
-        }
-    }
-
-    // return all contact structs
-    return result;
+    return _view_to_list(nogroup_view);
 }
 
 GSList *
 roster_get_group(const char * const group)
 {
-    GSList *result = NULL;
-    GHashTableIter iter;
-    gpointer key;
-    gpointer value;
-
-    g_hash_table_iter_init(&iter, contacts);
-    while (g_hash_table_iter_next(&iter, &key, &value)) {
-        GSList *groups = p_contact_groups(value);
-        while (groups) {
-            if (strcmp(groups->data, group) == 0) {
-                result = g_slist_insert_sorted(result, value, (GCompareFunc)_compare_contacts);
-                break;
-            }
-            groups = g_slist_next(groups);
-        }
-    }
-
-    // return all contact structs
-    return result;
+    return _view_to_list(g_hash_table_lookup(group_views, group));
 }
 
 GSList *
@@ -520,5 +569,152 @@ gint _compare_contacts(PContact a, PContact b)
 
     gint result = g_strcmp0(utf8_str_a, utf8_str_b);
 
+    // keep an exact order for contacts sharing a name
+    if (result == 0) {
+        result = g_strcmp0(p_contact_barejid(a), p_contact_barejid(b));
+    }
+
+    return result;
+}
+
+static gint
+_compare_contacts_data(gconstpointer a, gconstpointer b, gpointer user_data)
+{
+    return _compare_contacts((PContact)a, (PContact)b);
+}
+
+static void
+_views_init(void)
+{
+    all_view = g_sequence_new(NULL);
+    nogroup_view = g_sequence_new(NULL);
+    presence_views = g_hash_table_new_full(g_str_hash, g_str_equal, g_free,
+        (GDestroyNotify)g_sequence_free);
+    group_views = g_hash_table_new_full(g_str_hash, g_str_equal, g_free,
+        (GDestroyNotify)g_sequence_free);
+    view_entries = g_hash_table_new_full(g_direct_hash, g_direct_equal, NULL,
+        (GDestroyNotify)_view_entry_free);
+}
+
+static void
+_views_destroy(void)
+{
+    g_hash_table_destroy(view_entries);
+    g_hash_table_destroy(presence_views);
+    g_hash_table_destroy(group_views);
+    g_sequence_free(all_view);
+    g_sequence_free(nogroup_view);
+}
+
+static GSequence*
+_get_view(GHashTable *views, const char * const key)
+{
+    GSequence *view = g_hash_table_lookup(views, key);
+    if (view == NULL) {
+        view = g_sequence_new(NULL);
+        g_hash_table_insert(views, strdup(key), view);
+    }
+
+    return view;
+}
+
+static void
+_views_add(PContact contact)
+{
+    RosterViewEntry *entry = malloc(sizeof(RosterViewEntry));
+    entry->all_iter = _view_insert(all_view, contact);
+    GSequence *presence_view = _get_view(presence_views, p_contact_presence(contact));
+    entry->presence_iter = _view_insert(presence_view, contact);
+    entry->nogroup_iter = NULL;
+    entry->group_iters = NULL;
+
+    GSList *groups = p_contact_groups(contact);
+    if (groups == NULL) {
+        entry->nogroup_iter = _view_insert(nogroup_view, contact);
+    }
+    GSList *curr_group = groups;
+    while (curr_group) {
+        // ignore groups listed more than once
+        if (g_slist_find_custom(groups, curr_group->data, (GCompareFunc)g_strcmp0) == curr_group) {
+            GSequence *group_view = _get_view(group_views, curr_group->data);
+            GSequenceIter *iter = _view_insert(group_view, contact);
+            entry->group_iters = g_slist_append(entry->group_iters, iter);
+        }
+        curr_group = g_slist_next(curr_group);
+    }
+
+    g_hash_table_replace(view_entries, contact, entry);
+}
+
+// append when the contact sorts last, as it does when loading a sorted roster
+static GSequenceIter*
+_view_insert(GSequence *view, PContact contact)
+{
+    GSequenceIter *end = g_sequence_get_end_iter(view);
+    if (g_sequence_iter_is_begin(end) ||
+            _compare_contacts(g_sequence_get(g_sequence_iter_prev(end)), contact) < 0) {
+        return g_sequence_append(view, contact);
+    }
+
+    return g_sequence_insert_sorted(view, contact, _compare_contacts_data, NULL);
+}
+
+static void
+_views_remove(PContact contact)
+{
+    g_hash_table_remove(view_entries, contact);
+}
+
+static void
+_views_update_presence(PContact contact, const char * const old_presence)
+{
+    const char *new_presence = p_contact_presence(contact);
+    if (g_strcmp0(old_presence, new_presence) == 0) {
+        return;
+    }
+
+    RosterViewEntry *entry = g_hash_table_lookup(view_entries, contact);
+    if (entry == NULL) {
+        return;
+    }
+
+    g_sequence_remove(entry->presence_iter);
+    GSequence *presence_view = _get_view(presence_views, new_presence);
+    entry->presence_iter = g_sequence_insert_sorted(presence_view, contact, _compare_contacts_data, NULL);
+}
+
+static GSList*
+_view_to_list(GSequence *view)
+{
+    if (view == NULL) {
+        return NULL;
+    }
+
+    GSList *result = NULL;
+    GSequenceIter *curr = g_sequence_get_end_iter(view);
+    while (!g_sequence_iter_is_begin(curr)) {
+        curr = g_sequence_iter_prev(curr);
+        result = g_slist_prepend(result, g_sequence_get(curr));
+    }
+
     return result;
 }
+
+static void
+_contact_free(PContact contact)
+{
+    _views_remove(contact);
+    p_contact_free(contact);
+}
+
+static void
+_view_entry_free(RosterViewEntry *entry)
+{
+    g_sequence_remove(entry->all_iter);
+    g_sequence_remove(entry->presence_iter);
+    if (entry->nogroup_iter) {
+        g_sequence_remove(entry->nogroup_iter);
+    }
+    g_slist_free_full(entry->group_iters, (GDestroyNotify)g_sequence_remove);
+    free(entry);
+}
@@ -55,6 +55,7 @@ void roster_update(const char * const barejid, const char * const name,
     GSList *groups, const char * const subscription, gboolean pending_out);
 gboolean roster_add(const char * const barejid, const char * const name, GSList *groups,
     const char * const subscription, gboolean pending_out);
+gint roster_add_all(GSList *new_contacts);
 char * roster_barejid_from_name(const char * const name);
 GSList * roster_get_contacts(void);
 GSList * roster_get_contacts_online(void);
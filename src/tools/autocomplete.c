@@ -40,21 +40,32 @@
 #include "tools/autocomplete.h"
 #include "tools/parser.h"
 
+#define AC_INITIAL_CAPACITY 16
+
+// items kept sorted, last_found is an index into items or -1
 struct autocomplete_t {
-    GSList *items;
-    GSList *last_found;
+    char **items;
+    int size;
+    int capacity;
+    int last_found;
     gchar *search_str;
+    size_t search_len;
 };
 
-static gchar * _search_from(Autocomplete ac, GSList *curr, gboolean quote);
+static gchar * _search_from(Autocomplete ac, int index, gboolean quote);
+static int _lower_bound(Autocomplete ac, const char * const item);
+static int _cmp_items(const void *a, const void *b);
 
 Autocomplete
 autocomplete_new(void)
 {
     Autocomplete new = malloc(sizeof(struct autocomplete_t));
     new->items = NULL;
-    new->last_found = NULL;
+    new->size = 0;
+    new->capacity = 0;
+    new->last_found = -1;
     new->search_str = NULL;
+    new->search_len = 0;
 
     return new;
 }
@@ -63,8 +74,13 @@ void
 autocomplete_clear(Autocomplete ac)
 {
     if (ac) {
-        g_slist_free_full(ac->items, free);
-        ac->items = NULL;
+        int i;
+        for (i = 0; i < ac->size; i++) {
+            free(ac->items[i]);
+        }
+        FREE_SET_NULL(ac->items);
+        ac->size = 0;
+        ac->capacity = 0;
 
         autocomplete_reset(ac);
     }
@@ -73,8 +89,9 @@ autocomplete_clear(Autocomplete ac)
 void
 autocomplete_reset(Autocomplete ac)
 {
-    ac->last_found = NULL;
+    ac->last_found = -1;
     FREE_SET_NULL(ac->search_str);
+    ac->search_len = 0;
 }
 
 void
@@ -91,10 +108,8 @@ autocomplete_length(Autocomplete ac)
 {
     if (!ac) {
         return 0;
-    } else if (!ac->items) {
-        return 0;
     } else {
-        return g_slist_length(ac->items);
+        return ac->size;
     }
 }
 
@@ -102,38 +117,87 @@ void
 autocomplete_add(Autocomplete ac, const char *item)
 {
     if (ac) {
-        char *item_cpy;
-        GSList *curr = g_slist_find_custom(ac->items, item, (GCompareFunc)strcmp);
+        int index = _lower_bound(ac, item);
 
         // if item already exists
-        if (curr) {
+        if (index < ac->size && strcmp(ac->items[index], item) == 0) {
             return;
         }
 
-        item_cpy = strdup(item);
-        ac->items = g_slist_insert_sorted(ac->items, item_cpy, (GCompareFunc)strcmp);
+        if (ac->size == ac->capacity) {
+            ac->capacity = ac->capacity == 0 ? AC_INITIAL_CAPACITY : ac->capacity * 2;
+            ac->items = realloc(ac->items, ac->capacity * sizeof(char *));
+        }
+
+        memmove(&ac->items[index + 1], &ac->items[index], (ac->size - index) * sizeof(char *));
+        ac->items[index] = strdup(item);
+        ac->size++;
+
+        // keep last found pointing at the same item
+        if (ac->last_found >= index) {
+            ac->last_found++;
+        }
     }
 
     return;
 }
 
+void
+autocomplete_add_all(Autocomplete ac, GSList *items)
+{
+    if (ac == NULL || items == NULL) {
+        return;
+    }
+
+    guint count = g_slist_length(items);
+    if (ac->size + count > ac->capacity) {
+        ac->capacity = ac->size + count;
+        ac->items = realloc(ac->items, ac->capacity * sizeof(char *));
+    }
+
+    // append everything, then sort once and drop duplicates
+    GSList *curr = items;
+    while (curr) {
+        ac->items[ac->size++] = strdup(curr->data);
+        curr = g_slist_next(curr);
+    }
+    qsort(ac->items, ac->size, sizeof(char *), _cmp_items);
+
+    int i;
+    int last = 0;
+    for (i = 1; i < ac->size; i++) {
+        if (strcmp(ac->items[last], ac->items[i]) == 0) {
+            free(ac->items[i]);
+        } else {
+            ac->items[++last] = ac->items[i];
+        }
+    }
+    ac->size = last + 1;
+
+    // positions have moved, restart any search in progress
+    ac->last_found = -1;
+}
+
 void
 autocomplete_remove(Autocomplete ac, const char * const item)
 {
     if (ac) {
-        GSList *curr = g_slist_find_custom(ac->items, item, (GCompareFunc)strcmp);
+        int index = _lower_bound(ac, item);
 
-        if (!curr) {
+        if (index == ac->size || strcmp(ac->items[index], item) != 0) {
             return;
         }
 
         // reset last found if it points to the item to be removed
-        if (ac->last_found == curr) {
-            ac->last_found = NULL;
+        if (ac->last_found == index) {
+            ac->last_found = -1;
+        } else if (ac->last_found > index) {
+            ac->last_found--;
         }
 
-        free(curr->data);
-        ac->items = g_slist_delete_link(ac->items, curr);
+        free(ac->items[index]);
+        memmove(&ac->items[index], &ac->items[index + 1], (ac->size - index - 1) * sizeof(char *));
+        ac->size--;
     }
 
     return;
@@ -143,11 +207,10 @@ GSList *
 autocomplete_create_list(Autocomplete ac)
 {
     GSList *copy = NULL;
-    GSList *curr = ac->items;
+    int i;
 
-    while(curr) {
-        copy = g_slist_append(copy, strdup(curr->data));
-        curr = g_slist_next(curr);
+    for (i = ac->size - 1; i >= 0; i--) {
+        copy = g_slist_prepend(copy, strdup(ac->items[i]));
     }
 
     return copy;
@@ -156,16 +219,9 @@ autocomplete_create_list(Autocomplete ac)
 gboolean
 autocomplete_contains(Autocomplete ac, const char *value)
 {
-    GSList *curr = ac->items;
-
-    while(curr) {
-        if (strcmp(curr->data, value) == 0) {
-            return TRUE;
-        }
-        curr = g_slist_next(curr);
-    }
+    int index = _lower_bound(ac, value);
 
-    return FALSE;
+    return (index < ac->size && strcmp(ac->items[index], value) == 0);
 }
 
 gchar *
@@ -179,31 +235,32 @@ autocomplete_complete(Autocomplete ac, const gchar *search_str, gboolean quote)
     }
 
     // no items to search
-    if (!ac->items) {
+    if (ac->size == 0) {
         return NULL;
     }
 
     // first search attempt
-    if (!ac->last_found) {
+    if (ac->last_found == -1) {
         if (ac->search_str) {
             FREE_SET_NULL(ac->search_str);
         }
 
         ac->search_str = strdup(search_str);
-        found = _search_from(ac, ac->items, quote);
+        ac->search_len = strlen(search_str);
+        found = _search_from(ac, _lower_bound(ac, ac->search_str), quote);
 
         return found;
 
     // subsequent search attempt
     } else {
-        // search from here+1 to end
-        found = _search_from(ac, g_slist_next(ac->last_found), quote);
+        // matches are adjacent, so try the item after the last one found
+        found = _search_from(ac, ac->last_found + 1, quote);
         if (found) {
             return found;
         }
 
-        // search from beginning
-        found = _search_from(ac, ac->items, quote);
+        // search from first match
+        found = _search_from(ac, _lower_bound(ac, ac->search_str), quote);
         if (found) {
             return found;
         }
@@ -310,35 +367,56 @@ autocomplete_param_no_with_func(const char * const input, char *command, int arg
 }
 
 static gchar *
-_search_from(Autocomplete ac, GSList *curr, gboolean quote)
+_search_from(Autocomplete ac, int index, gboolean quote)
 {
-    while(curr) {
-
-        // match found
-        if (strncmp(curr->data, ac->search_str, strlen(ac->search_str)) == 0) {
+    // match found
+    if (index < ac->size && strncmp(ac->items[index], ac->search_str, ac->search_len) == 0) {
+        char *item = ac->items[index];
 
-            // set pointer to last found
-            ac->last_found = curr;
+        // set index of last found
+        ac->last_found = index;
 
-            // if contains space, quote before returning
-            if (quote && g_strrstr(curr->data, " ")) {
-                GString *quoted = g_string_new("\"");
-                g_string_append(quoted, curr->data);
-                g_string_append(quoted, "\"");
+        // if contains space, quote before returning
+        if (quote && g_strrstr(item, " ")) {
+            GString *quoted = g_string_new("\"");
+            g_string_append(quoted, item);
+            g_string_append(quoted, "\"");
 
-                gchar *result = quoted->str;
-                g_string_free(quoted, FALSE);
+            gchar *result = quoted->str;
+            g_string_free(quoted, FALSE);
 
-                return result;
+            return result;
 
-            // otherwise just return the string
-            } else {
-                return strdup(curr->data);
-            }
+        // otherwise just return the string
+        } else {
+            return strdup(item);
         }
-
-        curr = g_slist_next(curr);
     }
 
     return NULL;
 }
+
+// index of the first item not less than the given item
+static int
+_lower_bound(Autocomplete ac, const char * const item)
+{
+    int low = 0;
+    int high = ac->size;
+
+    while (low < high) {
+        int mid = low + (high - low) / 2;
+        if (strcmp(ac->items[mid], item) < 0) {
+            low = mid + 1;
+        } else {
+            high = mid;
+        }
+    }
+
+    return low;
+}
+
+static int
+_cmp_items(const void *a, const void *b)
+{
+    return strcmp(*(char * const *)a, *(char * const *)b);
+}
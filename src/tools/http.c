@@ -0,0 +1,264 @@
+/*
+ * http.c
+ *
+ * Copyright (C) 2012 - 2015 James Booth <boothj5@gmail.com>
+ *
+ * This file is part of Profanity.
+ *
+ * Profanity is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Profanity is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Profanity.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * In addition, as a special exception, the copyright holders give permission to
+ * link the code of portions of this program with the OpenSSL library under
+ * certain conditions as described in each individual source file, and
+ * distribute linked combinations including the two.
+ *
+ * You must obey the GNU General Public License in all respects for all of the
+ * code used other than OpenSSL. If you modify file(s) with this exception, you
+ * may extend this exception to your version of the file(s), but you are not
+ * obligated to do so. If you do not wish to do so, delete this exception
+ * statement from your version. If you delete this exception statement from all
+ * source files in the program, then also delete it here.
+ *
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+
+#include <curl/curl.h>
+#include <curl/easy.h>
+#include <glib.h>
+
+#include "tools/http.h"
+#include "tools/wakeup.h"
+#include "log.h"
+
+typedef struct http_request_t {
+    char *url;
+    long timeout;
+    http_callback callback;
+    void *userdata;
+    GDestroyNotify free_userdata;
+    char *body;
+    size_t size;
+    gboolean failed;
+} HTTPRequest;
+
+static gboolean started = FALSE;
+static gboolean running = FALSE;
+static pthread_t worker_thread;
+static pthread_mutex_t http_lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t http_ready = PTHREAD_COND_INITIALIZER;
+static GQueue *pending;
+static GQueue *completed;
+
+static void * _worker_run(void *arg);
+static void _perform(HTTPRequest *request);
+static size_t _data_callback(void *ptr, size_t size, size_t nmemb, void *data);
+static int _progress_callback(void *data, double dltotal, double dlnow, double ultotal, double ulnow);
+static void _request_free(HTTPRequest *request);
+
+void
+http_get(const char * const url, long timeout, http_callback callback, void *userdata,
+    GDestroyNotify free_userdata)
+{
+    HTTPRequest *request = malloc(sizeof(HTTPRequest));
+    request->url = strdup(url);
+    request->timeout = timeout;
+    request->callback = callback;
+    request->userdata = userdata;
+    request->free_userdata = free_userdata;
+    request->body = NULL;
+    request->size = 0;
+    request->failed = FALSE;
+
+    if (!started) {
+        // curl's global state is not thread safe, set it up before the worker exists
+        curl_global_init(CURL_GLOBAL_ALL);
+        pending = g_queue_new();
+        completed = g_queue_new();
+        running = TRUE;
+        if (pthread_create(&worker_thread, NULL, _worker_run, NULL) != 0) {
+            log_error("Could not start HTTP worker thread");
+            running = FALSE;
+            request->failed = TRUE;
+            g_queue_push_tail(completed, request);
+            started = TRUE;
+            return;
+        }
+        started = TRUE;
+    }
+
+    pthread_mutex_lock(&http_lock);
+    if (running) {
+        g_queue_push_tail(pending, request);
+        pthread_cond_signal(&http_ready);
+    } else {
+        request->failed = TRUE;
+        g_queue_push_tail(completed, request);
+    }
+    pthread_mutex_unlock(&http_lock);
+}
+
+void
+http_process_completed(void)
+{
+    if (!started) {
+        return;
+    }
+
+    pthread_mutex_lock(&http_lock);
+    GQueue *finished = completed;
+    completed = g_queue_new();
+    pthread_mutex_unlock(&http_lock);
+
+    HTTPRequest *request = NULL;
+    while ((request = g_queue_pop_head(finished)) != NULL) {
+        if (request->failed) {
+            request->callback(NULL, request->userdata);
+        } else {
+            request->callback(request->body, request->userdata);
+        }
+        _request_free(request);
+    }
+    g_queue_free(finished);
+}
+
+void
+http_close(void)
+{
+    if (!started) {
+        return;
+    }
+
+    pthread_mutex_lock(&http_lock);
+    gboolean was_running = running;
+    running = FALSE;
+    pthread_cond_signal(&http_ready);
+    pthread_mutex_unlock(&http_lock);
+
+    // a request in progress is aborted by the progress callback
+    if (was_running) {
+        pthread_join(worker_thread, NULL);
+    }
+
+    HTTPRequest *request = NULL;
+    while ((request = g_queue_pop_head(pending)) != NULL) {
+        _request_free(request);
+    }
+    while ((request = g_queue_pop_head(completed)) != NULL) {
+        _request_free(request);
+    }
+    g_queue_free(pending);
+    g_queue_free(completed);
+    pending = NULL;
+    completed = NULL;
+    curl_global_cleanup();
+    started = FALSE;
+}
+
+static void *
+_worker_run(void *arg)
+{
+    while (TRUE) {
+        pthread_mutex_lock(&http_lock);
+        while (running && g_queue_is_empty(pending)) {
+            pthread_cond_wait(&http_ready, &http_lock);
+        }
+        if (!running) {
+            pthread_mutex_unlock(&http_lock);
+            break;
+        }
+        HTTPRequest *request = g_queue_pop_head(pending);
+        pthread_mutex_unlock(&http_lock);
+
+        _perform(request);
+
+        pthread_mutex_lock(&http_lock);
+        g_queue_push_tail(completed, request);
+        pthread_mutex_unlock(&http_lock);
+        wakeup_signal();
+    }
+
+    return NULL;
+}
+
+static void
+_perform(HTTPRequest *request)
+{
+    CURL *handle = curl_easy_init();
+    if (handle == NULL) {
+        request->failed = TRUE;
+        return;
+    }
+
+    curl_easy_setopt(handle, CURLOPT_URL, request->url);
+    curl_easy_setopt(handle, CURLOPT_WRITEFUNCTION, _data_callback);
+    curl_easy_setopt(handle, CURLOPT_WRITEDATA, (void *)request);
+    curl_easy_setopt(handle, CURLOPT_TIMEOUT, request->timeout);
+    curl_easy_setopt(handle, CURLOPT_NOSIGNAL, 1L);
+    curl_easy_setopt(handle, CURLOPT_NOPROGRESS, 0L);
+    curl_easy_setopt(handle, CURLOPT_PROGRESSFUNCTION, _progress_callback);
+
+    CURLcode res = curl_easy_perform(handle);
+    long status = 0;
+    curl_easy_getinfo(handle, CURLINFO_RESPONSE_CODE, &status);
+    curl_easy_cleanup(handle);
+
+    if (res != CURLE_OK || status >= 400 || request->body == NULL) {
+        log_debug("HTTP request for %s failed: %s, status %ld", request->url, curl_easy_strerror(res), status);
+        request->failed = TRUE;
+    }
+}
+
+static size_t
+_data_callback(void *ptr, size_t size, size_t nmemb, void *data)
+{
+    size_t realsize = size * nmemb;
+    HTTPRequest *request = (HTTPRequest *)data;
+    char *buffer = realloc(request->body, request->size + realsize + 1);
+    if (buffer == NULL) {
+        return 0;
+    }
+
+    request->body = buffer;
+    memcpy(&(request->body[request->size]), ptr, realsize);
+    request->size += realsize;
+    request->body[request->size] = '\0';
+
+    return realsize;
+}
+
+static int
+_progress_callback(void *data, double dltotal, double dlnow, double ultotal, double ulnow)
+{
+    pthread_mutex_lock(&http_lock);
+    gboolean abort = !running;
+    pthread_mutex_unlock(&http_lock);
+
+    return abort;
+}
+
+static void
+_request_free(HTTPRequest *request)
+{
+    if (request) {
+        if (request->free_userdata) {
+            request->free_userdata(request->userdata);
+        }
+        free(request->url);
+        free(request->body);
+        free(request);
+    }
+}
@@ -0,0 +1,268 @@
+/*
+ * perf.c
+ *
+ * Copyright (C) 2012 - 2015 James Booth <boothj5@gmail.com>
+ *
+ * This file is part of Profanity.
+ *
+ * Profanity is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Profanity is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Profanity.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * In addition, as a special exception, the copyright holders give permission to
+ * link the code of portions of this program with the OpenSSL library under
+ * certain conditions as described in each individual source file, and
+ * distribute linked combinations including the two.
+ *
+ * You must obey the GNU General Public License in all respects for all of the
+ * code used other than OpenSSL. If you modify file(s) with this exception, you
+ * may extend this exception to your version of the file(s), but you are not
+ * obligated to do so. If you do not wish to do so, delete this exception
+ * statement from your version. If you delete this exception statement from all
+ * source files in the program, then also delete it here.
+ *
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include <glib.h>
+
+#include "tools/perf.h"
+
+// exact below 16ns, then 8 buckets per power of two, so percentiles are within 12.5%
+#define PERF_EXACT 16
+#define PERF_SUB_BITS 3
+#define PERF_MAX_BITS 40
+#define PERF_BUCKETS (PERF_EXACT + (PERF_MAX_BITS - 4) * (1 << PERF_SUB_BITS))
+
+typedef struct perf_hist_t {
+    guint count;
+    gint64 total;
+    gint64 max;
+    guint buckets[PERF_BUCKETS];
+} PerfHist;
+
+static gboolean enabled = FALSE;
+static GHashTable *hists;
+
+static int _perf_bucket(gint64 value);
+static gint64 _perf_bucket_max(int bucket);
+static gint64 _perf_percentile(PerfHist *hist, int percent);
+static gint _perf_cmp_total(gconstpointer a, gconstpointer b);
+
+void
+perf_enable(gboolean enable)
+{
+    enabled = enable;
+}
+
+gboolean
+perf_enabled(void)
+{
+    return enabled;
+}
+
+gint64
+perf_start(void)
+{
+    if (!enabled) {
+        return 0;
+    }
+
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+
+    return (gint64)now.tv_sec * G_GINT64_CONSTANT(1000000000) + now.tv_nsec;
+}
+
+void
+perf_end(const char * const name, gint64 start)
+{
+    // disabled when started, or since
+    if (start == 0 || !enabled) {
+        return;
+    }
+
+    gint64 elapsed = perf_start() - start;
+    if (elapsed < 0) {
+        elapsed = 0;
+    }
+
+    if (!hists) {
+        hists = g_hash_table_new_full(g_str_hash, g_str_equal, free, free);
+    }
+    PerfHist *hist = g_hash_table_lookup(hists, name);
+    if (!hist) {
+        hist = calloc(1, sizeof(PerfHist));
+        g_hash_table_insert(hists, strdup(name), hist);
+    }
+
+    hist->count++;
+    hist->total += elapsed;
+    if (elapsed > hist->max) {
+        hist->max = elapsed;
+    }
+    hist->buckets[_perf_bucket(elapsed)]++;
+}
+
+void
+perf_reset(void)
+{
+    if (hists) {
+        g_hash_table_remove_all(hists);
+    }
+}
+
+GSList *
+perf_get_stats(void)
+{
+    GSList *stats = NULL;
+    if (!hists) {
+        return stats;
+    }
+
+    GHashTableIter iter;
+    gpointer key, value;
+    g_hash_table_iter_init(&iter, hists);
+    while (g_hash_table_iter_next(&iter, &key, &value)) {
+        PerfHist *hist = value;
+        PerfStat *stat = malloc(sizeof(PerfStat));
+        stat->name = strdup(key);
+        stat->count = hist->count;
+        stat->total = hist->total;
+        stat->p50 = _perf_percentile(hist, 50);
+        stat->p99 = _perf_percentile(hist, 99);
+        stat->max = hist->max;
+        stats = g_slist_insert_sorted(stats, stat, _perf_cmp_total);
+    }
+
+    return stats;
+}
+
+void
+perf_free_stats(GSList *stats)
+{
+    GSList *curr = stats;
+    while (curr) {
+        PerfStat *stat = curr->data;
+        free(stat->name);
+        free(stat);
+        curr = g_slist_next(curr);
+    }
+    g_slist_free(stats);
+}
+
+gboolean
+perf_dump(const char * const path)
+{
+    FILE *file = fopen(path, "w");
+    if (!file) {
+        return FALSE;
+    }
+
+    fprintf(file, "# name\tcount\ttotal_ns\tp50_ns\tp99_ns\tmax_ns\n");
+    GSList *stats = perf_get_stats();
+    GSList *curr = stats;
+    while (curr) {
+        PerfStat *stat = curr->data;
+        fprintf(file, "%s\t%u\t%" G_GINT64_FORMAT "\t%" G_GINT64_FORMAT "\t%" G_GINT64_FORMAT "\t%" G_GINT64_FORMAT "\n",
+            stat->name, stat->count, stat->total, stat->p50, stat->p99, stat->max);
+        curr = g_slist_next(curr);
+    }
+    perf_free_stats(stats);
+
+    gboolean result = !ferror(file);
+    if (fclose(file) != 0) {
+        result = FALSE;
+    }
+
+    return result;
+}
+
+void
+perf_close(void)
+{
+    enabled = FALSE;
+    if (hists) {
+        g_hash_table_destroy(hists);
+        hists = NULL;
+    }
+}
+
+static int
+_perf_bucket(gint64 value)
+{
+    if (value < PERF_EXACT) {
+        return value;
+    }
+
+    int msb = 63 - __builtin_clzll(value);
+    if (msb >= PERF_MAX_BITS) {
+        return PERF_BUCKETS - 1;
+    }
+    int sub = (value >> (msb - PERF_SUB_BITS)) & ((1 << PERF_SUB_BITS) - 1);
+
+    return PERF_EXACT + (msb - 4) * (1 << PERF_SUB_BITS) + sub;
+}
+
+static gint64
+_perf_bucket_max(int bucket)
+{
+    if (bucket < PERF_EXACT) {
+        return bucket;
+    }
+
+    int msb = (bucket - PERF_EXACT) / (1 << PERF_SUB_BITS) + 4;
+    int sub = (bucket - PERF_EXACT) % (1 << PERF_SUB_BITS);
+    gint64 width = G_GINT64_CONSTANT(1) << (msb - PERF_SUB_BITS);
+
+    return ((1 << PERF_SUB_BITS) + sub) * width + width - 1;
+}
+
+static gint64
+_perf_percentile(PerfHist *hist, int percent)
+{
+    // rank of the value at the percentile, rounded up
+    guint64 rank = ((guint64)hist->count * percent + 99) / 100;
+    if (rank == 0) {
+        rank = 1;
+    }
+
+    guint64 seen = 0;
+    int i;
+    for (i = 0; i < PERF_BUCKETS; i++) {
+        seen += hist->buckets[i];
+        if (seen >= rank) {
+            gint64 value = _perf_bucket_max(i);
+            return value < hist->max ? value : hist->max;
+        }
+    }
+
+    return hist->max;
+}
+
+static gint
+_perf_cmp_total(gconstpointer a, gconstpointer b)
+{
+    const PerfStat *stat_a = a;
+    const PerfStat *stat_b = b;
+    if (stat_a->total > stat_b->total) {
+        return -1;
+    } else if (stat_a->total < stat_b->total) {
+        return 1;
+    } else {
+        return g_strcmp0(stat_a->name, stat_b->name);
+    }
+}
@@ -0,0 +1,70 @@
+/*
+ * perf.h
+ *
+ * Copyright (C) 2012 - 2015 James Booth <boothj5@gmail.com>
+ *
+ * This file is part of Profanity.
+ *
+ * Profanity is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Profanity is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Profanity.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * In addition, as a special exception, the copyright holders give permission to
+ * link the code of portions of this program with the OpenSSL library under
+ * certain conditions as described in each individual source file, and
+ * distribute linked combinations including the two.
+ *
+ * You must obey the GNU General Public License in all respects for all of the
+ * code used other than OpenSSL. If you modify file(s) with this exception, you
+ * may extend this exception to your version of the file(s), but you are not
+ * obligated to do so. If you do not wish to do so, delete this exception
+ * statement from your version. If you delete this exception statement from all
+ * source files in the program, then also delete it here.
+ *
+ */
+
+#ifndef PERF_H
+#define PERF_H
+
+#include <glib.h>
+
+// latency summary for one instrumented name, times in nanoseconds
+typedef struct perf_stat_t {
+    char *name;
+    guint count;
+    gint64 total;
+    gint64 p50;
+    gint64 p99;
+    gint64 max;
+} PerfStat;
+
+void perf_enable(gboolean enable);
+gboolean perf_enabled(void);
+
+// returns 0 when disabled, pass the result to perf_end
+gint64 perf_start(void);
+
+// record the time since start against name, does nothing when start is 0
+void perf_end(const char * const name, gint64 start);
+
+void perf_reset(void);
+
+// summaries sorted by total time, most expensive first
+GSList * perf_get_stats(void);
+void perf_free_stats(GSList *stats);
+
+// write the summaries as tab separated lines
+gboolean perf_dump(const char * const path);
+
+void perf_close(void);
+
+#endif
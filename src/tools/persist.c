@@ -0,0 +1,177 @@
+/*
+ * persist.c
+ *
+ * Copyright (C) 2012 - 2015 James Booth <boothj5@gmail.com>
+ *
+ * This file is part of Profanity.
+ *
+ * Profanity is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Profanity is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Profanity.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * In addition, as a special exception, the copyright holders give permission to
+ * link the code of portions of this program with the OpenSSL library under
+ * certain conditions as described in each individual source file, and
+ * distribute linked combinations including the two.
+ *
+ * You must obey the GNU General Public License in all respects for all of the
+ * code used other than OpenSSL. If you modify file(s) with this exception, you
+ * may extend this exception to your version of the file(s), but you are not
+ * obligated to do so. If you do not wish to do so, delete this exception
+ * statement from your version. If you delete this exception statement from all
+ * source files in the program, then also delete it here.
+ *
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/stat.h>
+
+#include <glib.h>
+#include <glib/gstdio.h>
+
+#include "tools/persist.h"
+#include "log.h"
+
+struct persist_store_t {
+    char *name;
+    persist_write_func write_func;
+    gboolean dirty;
+    GTimer *dirty_timer;
+};
+
+static GSList *stores;
+
+static gboolean _write_all(int fd, const gchar * const data, gsize size);
+
+PersistStore
+persist_store_new(const char * const name, persist_write_func write_func)
+{
+    PersistStore store = malloc(sizeof(struct persist_store_t));
+    store->name = strdup(name);
+    store->write_func = write_func;
+    store->dirty = FALSE;
+    store->dirty_timer = g_timer_new();
+
+    stores = g_slist_append(stores, store);
+
+    return store;
+}
+
+void
+persist_store_free(PersistStore store)
+{
+    if (store) {
+        persist_store_flush(store);
+        stores = g_slist_remove(stores, store);
+        g_timer_destroy(store->dirty_timer);
+        free(store->name);
+        free(store);
+    }
+}
+
+void
+persist_store_changed(PersistStore store)
+{
+    if (store && !store->dirty) {
+        store->dirty = TRUE;
+        g_timer_start(store->dirty_timer);
+    }
+}
+
+void
+persist_store_flush(PersistStore store)
+{
+    if (store && store->dirty) {
+        // cleared first so a write_func that changes the store marks it again
+        store->dirty = FALSE;
+        log_debug("Writing %s", store->name);
+        store->write_func();
+    }
+}
+
+void
+persist_flush(void)
+{
+    GSList *curr = stores;
+    while (curr) {
+        PersistStore store = curr->data;
+        curr = g_slist_next(curr);
+        if (store->dirty && g_timer_elapsed(store->dirty_timer, NULL) >= PERSIST_DELAY_SECS) {
+            persist_store_flush(store);
+        }
+    }
+}
+
+void
+persist_flush_all(void)
+{
+    GSList *curr = stores;
+    while (curr) {
+        PersistStore store = curr->data;
+        curr = g_slist_next(curr);
+        persist_store_flush(store);
+    }
+}
+
+gboolean
+persist_write_file(const char * const path, const gchar * const data, gsize size)
+{
+    // the temporary file is created with the final permissions before any data is written
+    GString *tmp_path = g_string_new(path);
+    g_string_append(tmp_path, ".XXXXXX");
+    int fd = g_mkstemp_full(tmp_path->str, O_WRONLY, S_IRUSR | S_IWUSR);
+    if (fd == -1) {
+        log_error("Could not create temporary file for %s: %s", path, g_strerror(errno));
+        g_string_free(tmp_path, TRUE);
+        return FALSE;
+    }
+
+    gboolean written = _write_all(fd, data, size);
+    if (written && fsync(fd) != 0) {
+        written = FALSE;
+    }
+    if (close(fd) != 0) {
+        written = FALSE;
+    }
+
+    if (!written || g_rename(tmp_path->str, path) != 0) {
+        log_error("Could not write %s: %s", path, g_strerror(errno));
+        g_unlink(tmp_path->str);
+        g_string_free(tmp_path, TRUE);
+        return FALSE;
+    }
+
+    g_string_free(tmp_path, TRUE);
+    return TRUE;
+}
+
+static gboolean
+_write_all(int fd, const gchar * const data, gsize size)
+{
+    gsize offset = 0;
+    while (offset < size) {
+        ssize_t res = write(fd, data + offset, size - offset);
+        if (res == -1) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return FALSE;
+        }
+        offset += res;
+    }
+
+    return TRUE;
+}
@@ -0,0 +1,67 @@
+/*
+ * persist.h
+ *
+ * Copyright (C) 2012 - 2015 James Booth <boothj5@gmail.com>
+ *
+ * This file is part of Profanity.
+ *
+ * Profanity is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Profanity is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Profanity.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * In addition, as a special exception, the copyright holders give permission to
+ * link the code of portions of this program with the OpenSSL library under
+ * certain conditions as described in each individual source file, and
+ * distribute linked combinations including the two.
+ *
+ * You must obey the GNU General Public License in all respects for all of the
+ * code used other than OpenSSL. If you modify file(s) with this exception, you
+ * may extend this exception to your version of the file(s), but you are not
+ * obligated to do so. If you do not wish to do so, delete this exception
+ * statement from your version. If you delete this exception statement from all
+ * source files in the program, then also delete it here.
+ *
+ */
+
+#ifndef PERSIST_H
+#define PERSIST_H
+
+#include <glib.h>
+
+// how long a changed store may wait before it is written
+#define PERSIST_DELAY_SECS 2
+
+typedef void (*persist_write_func)(void);
+typedef struct persist_store_t *PersistStore;
+
+// register a store, write_func serialises it to disk
+PersistStore persist_store_new(const char * const name, persist_write_func write_func);
+
+// write any pending change and unregister the store
+void persist_store_free(PersistStore store);
+
+// mark the store as needing a write
+void persist_store_changed(PersistStore store);
+
+// write the store now if it has pending changes
+void persist_store_flush(PersistStore store);
+
+// write stores whose changes have waited PERSIST_DELAY_SECS, called from the main loop
+void persist_flush(void);
+
+// write every store with pending changes
+void persist_flush_all(void);
+
+// atomically replace path with data, the file is only readable by the user
+gboolean persist_write_file(const char * const path, const gchar * const data, gsize size);
+
+#endif
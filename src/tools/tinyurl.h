@@ -37,7 +37,10 @@
 
 #include <glib.h>
 
+#include "tools/http.h"
+
 gboolean tinyurl_valid(char *url);
-char * tinyurl_get(char *url);
+// the shortened url is passed to callback once the request completes
+void tinyurl_get(char *url, http_callback callback, void *userdata, GDestroyNotify free_userdata);
 
 #endif
@@ -0,0 +1,123 @@
+/*
+ * wakeup.c
+ *
+ * Copyright (C) 2012 - 2015 James Booth <boothj5@gmail.com>
+ *
+ * This file is part of Profanity.
+ *
+ * Profanity is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Profanity is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Profanity.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * In addition, as a special exception, the copyright holders give permission to
+ * link the code of portions of this program with the OpenSSL library under
+ * certain conditions as described in each individual source file, and
+ * distribute linked combinations including the two.
+ *
+ * You must obey the GNU General Public License in all respects for all of the
+ * code used other than OpenSSL. If you modify file(s) with this exception, you
+ * may extend this exception to your version of the file(s), but you are not
+ * obligated to do so. If you do not wish to do so, delete this exception
+ * statement from your version. If you delete this exception statement from all
+ * source files in the program, then also delete it here.
+ *
+ */
+
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <glib.h>
+
+#include "tools/wakeup.h"
+
+// opened before the worker threads start and closed after they stop
+static int wakeup_pipe[2] = { -1, -1 };
+
+static gboolean _set_nonblocking(int fd);
+
+void
+wakeup_init(void)
+{
+    if (wakeup_pipe[0] != -1) {
+        return;
+    }
+
+    int fds[2];
+    if (pipe(fds) != 0) {
+        return;
+    }
+    if (!_set_nonblocking(fds[0]) || !_set_nonblocking(fds[1])) {
+        close(fds[0]);
+        close(fds[1]);
+        return;
+    }
+
+    wakeup_pipe[0] = fds[0];
+    wakeup_pipe[1] = fds[1];
+}
+
+void
+wakeup_close(void)
+{
+    if (wakeup_pipe[0] == -1) {
+        return;
+    }
+
+    close(wakeup_pipe[0]);
+    close(wakeup_pipe[1]);
+    wakeup_pipe[0] = -1;
+    wakeup_pipe[1] = -1;
+}
+
+void
+wakeup_signal(void)
+{
+    if (wakeup_pipe[1] == -1) {
+        return;
+    }
+
+    // a full pipe already wakes the main loop
+    char byte = 1;
+    while (write(wakeup_pipe[1], &byte, 1) == -1 && errno == EINTR);
+}
+
+int
+wakeup_get_fd(void)
+{
+    return wakeup_pipe[0];
+}
+
+void
+wakeup_clear(void)
+{
+    if (wakeup_pipe[0] == -1) {
+        return;
+    }
+
+    char buf[64];
+    ssize_t size;
+    do {
+        size = read(wakeup_pipe[0], buf, sizeof(buf));
+    } while (size > 0 || (size == -1 && errno == EINTR));
+}
+
+static gboolean
+_set_nonblocking(int fd)
+{
+    int flags = fcntl(fd, F_GETFL);
+    if (flags == -1) {
+        return FALSE;
+    }
+
+    return fcntl(fd, F_SETFL, flags | O_NONBLOCK) == 0;
+}
@@ -49,71 +49,111 @@
 #include "ui/window.h"
 #include "ui/buffer.h"
 
-#define BUFF_SIZE 1200
-
 struct prof_buff_t {
-    GSList *entries;
+    ProfBuffEntry *entries[BUFF_SIZE];
+    int head;
+    int size;
+    int start;
 };
 
+static ProfBuffEntry * _create_entry(const char show_char, int pad_indent, GDateTime *time, int flags, theme_item_t theme_item,
+    const char * const from, const char * const message, DeliveryReceipt *receipt);
 static void _free_entry(ProfBuffEntry *entry);
+static void _free_layout(ProfBuffLayout *layout);
+static void _layout_advance(ProfBuffLayout *layout, int *x, int *line, int cols);
+static void _layout_newline(ProfBuffLayout *layout, int *x, int *line);
+static void _layout_indent(ProfBuffLayout *layout, int *x, int *line, int size);
+static void _layout_line_indent(ProfBuffLayout *layout, int *x, int *line, int pad_indent);
+static void _layout_text(ProfBuffLayout *layout, int *x, int *line, const char * const message,
+    const char *start, const char *end);
 
 ProfBuff
 buffer_create()
 {
     ProfBuff new_buff = malloc(sizeof(struct prof_buff_t));
-    new_buff->entries = NULL;
+    new_buff->head = 0;
+    new_buff->size = 0;
+    new_buff->start = 0;
     return new_buff;
 }
 
 int
 buffer_size(ProfBuff buffer)
 {
-    return g_slist_length(buffer->entries);
+    return buffer->size;
+}
+
+// position of the oldest entry counted from the first one ever pushed,
+// positions stay the same as entries are dropped or pushed in front
+int
+buffer_start(ProfBuff buffer)
+{
+    return buffer->start;
 }
 
 void
 buffer_free(ProfBuff buffer)
 {
-    g_slist_free_full(buffer->entries, (GDestroyNotify)_free_entry);
+    int i;
+    for (i = 0; i < buffer->size; i++) {
+        _free_entry(buffer->entries[(buffer->head + i) % BUFF_SIZE]);
+    }
     free(buffer);
     buffer = NULL;
 }
 
-void
+ProfBuffEntry*
 buffer_push(ProfBuff buffer, const char show_char, int pad_indent, GDateTime *time,
     int flags, theme_item_t theme_item, const char * const from, const char * const message, DeliveryReceipt *receipt)
 {
-    ProfBuffEntry *e = malloc(sizeof(struct prof_buff_entry_t));
-    e->show_char = show_char;
-    e->pad_indent = pad_indent;
-    e->flags = flags;
-    e->theme_item = theme_item;
-    e->time = g_date_time_ref(time);
-    e->from = strdup(from);
-    e->message = strdup(message);
-    e->receipt = receipt;
+    ProfBuffEntry *e = _create_entry(show_char, pad_indent, time, flags, theme_item, from, message, receipt);
 
-    if (g_slist_length(buffer->entries) == BUFF_SIZE) {
-        _free_entry(buffer->entries->data);
-        buffer->entries = g_slist_delete_link(buffer->entries, buffer->entries);
+    // full, overwrite the oldest entry and move the head along
+    if (buffer->size == BUFF_SIZE) {
+        _free_entry(buffer->entries[buffer->head]);
+        buffer->entries[buffer->head] = e;
+        buffer->head = (buffer->head + 1) % BUFF_SIZE;
+        buffer->start++;
+    } else {
+        buffer->entries[(buffer->head + buffer->size) % BUFF_SIZE] = e;
+        buffer->size++;
     }
 
-    buffer->entries = g_slist_append(buffer->entries, e);
+    return e;
+}
+
+gboolean
+buffer_push_front(ProfBuff buffer, const char show_char, int pad_indent, GDateTime *time,
+    int flags, theme_item_t theme_item, const char * const from, const char * const message)
+{
+    // older entries never push out newer ones
+    if (buffer->size == BUFF_SIZE) {
+        return FALSE;
+    }
+
+    ProfBuffEntry *e = _create_entry(show_char, pad_indent, time, flags, theme_item, from, message, NULL);
+    buffer->head = (buffer->head + BUFF_SIZE - 1) % BUFF_SIZE;
+    buffer->entries[buffer->head] = e;
+    buffer->size++;
+    buffer->start--;
+
+    return TRUE;
 }
 
 gboolean
 buffer_mark_received(ProfBuff buffer, const char * const id)
 {
-    GSList *entries = buffer->entries;
-    while (entries) {
-        ProfBuffEntry *entry = entries->data;
+    ProfBuffIter iter;
+    ProfBuffEntry *entry = NULL;
+
+    buffer_iter_init(&iter, buffer);
+    while (buffer_iter_next(&iter, &entry)) {
         if (entry->receipt && g_strcmp0(entry->receipt->id, id) == 0) {
             if (!entry->receipt->received) {
                 entry->receipt->received = TRUE;
                 return TRUE;
             }
         }
-        entries = g_slist_next(entries);
     }
 
     return FALSE;
@@ -122,8 +162,210 @@ buffer_mark_received(ProfBuff buffer, const char * const id)
 ProfBuffEntry*
 buffer_yield_entry(ProfBuff buffer, int entry)
 {
-    GSList *node = g_slist_nth(buffer->entries, entry);
-    return node->data;
+    assert(entry >= 0 && entry < buffer->size);
+    return buffer->entries[(buffer->head + entry) % BUFF_SIZE];
+}
+
+void
+buffer_iter_init(ProfBuffIter *iter, ProfBuff buffer)
+{
+    iter->buffer = buffer;
+    iter->pos = 0;
+}
+
+gboolean
+buffer_iter_next(ProfBuffIter *iter, ProfBuffEntry **entry)
+{
+    if (iter->pos >= iter->buffer->size) {
+        return FALSE;
+    }
+
+    *entry = iter->buffer->entries[(iter->buffer->head + iter->pos) % BUFF_SIZE];
+    iter->pos++;
+
+    return TRUE;
+}
+
+ProfBuffLayout*
+buffer_entry_layout(ProfBuffEntry *entry, int offset, int startx, int indent, int width)
+{
+    ProfBuffLayout *layout = entry->layout;
+    if (layout && layout->width == width && layout->startx == startx && layout->indent == indent &&
+            layout->offset == offset) {
+        return layout;
+    }
+
+    _free_layout(layout);
+    layout = malloc(sizeof(struct prof_buff_layout_t));
+    layout->width = width;
+    layout->startx = startx;
+    layout->indent = indent;
+    layout->offset = offset;
+    layout->segments = g_array_new(FALSE, TRUE, sizeof(ProfBuffSegment));
+    entry->layout = layout;
+
+    ProfBuffSegment first = { FALSE, 0, offset, 0 };
+    g_array_append_val(layout->segments, first);
+
+    // simulate the curses cursor, line 0 being the line the message starts on
+    int x = startx;
+    int line = 0;
+    const char *message = entry->message;
+    const char *curr = message + offset;
+    while (*curr != '\0') {
+
+        // handle space
+        if (*curr == ' ') {
+            _layout_text(layout, &x, &line, message, curr, curr + 1);
+            curr++;
+
+        // handle newline
+        } else if (*curr == '\n') {
+            _layout_newline(layout, &x, &line);
+            _layout_indent(layout, &x, &line, indent + entry->pad_indent);
+            curr++;
+
+        // handle word
+        } else {
+            const char *word = curr;
+            int wordlen = 0;
+            while (*curr != ' ' && *curr != '\n' && *curr != '\0') {
+                wordlen += g_unichar_iswide(g_utf8_get_char(curr)) ? 2 : 1;
+                curr = g_utf8_next_char(curr);
+            }
+
+            // wrap required
+            if (x + wordlen > width) {
+                int linelen = width - (indent + entry->pad_indent);
+
+                // word larger than line, break it anywhere
+                if (wordlen > linelen) {
+                    const char *word_ch = word;
+                    while (word_ch < curr) {
+                        const char *next = g_utf8_next_char(word_ch);
+                        _layout_line_indent(layout, &x, &line, entry->pad_indent);
+                        _layout_text(layout, &x, &line, message, word_ch, next);
+                        word_ch = next;
+                    }
+
+                // newline and print word
+                } else {
+                    _layout_newline(layout, &x, &line);
+                    _layout_line_indent(layout, &x, &line, entry->pad_indent);
+                    _layout_text(layout, &x, &line, message, word, curr);
+                }
+
+            // no wrap required
+            } else {
+                _layout_line_indent(layout, &x, &line, entry->pad_indent);
+                _layout_text(layout, &x, &line, message, word, curr);
+            }
+        }
+
+        // consume first space of next line
+        if (line > 0 && x == 0 && *curr == ' ') {
+            curr++;
+        }
+    }
+
+    return layout;
+}
+
+// curses moves a character that does not fit onto the next line, and wraps after the last column
+static void
+_layout_advance(ProfBuffLayout *layout, int *x, int *line, int cols)
+{
+    if (*x + cols > layout->width) {
+        *x = 0;
+        (*line)++;
+    }
+    *x += cols;
+    if (*x >= layout->width) {
+        *x = 0;
+        (*line)++;
+    }
+}
+
+static void
+_layout_newline(ProfBuffLayout *layout, int *x, int *line)
+{
+    ProfBuffSegment segment = { TRUE, 0, 0, 0 };
+    g_array_append_val(layout->segments, segment);
+    *x = 0;
+    (*line)++;
+}
+
+static void
+_layout_indent(ProfBuffLayout *layout, int *x, int *line, int size)
+{
+    ProfBuffSegment *last = &g_array_index(layout->segments, ProfBuffSegment, layout->segments->len - 1);
+    if (last->len == 0) {
+        last->indent += size;
+    } else {
+        ProfBuffSegment segment = { FALSE, size, 0, 0 };
+        g_array_append_val(layout->segments, segment);
+    }
+
+    int i;
+    for (i = 0; i < size; i++) {
+        _layout_advance(layout, x, line, 1);
+    }
+}
+
+static void
+_layout_line_indent(ProfBuffLayout *layout, int *x, int *line, int pad_indent)
+{
+    gboolean firstline = (*line == 0);
+
+    if (firstline && *x < layout->indent) {
+        _layout_indent(layout, x, line, layout->indent);
+    }
+    if (!firstline && *x < (layout->indent + pad_indent)) {
+        _layout_indent(layout, x, line, layout->indent + pad_indent);
+    }
+}
+
+static void
+_layout_text(ProfBuffLayout *layout, int *x, int *line, const char * const message,
+    const char *start, const char *end)
+{
+    int offset = start - message;
+    ProfBuffSegment *last = &g_array_index(layout->segments, ProfBuffSegment, layout->segments->len - 1);
+    if (last->len == 0) {
+        last->offset = offset;
+        last->len = end - start;
+    } else if (last->offset + last->len == offset) {
+        last->len += end - start;
+    } else {
+        ProfBuffSegment segment = { FALSE, 0, offset, end - start };
+        g_array_append_val(layout->segments, segment);
+    }
+
+    const char *curr = start;
+    while (curr < end) {
+        _layout_advance(layout, x, line, g_unichar_iswide(g_utf8_get_char(curr)) ? 2 : 1);
+        curr = g_utf8_next_char(curr);
+    }
+}
+
+static ProfBuffEntry *
+_create_entry(const char show_char, int pad_indent, GDateTime *time, int flags, theme_item_t theme_item,
+    const char * const from, const char * const message, DeliveryReceipt *receipt)
+{
+    ProfBuffEntry *e = malloc(sizeof(struct prof_buff_entry_t));
+    e->show_char = show_char;
+    e->pad_indent = pad_indent;
+    e->flags = flags;
+    e->theme_item = theme_item;
+    e->time = g_date_time_ref(time);
+    e->from = strdup(from);
+    e->message = strdup(message);
+    e->receipt = receipt;
+    e->layout = NULL;
+    e->rows = 0;
+    e->rows_cols = 0;
+
+    return e;
 }
 
 static void
@@ -136,5 +378,15 @@ _free_entry(ProfBuffEntry *entry)
         free(entry->receipt->id);
         free(entry->receipt);
     }
+    _free_layout(entry->layout);
     free(entry);
 }
+
+static void
+_free_layout(ProfBuffLayout *layout)
+{
+    if (layout) {
+        g_array_free(layout->segments, TRUE);
+        free(layout);
+    }
+}
@@ -40,11 +40,30 @@
 
 #include <glib.h>
 
+#define BUFF_SIZE 1200
+
 typedef struct delivery_receipt_t {
     char *id;
     gboolean received;
 } DeliveryReceipt;
 
+// a run of message text, printed after an optional newline and indent
+typedef struct prof_buff_segment_t {
+    gboolean newline;
+    int indent;
+    int offset;
+    int len;
+} ProfBuffSegment;
+
+// wrapped layout of a message, valid for the width and start column it was computed at
+typedef struct prof_buff_layout_t {
+    int width;
+    int startx;
+    int indent;
+    int offset;
+    GArray *segments;
+} ProfBuffLayout;
+
 typedef struct prof_buff_entry_t {
     char show_char;
     int pad_indent;
@@ -54,17 +73,32 @@ typedef struct prof_buff_entry_t {
     char *from;
     char *message;
     DeliveryReceipt *receipt;
+    ProfBuffLayout *layout;
+    // rows taken by the line starting at this entry, valid when drawn at rows_cols columns
+    int rows;
+    int rows_cols;
 } ProfBuffEntry;
 
 typedef struct prof_buff_t *ProfBuff;
 
+typedef struct prof_buff_iter_t {
+    ProfBuff buffer;
+    int pos;
+} ProfBuffIter;
+
 ProfBuff buffer_create();
 void buffer_free(ProfBuff buffer);
-void buffer_push(ProfBuff buffer, const char show_char, int pad_indent, GDateTime *time, int flags, theme_item_t theme_item,
+ProfBuffEntry* buffer_push(ProfBuff buffer, const char show_char, int pad_indent, GDateTime *time, int flags, theme_item_t theme_item,
     const char * const from, const char * const message, DeliveryReceipt *receipt);
+gboolean buffer_push_front(ProfBuff buffer, const char show_char, int pad_indent, GDateTime *time, int flags, theme_item_t theme_item,
+    const char * const from, const char * const message);
 int buffer_size(ProfBuff buffer);
+int buffer_start(ProfBuff buffer);
 ProfBuffEntry* buffer_yield_entry(ProfBuff buffer, int entry);
 gboolean buffer_mark_received(ProfBuff buffer, const char * const id);
+void buffer_iter_init(ProfBuffIter *iter, ProfBuff buffer);
+gboolean buffer_iter_next(ProfBuffIter *iter, ProfBuffEntry **entry);
+ProfBuffLayout* buffer_entry_layout(ProfBuffEntry *entry, int offset, int startx, int indent, int width);
 
 
 #endif
@@ -55,12 +55,17 @@
 #include "ui/statusbar.h"
 #include "xmpp/xmpp.h"
 #include "xmpp/bookmark.h"
+#include "tools/http.h"
 
 #ifdef HAVE_GIT_VERSION
 #include "gitversion.h"
 #endif
 
+#define RELEASE_VERSION_URL "http://www.profanity.im/profanity_version.txt"
+#define RELEASE_CHECK_TIMEOUT 10
+
 static void _cons_splash_logo(void);
+static void _cons_version_checked(const char * const latest_release, void *userdata);
 void _show_roster_contacts(GSList *list, gboolean show_groups);
 
 void
@@ -226,8 +231,6 @@ void
 cons_about(void)
 {
     ProfWin *console = wins_get_console();
-    int rows, cols;
-    getmaxyx(stdscr, rows, cols);
 
     if (prefs_get_boolean(PREF_SPLASH)) {
         _cons_splash_logo();
@@ -257,7 +260,7 @@ cons_about(void)
         cons_check_version(FALSE);
     }
 
-    pnoutrefresh(console->layout->win, 0, 0, 1, 0, rows-3, cols-1);
+    win_update_virtual(console);
 
     cons_alert();
 }
@@ -265,8 +268,16 @@ cons_about(void)
 void
 cons_check_version(gboolean not_available_msg)
 {
+    // the result is shown when it arrives, startup does not wait for it
+    http_get(RELEASE_VERSION_URL, RELEASE_CHECK_TIMEOUT, _cons_version_checked,
+        GINT_TO_POINTER(not_available_msg), NULL);
+}
+
+static void
+_cons_version_checked(const char * const latest_release, void *userdata)
+{
+    gboolean not_available_msg = GPOINTER_TO_INT(userdata);
     ProfWin *console = wins_get_console();
-    char *latest_release = release_get_latest();
 
     if (latest_release) {
         gboolean relase_valid = g_regex_match_simple("^\\d+\\.\\d+\\.\\d+$", latest_release, 0, 0);
@@ -285,7 +296,6 @@ cons_check_version(gboolean not_available_msg)
 
             cons_alert();
         }
-        free(latest_release);
     }
 }
 
@@ -870,13 +880,12 @@ cons_show_aliases(GList *aliases)
 void
 cons_theme_setting(void)
 {
-    char *theme = prefs_get_string(PREF_THEME);
+    const char *theme = prefs_get_string(PREF_THEME);
     if (theme == NULL) {
         cons_show("Theme (/theme)                : default");
     } else {
         cons_show("Theme (/theme)                : %s", theme);
     }
-    prefs_free_string(theme);
 }
 
 void
@@ -985,31 +994,27 @@ cons_occupants_setting(void)
 void
 cons_autoconnect_setting(void)
 {
-    char *pref_connect_account = prefs_get_string(PREF_CONNECT_ACCOUNT);
+    const char *pref_connect_account = prefs_get_string(PREF_CONNECT_ACCOUNT);
     if (pref_connect_account)
         cons_show("Autoconnect (/autoconnect)      : %s", pref_connect_account);
     else
         cons_show("Autoconnect (/autoconnect)      : OFF");
-
-    prefs_free_string(pref_connect_account);
 }
 
 void
 cons_time_setting(void)
 {
-    char *pref_time = prefs_get_string(PREF_TIME);
+    const char *pref_time = prefs_get_string(PREF_TIME);
     if (g_strcmp0(pref_time, "off") == 0)
         cons_show("Time main (/time)             : OFF");
     else
         cons_show("Time main (/time)             : %s", pref_time);
-    prefs_free_string(pref_time);
 
-    char *pref_time_statusbar = prefs_get_string(PREF_TIME_STATUSBAR);
+    const char *pref_time_statusbar = prefs_get_string(PREF_TIME_STATUSBAR);
     if (g_strcmp0(pref_time_statusbar, "off") == 0)
         cons_show("Time statusbar (/time)        : OFF");
     else
         cons_show("Time statusbar (/time)        : %s", pref_time_statusbar);
-    prefs_free_string(pref_time_statusbar);
 }
 
 void
@@ -1024,17 +1029,13 @@ cons_vercheck_setting(void)
 void
 cons_statuses_setting(void)
 {
-    char *console = prefs_get_string(PREF_STATUSES_CONSOLE);
-    char *chat = prefs_get_string(PREF_STATUSES_CHAT);
-    char *muc = prefs_get_string(PREF_STATUSES_MUC);
+    const char *console = prefs_get_string(PREF_STATUSES_CONSOLE);
+    const char *chat = prefs_get_string(PREF_STATUSES_CHAT);
+    const char *muc = prefs_get_string(PREF_STATUSES_MUC);
 
     cons_show("Console statuses (/statuses)  : %s", console);
     cons_show("Chat statuses (/statuses)     : %s", chat);
     cons_show("MUC statuses (/statuses)      : %s", muc);
-
-    prefs_free_string(console);
-    prefs_free_string(chat);
-    prefs_free_string(muc);
 }
 
 void
@@ -1075,9 +1076,8 @@ cons_roster_setting(void)
     else
         cons_show("Roster empty (/roster)        : hide");
 
-    char *by = prefs_get_string(PREF_ROSTER_BY);
+    const char *by = prefs_get_string(PREF_ROSTER_BY);
     cons_show("Roster by (/roster)           : %s", by);
-    prefs_free_string(by);
 
     int size = prefs_get_roster_size();
     cons_show("Roster size (/roster)         : %d", size);
@@ -1139,7 +1139,7 @@ cons_notify_setting(void)
         else
             cons_show("Messages text (/notify message)     : OFF");
 
-        char *room_setting = prefs_get_string(PREF_NOTIFY_ROOM);
+        const char *room_setting = prefs_get_string(PREF_NOTIFY_ROOM);
         if (g_strcmp0(room_setting, "on") == 0) {
         cons_show    ("Room messages (/notify room)        : ON");
         } else if (g_strcmp0(room_setting, "off") == 0) {
@@ -1147,7 +1147,6 @@ cons_notify_setting(void)
         } else {
         cons_show    ("Room messages (/notify room)        : %s", room_setting);
         }
-        prefs_free_string(room_setting);
 
         if (prefs_get_boolean(PREF_NOTIFY_ROOM_CURRENT))
             cons_show("Room current (/notify room)         : ON");
@@ -1249,6 +1248,7 @@ cons_history_setting(void)
         cons_show("Chat history (/history)       : ON");
     else
         cons_show("Chat history (/history)       : OFF");
+    cons_show("History lines (/history lines): %d", prefs_get_history_lines());
 }
 
 void
@@ -1317,6 +1317,13 @@ cons_log_setting(void)
         cons_show("Shared log (/log shared)    : ON");
     else
         cons_show("Shared log (/log shared)    : OFF");
+
+    if (prefs_get_boolean(PREF_LOG_ASYNC))
+        cons_show("Async log (/log async)      : ON");
+    else
+        cons_show("Async log (/log async)      : OFF");
+
+    cons_show("Log queue size (/log queue) : %d lines", prefs_get_log_queue_size());
 }
 
 void
@@ -1352,24 +1359,22 @@ cons_show_log_prefs(void)
 void
 cons_autoaway_setting(void)
 {
-    char *pref_autoaway_mode = prefs_get_string(PREF_AUTOAWAY_MODE);
+    const char *pref_autoaway_mode = prefs_get_string(PREF_AUTOAWAY_MODE);
     if (strcmp(pref_autoaway_mode, "off") == 0) {
         cons_show("Autoaway (/autoaway mode)            : OFF");
     } else {
         cons_show("Autoaway (/autoaway mode)            : %s", pref_autoaway_mode);
     }
-    prefs_free_string(pref_autoaway_mode);
 
     cons_show("Autoaway minutes (/autoaway time)    : %d minutes", prefs_get_autoaway_time());
 
-    char *pref_autoaway_message = prefs_get_string(PREF_AUTOAWAY_MESSAGE);
+    const char *pref_autoaway_message = prefs_get_string(PREF_AUTOAWAY_MESSAGE);
     if ((pref_autoaway_message == NULL) ||
             (strcmp(pref_autoaway_message, "") == 0)) {
         cons_show("Autoaway message (/autoaway message) : OFF");
     } else {
         cons_show("Autoaway message (/autoaway message) : \"%s\"", pref_autoaway_message);
     }
-    prefs_free_string(pref_autoaway_message);
 
     if (prefs_get_boolean(PREF_AUTOAWAY_CHECK)) {
         cons_show("Autoaway check (/autoaway check)     : ON");
@@ -1439,11 +1444,10 @@ cons_show_otr_prefs(void)
     cons_show("OTR preferences:");
     cons_show("");
 
-    char *policy_value = prefs_get_string(PREF_OTR_POLICY);
+    const char *policy_value = prefs_get_string(PREF_OTR_POLICY);
     cons_show("OTR policy (/otr policy) : %s", policy_value);
-    prefs_free_string(policy_value);
 
-    char *log_value = prefs_get_string(PREF_OTR_LOG);
+    const char *log_value = prefs_get_string(PREF_OTR_LOG);
     if (strcmp(log_value, "on") == 0) {
         cons_show("OTR logging (/otr log)   : ON");
     } else if (strcmp(log_value, "off") == 0) {
@@ -1451,7 +1455,6 @@ cons_show_otr_prefs(void)
     } else {
         cons_show("OTR logging (/otr log)   : Redacted");
     }
-    prefs_free_string(log_value);
 
     char ch = prefs_get_otr_char();
     cons_show("OTR char (/otr char)     : %c", ch);
@@ -1465,7 +1468,7 @@ cons_show_pgp_prefs(void)
     cons_show("PGP preferences:");
     cons_show("");
 
-    char *log_value = prefs_get_string(PREF_PGP_LOG);
+    const char *log_value = prefs_get_string(PREF_PGP_LOG);
     if (strcmp(log_value, "on") == 0) {
         cons_show("PGP logging (/pgp log)   : ON");
     } else if (strcmp(log_value, "off") == 0) {
@@ -1473,7 +1476,6 @@ cons_show_pgp_prefs(void)
     } else {
         cons_show("PGP logging (/pgp log)   : Redacted");
     }
-    prefs_free_string(log_value);
 
     char ch = prefs_get_pgp_char();
     cons_show("PGP char (/pgp char)     : %c", ch);
@@ -42,6 +42,7 @@
 #include <string.h>
 #include <assert.h>
 #include <sys/ioctl.h>
+#include <time.h>
 #include <unistd.h>
 
 #ifdef HAVE_LIBXSS
@@ -63,7 +64,10 @@
 #include "roster_list.h"
 #include "jid.h"
 #include "log.h"
+#include "log_index.h"
+#include "log_history.h"
 #include "muc.h"
+#include "tools/perf.h"
 #ifdef HAVE_LIBOTR
 #include "otr/otr.h"
 #endif
@@ -76,8 +80,18 @@
 #include "xmpp/xmpp.h"
 #include "event/ui_events.h"
 
+// minimum time between frames when only incoming events are pending
+#define UI_FRAME_INTERVAL_MS 33
+
 static char *win_title;
 
+static int dirty = UI_DIRTY_ALL;
+static GTimer *frame_timer;
+static time_t frame_tick;
+static ProfWin *frame_win;
+static WINDOW *frame_subwin;
+static int frame_sub_y_pos;
+
 static int inp_size;
 
 static gboolean perform_resize = FALSE;
@@ -90,7 +104,10 @@ static GTimer *ui_idle_time;
 
 //static void _win_handle_switch(const wint_t ch);
 static void _win_show_history(ProfChatWin *chatwin, const char * const contact);
+static void _win_show_older_history(ProfChatWin *chatwin);
 static void _ui_draw_term_title(void);
+static void _ui_check_dirty(ProfWin *current);
+static void _ui_render(ProfWin *current);
 
 void
 ui_init(void)
@@ -114,6 +131,7 @@ ui_init(void)
     display = XOpenDisplay(0);
 #endif
     ui_idle_time = g_timer_new();
+    frame_timer = g_timer_new();
     inp_size = 0;
     ProfWin *window = wins_get_current();
     win_update_virtual(window);
@@ -133,24 +151,48 @@ ui_update(void)
         win_move_to_end(current);
     }
 
-    win_update_virtual(current);
+    // presence floods only redraw the roster and occupants once per frame
+    rosterwin_roster_flush();
+    occupantswin_occupants_flush();
 
-    if (prefs_get_boolean(PREF_TITLEBAR_SHOW)) {
-        _ui_draw_term_title();
+    _ui_check_dirty(current);
+
+    // keystrokes are drawn straight away, incoming events at most once per frame interval
+    if (dirty && ((dirty & UI_DIRTY_INPUT) || ui_frame_timeout(UI_FRAME_INTERVAL_MS) == 0)) {
+        _ui_render(current);
     }
-    title_bar_update_virtual();
-    status_bar_update_virtual();
-    inp_put_back();
-    doupdate();
 
     if (perform_resize) {
         signal(SIGWINCH, SIG_IGN);
         ui_resize();
         perform_resize = FALSE;
         signal(SIGWINCH, ui_sigwinch_handler);
+        ui_mark_dirty(UI_DIRTY_ALL);
     }
 }
 
+void
+ui_mark_dirty(int surfaces)
+{
+    dirty |= surfaces;
+}
+
+gint
+ui_frame_timeout(gint timeout)
+{
+    if (!dirty || !frame_timer) {
+        return timeout;
+    }
+
+    gint elapsed = g_timer_elapsed(frame_timer, NULL) * 1000;
+    gint remaining = UI_FRAME_INTERVAL_MS - elapsed;
+    if (remaining <= 0) {
+        return 0;
+    }
+
+    return remaining < timeout ? remaining : timeout;
+}
+
 void
 ui_about(void)
 {
@@ -191,6 +233,7 @@ ui_close(void)
 {
     notifier_uninit();
     wins_destroy();
+    win_close();
     inp_close();
     endwin();
 }
@@ -205,6 +248,9 @@ void
 ui_page_up(void)
 {
     ProfWin *current = wins_get_current();
+    if (current->type == WIN_CHAT && win_at_top(current)) {
+        _win_show_older_history((ProfChatWin*)current);
+    }
     win_page_up(current);
 }
 
@@ -318,14 +364,12 @@ ui_chat_win_exists(const char * const barejid)
 void
 ui_contact_online(char *barejid, Resource *resource, GDateTime *last_activity)
 {
-    char *show_console = prefs_get_string(PREF_STATUSES_CONSOLE);
-    char *show_chat_win = prefs_get_string(PREF_STATUSES_CHAT);
+    const char *show_console = prefs_get_string(PREF_STATUSES_CONSOLE);
+    const char *show_chat_win = prefs_get_string(PREF_STATUSES_CHAT);
     PContact contact = roster_get_contact(barejid);
 
     // show nothing
     if (g_strcmp0(p_contact_subscription(contact), "none") == 0) {
-        free(show_console);
-        free(show_chat_win);
         return;
     }
 
@@ -346,9 +390,6 @@ ui_contact_online(char *barejid, Resource *resource, GDateTime *last_activity)
     } else if (g_strcmp0(show_chat_win, "online") == 0 && resource->presence == RESOURCE_ONLINE) {
         ui_chat_win_contact_online(contact, resource, last_activity);
     }
-
-    free(show_console);
-    free(show_chat_win);
 }
 
 void
@@ -554,7 +595,7 @@ ui_group_removed(const char * const contact, const char * const group)
 void
 ui_auto_away(void)
 {
-    char *pref_autoaway_message = prefs_get_string(PREF_AUTOAWAY_MESSAGE);
+    const char *pref_autoaway_message = prefs_get_string(PREF_AUTOAWAY_MESSAGE);
     if (pref_autoaway_message) {
         int pri =
             accounts_get_priority_for_presence_type(jabber_get_account_name(),
@@ -570,7 +611,6 @@ ui_auto_away(void)
             prefs_get_autoaway_time(), pri);
         title_bar_set_presence(CONTACT_AWAY);
     }
-    prefs_free_string(pref_autoaway_message);
 }
 
 void
@@ -1263,6 +1303,77 @@ ui_open_xmlconsole_win(void)
     }
 }
 
+void
+ui_show_search_results(const char * const query, GSList *results, double elapsed, gboolean partial)
+{
+    ProfWin *window = (ProfWin*)wins_get_single(WIN_SEARCH);
+    if (!window) {
+        window = wins_new_single(WIN_SEARCH);
+    }
+
+    win_vprint(window, '-', 0, NULL, 0, 0, "", "%d results for \"%s\" (%.0f ms):",
+        g_slist_length(results), query, elapsed * 1000);
+    if (partial) {
+        win_print(window, '-', 0, NULL, 0, 0, "", "The logs are still being indexed, older messages may be missing.");
+    }
+
+    GSList *curr = results;
+    while (curr) {
+        LogSearchResult *result = curr->data;
+        const char *message = result->line;
+        int hh = 0, mm = 0, ss = 0;
+        if (strlen(message) >= 11 && message[2] == ':') {
+            sscanf(message, "%2d:%2d:%2d", &hh, &mm, &ss);
+            message += 11;
+        }
+        int year = 0, month = 0, day = 0;
+        sscanf(result->date, "%4d_%2d_%2d", &year, &month, &day);
+        GDateTime *timestamp = g_date_time_new_local(year, month, day, hh, mm, ss);
+
+        win_vprint(window, '-', 0, timestamp, NO_COLOUR_DATE, 0, "", "%d/%d/%d %s: %s",
+            day, month, year, result->contact, message);
+
+        if (timestamp) {
+            g_date_time_unref(timestamp);
+        }
+        curr = g_slist_next(curr);
+    }
+    win_print(window, '-', 0, NULL, 0, 0, "", "");
+
+    ui_ev_focus_win(window);
+}
+
+void
+ui_show_perf(GSList *stats)
+{
+    ProfWin *window = (ProfWin*)wins_get_single(WIN_PERF);
+    if (!window) {
+        window = wins_new_single(WIN_PERF);
+    }
+
+    // each view replaces the last
+    win_clear(window);
+
+    if (perf_enabled()) {
+        win_print(window, '-', 0, NULL, 0, 0, "", "Profiling is on, times in microseconds:");
+    } else {
+        win_print(window, '-', 0, NULL, 0, 0, "", "Profiling is off, use '/perf on' to start, times in microseconds:");
+    }
+    win_vprint(window, '-', 0, NULL, 0, 0, "", "%-45s %8s %12s %10s %10s %10s",
+        "name", "count", "total", "p50", "p99", "max");
+
+    GSList *curr = stats;
+    while (curr) {
+        PerfStat *stat = curr->data;
+        win_vprint(window, '-', 0, NULL, 0, 0, "", "%-45s %8u %12.1f %10.1f %10.1f %10.1f",
+            stat->name, stat->count, stat->total / 1000.0, stat->p50 / 1000.0, stat->p99 / 1000.0, stat->max / 1000.0);
+        curr = g_slist_next(curr);
+    }
+    win_print(window, '-', 0, NULL, 0, 0, "", "");
+
+    ui_ev_focus_win(window);
+}
+
 ProfChatWin*
 ui_new_chat_win(const char * const barejid)
 {
@@ -1752,7 +1863,7 @@ ui_room_message(const char * const roomjid, const char * const nick,
     }
 
     gboolean notify = FALSE;
-    char *room_setting = prefs_get_string(PREF_NOTIFY_ROOM);
+    const char *room_setting = prefs_get_string(PREF_NOTIFY_ROOM);
     if (g_strcmp0(room_setting, "on") == 0) {
         notify = TRUE;
     }
@@ -1765,7 +1876,6 @@ ui_room_message(const char * const roomjid, const char * const nick,
         g_free(message_lower);
         g_free(nick_lower);
     }
-    prefs_free_string(room_setting);
 
     if (notify) {
         gboolean is_current = wins_is_current(window);
@@ -2141,8 +2251,8 @@ ui_chat_win_contact_offline(PContact contact, char *resource, char *status)
 void
 ui_contact_offline(char *barejid, char *resource, char *status)
 {
-    char *show_console = prefs_get_string(PREF_STATUSES_CONSOLE);
-    char *show_chat_win = prefs_get_string(PREF_STATUSES_CHAT);
+    const char *show_console = prefs_get_string(PREF_STATUSES_CONSOLE);
+    const char *show_chat_win = prefs_get_string(PREF_STATUSES_CHAT);
     Jid *jid = jid_create_from_bare_and_resource(barejid, resource);
     PContact contact = roster_get_contact(barejid);
     if (p_contact_subscription(contact)) {
@@ -2173,8 +2283,6 @@ ui_contact_offline(char *barejid, char *resource, char *status)
         FREE_SET_NULL(chatwin->resource_override);
     }
 
-    prefs_free_string(show_console);
-    prefs_free_string(show_chat_win);
     jid_destroy(jid);
 }
 
@@ -2182,6 +2290,7 @@ void
 ui_clear_win_title(void)
 {
     printf("%c]0;%c", '\033', '\007');
+    fflush(stdout);
 }
 
 void
@@ -2193,8 +2302,8 @@ ui_clear_win(ProfWin *window)
 void
 ui_goodbye_title(void)
 {
-    int result = system("/bin/echo -ne \"\033]0;Thanks for using Profanity\007\"");
-    if(result == -1) log_error("Error printing title on shutdown");
+    printf("%c]0;%s%c", '\033', "Thanks for using Profanity", '\007');
+    fflush(stdout);
 }
 
 void
@@ -2203,6 +2312,77 @@ ui_statusbar_new(const int win)
     status_bar_new(win);
 }
 
+static void
+_ui_check_dirty(ProfWin *current)
+{
+    if (current != frame_win) {
+        dirty |= UI_DIRTY_ALL;
+    }
+
+    // printing, paging and redrawing mark the layout, so new content is found without hooking every printer
+    if (current->layout->touched) {
+        dirty |= UI_DIRTY_MAIN | UI_DIRTY_TITLEBAR;
+    }
+
+    WINDOW *subwin = NULL;
+    if (current->layout->type == LAYOUT_SPLIT) {
+        ProfLayoutSplit *layout = (ProfLayoutSplit*)current->layout;
+        subwin = layout->subwin;
+        if (subwin && (is_wintouched(subwin) || layout->sub_y_pos != frame_sub_y_pos)) {
+            dirty |= UI_DIRTY_SUBWIN;
+        }
+    }
+    if (subwin != frame_subwin) {
+        dirty |= UI_DIRTY_MAIN | UI_DIRTY_SUBWIN;
+    }
+
+    // the statusbar clock, title bar typing timeout and unread count in the terminal title
+    time_t now = time(NULL);
+    if (now != frame_tick) {
+        dirty |= UI_DIRTY_TITLEBAR | UI_DIRTY_STATUSBAR | UI_DIRTY_TERM_TITLE;
+    }
+}
+
+static void
+_ui_render(ProfWin *current)
+{
+    gint64 perf = perf_start();
+
+    if (dirty & (UI_DIRTY_MAIN | UI_DIRTY_SUBWIN)) {
+        gint64 perf_win = perf_start();
+        win_update_virtual(current);
+        perf_end("win_update_virtual", perf_win);
+    }
+    if ((dirty & UI_DIRTY_TERM_TITLE) && prefs_get_boolean(PREF_TITLEBAR_SHOW)) {
+        _ui_draw_term_title();
+    }
+    if (dirty & UI_DIRTY_TITLEBAR) {
+        title_bar_update_virtual();
+    }
+    if (dirty & UI_DIRTY_STATUSBAR) {
+        status_bar_update_virtual();
+    }
+    inp_put_back();
+    gint64 perf_doupdate = perf_start();
+    doupdate();
+    perf_end("doupdate", perf_doupdate);
+
+    frame_win = current;
+    current->layout->touched = FALSE;
+    frame_subwin = NULL;
+    frame_sub_y_pos = 0;
+    if (current->layout->type == LAYOUT_SPLIT) {
+        ProfLayoutSplit *layout = (ProfLayoutSplit*)current->layout;
+        frame_subwin = layout->subwin;
+        frame_sub_y_pos = layout->sub_y_pos;
+    }
+    frame_tick = time(NULL);
+    g_timer_start(frame_timer);
+    dirty = 0;
+
+    perf_end("ui_render", perf);
+}
+
 static void
 _ui_draw_term_title(void)
 {
@@ -2214,24 +2394,17 @@ _ui_draw_term_title(void)
         gint unread = ui_unread();
 
         if (unread != 0) {
-            snprintf(new_win_title, sizeof(new_win_title),
-                "/bin/echo -n \"%c]0;%s (%d) - %s%c\"", '\033', "Profanity",
-                unread, jid, '\007');
+            snprintf(new_win_title, sizeof(new_win_title), "%s (%d) - %s", "Profanity", unread, jid);
         } else {
-            snprintf(new_win_title, sizeof(new_win_title),
-                "/bin/echo -n \"%c]0;%s - %s%c\"", '\033', "Profanity", jid,
-                '\007');
+            snprintf(new_win_title, sizeof(new_win_title), "%s - %s", "Profanity", jid);
         }
     } else {
-        snprintf(new_win_title, sizeof(new_win_title), "/bin/echo -n \"%c]0;%s%c\"", '\033',
-            "Profanity", '\007');
+        snprintf(new_win_title, sizeof(new_win_title), "%s", "Profanity");
     }
     if (g_strcmp0(win_title, new_win_title) != 0) {
         // print to x-window title bar
-        int res = system(new_win_title);
-        if (res == -1) {
-            log_error("Error writing terminal window title.");
-        }
+        printf("%c]0;%s%c", '\033', new_win_title, '\007');
+        fflush(stdout);
         if (win_title) {
             free(win_title);
         }
@@ -2870,27 +3043,39 @@ ui_show_software_version(const char * const jid, const char * const  presence,
     }
 }
 
+static GDateTime *
+_win_history_timestamp(const char * const line)
+{
+    // entries start with HH:MM:SS, anything else is a date header
+    if (strlen(line) < 11 || line[2] != ':') {
+        return NULL;
+    }
+
+    int hh = (line[0] - '0') * 10 + (line[1] - '0');
+    int mm = (line[3] - '0') * 10 + (line[4] - '0');
+    int ss = (line[6] - '0') * 10 + (line[7] - '0');
+
+    return g_date_time_new_local(2000, 1, 1, hh, mm, ss);
+}
+
 static void
 _win_show_history(ProfChatWin *chatwin, const char * const contact)
 {
     if (!chatwin->history_shown) {
         Jid *jid = jid_create(jabber_get_fulljid());
-        GSList *history = chat_log_get_previous(jid->barejid, contact);
+        chatwin->history = chat_log_history_open(jid->barejid, contact);
         jid_destroy(jid);
+
+        GSList *history = chat_log_history_older(chatwin->history, prefs_get_history_lines());
         GSList *curr = history;
         while (curr) {
             char *line = curr->data;
-            // entry
-            if (line[2] == ':') {
-                char hh[3]; memcpy(hh, &line[0], 2); hh[2] = '\0'; int ihh = atoi(hh);
-                char mm[3]; memcpy(mm, &line[3], 2); mm[2] = '\0'; int imm = atoi(mm);
-                char ss[3]; memcpy(ss, &line[6], 2); ss[2] = '\0'; int iss = atoi(ss);
-                GDateTime *timestamp = g_date_time_new_local(2000, 1, 1, ihh, imm, iss);
-                win_print((ProfWin*)chatwin, '-', 0, timestamp, NO_COLOUR_DATE, 0, "", curr->data+11);
+            GDateTime *timestamp = _win_history_timestamp(line);
+            if (timestamp) {
+                win_print((ProfWin*)chatwin, '-', 0, timestamp, NO_COLOUR_DATE, 0, "", line+11);
                 g_date_time_unref(timestamp);
-            // header
             } else {
-                win_print((ProfWin*)chatwin, '-', 0, NULL, 0, 0, "", curr->data);
+                win_print((ProfWin*)chatwin, '-', 0, NULL, 0, 0, "", line);
             }
             curr = g_slist_next(curr);
         }
@@ -2900,3 +3085,51 @@ _win_show_history(ProfChatWin *chatwin, const char * const contact)
     }
 }
 
+static void
+_win_show_older_history(ProfChatWin *chatwin)
+{
+    if (!chatwin->history) {
+        return;
+    }
+
+    GSList *history = chat_log_history_older(chatwin->history, prefs_get_history_lines());
+    if (!history) {
+        chat_log_history_close(chatwin->history);
+        chatwin->history = NULL;
+        return;
+    }
+
+    // newest first, each line goes in front of the one before it
+    ProfWin *window = (ProfWin*)chatwin;
+    int top = buffer_start(window->layout->buffer);
+    history = g_slist_reverse(history);
+    GSList *curr = history;
+    while (curr) {
+        char *line = curr->data;
+        GDateTime *timestamp = _win_history_timestamp(line);
+        gboolean added = FALSE;
+        if (timestamp) {
+            added = buffer_push_front(window->layout->buffer, '-', 0, timestamp, NO_COLOUR_DATE, 0, "", line+11);
+        } else {
+            timestamp = g_date_time_new_now_local();
+            added = buffer_push_front(window->layout->buffer, '-', 0, timestamp, 0, 0, "", line);
+        }
+        g_date_time_unref(timestamp);
+
+        // the buffer is full, nothing older can be shown
+        if (!added) {
+            chat_log_history_close(chatwin->history);
+            chatwin->history = NULL;
+            break;
+        }
+        curr = g_slist_next(curr);
+    }
+    g_slist_free_full(history, free);
+
+    // keep the same lines in view, the page up then moves into the new ones
+    window->layout->paged = 1;
+    window->layout->top = top;
+    window->layout->top_row = 0;
+    window->layout->touched = TRUE;
+}
+
@@ -39,6 +39,7 @@
 #include <string.h>
 #include <wchar.h>
 #include <sys/time.h>
+#include <poll.h>
 #include <errno.h>
 
 #include <readline/readline.h>
@@ -66,16 +67,15 @@
 #include "window_list.h"
 #include "event/ui_events.h"
 #include "xmpp/xmpp.h"
+#include "tools/wakeup.h"
 
 static WINDOW *inp_win;
 static int pad_start = 0;
 
-static struct timeval p_rl_timeout;
-/* Timeout in ms. Shows how long select() may block. */
+/* Timeout in ms. Shows how long poll() may block. */
 static gint inp_timeout = 0;
 static gint no_input_count = 0;
 
-static fd_set fds;
 static int r;
 static char *inp_line = NULL;
 static gboolean get_password = FALSE;
@@ -134,12 +134,42 @@ inp_readline(void)
 {
     free(inp_line);
     inp_line = NULL;
-    p_rl_timeout.tv_sec = inp_timeout / 1000;
-    p_rl_timeout.tv_usec = inp_timeout % 1000 * 1000;
-    FD_ZERO(&fds);
-    FD_SET(fileno(rl_instream), &fds);
+
+    // wait on the terminal, the xmpp socket when known so incoming stanzas wake us immediately,
+    // and the wakeup pipe so finished worker jobs are handled without waiting for the timeout
+    struct pollfd fds[3];
+    int nfds = 1;
+    fds[0].fd = fileno(rl_instream);
+    fds[0].events = POLLIN;
+    fds[0].revents = 0;
+    int timeout = ui_frame_timeout(inp_timeout);
+    int xmpp_sock = jabber_get_socket();
+    if (xmpp_sock != -1) {
+        fds[1].fd = xmpp_sock;
+        fds[1].events = POLLIN;
+        if (jabber_has_pending_output()) {
+            fds[1].events |= POLLOUT;
+        }
+        fds[1].revents = 0;
+        nfds = 2;
+
+        // stanzas already read from the socket would not wake the poll
+        if (jabber_has_pending_input()) {
+            timeout = 0;
+        }
+    }
+    int wakeup_idx = -1;
+    int wakeup_fd = wakeup_get_fd();
+    if (wakeup_fd != -1) {
+        wakeup_idx = nfds;
+        fds[nfds].fd = wakeup_fd;
+        fds[nfds].events = POLLIN;
+        fds[nfds].revents = 0;
+        nfds++;
+    }
+
     errno = 0;
-    r = select(FD_SETSIZE, &fds, NULL, NULL, &p_rl_timeout);
+    r = poll(fds, nfds, timeout);
     if (r < 0) {
         if (errno != EINTR) {
             char *err_msg = strerror(errno);
@@ -148,7 +178,12 @@ inp_readline(void)
         return NULL;
     }
 
-    if (FD_ISSET(fileno(rl_instream), &fds)) {
+    // results are collected by the main loop, only the pipe needs emptying here
+    if (wakeup_idx != -1 && fds[wakeup_idx].revents) {
+        wakeup_clear();
+    }
+
+    if (fds[0].revents) {
         rl_callback_read_char();
 
         if (rl_line_buffer &&
@@ -196,6 +231,12 @@ inp_win_resize(void)
 void
 inp_nonblocking(gboolean reset)
 {
+    // xmpp socket is polled with the terminal, no need to wake early to process events
+    if (jabber_get_socket() != -1) {
+        inp_timeout = prefs_get_inpblock();
+        return;
+    }
+
     if (! prefs_get_boolean(PREF_INPBLOCK_DYNAMIC)) {
         inp_timeout = prefs_get_inpblock();
         return;
@@ -256,6 +297,7 @@ inp_win_clear(void)
     wmove(inp_win, 0, 0);
     pad_start = 0;
     _inp_win_update_virtual();
+    ui_mark_dirty(UI_DIRTY_INPUT);
 }
 
 static void
@@ -276,6 +318,7 @@ _inp_write(char *line, int offset)
     _inp_win_handle_scroll();
 
     _inp_win_update_virtual();
+    ui_mark_dirty(UI_DIRTY_INPUT);
 }
 
 static int
@@ -33,12 +33,25 @@
  */
 
 #include <assert.h>
+#include <stdlib.h>
+#include <string.h>
 
 #include "ui/ui.h"
 #include "ui/window.h"
 #include "window_list.h"
 #include "config/preferences.h"
 
+// rooms whose occupants changed since last drawn
+static GHashTable *dirty_rooms = NULL;
+
+static gboolean
+_occupantswin_full(ProfLayoutSplit *layout)
+{
+    // last line has been written to, anything further is off screen
+    int maxy = getmaxy(layout->subwin);
+    return (getcury(layout->subwin) >= maxy - 1) && (getcurx(layout->subwin) > 0);
+}
+
 static void
 _occuptantswin_occupant(ProfLayoutSplit *layout, Occupant *occupant, gboolean showjid)
 {
@@ -61,67 +74,84 @@ _occuptantswin_occupant(ProfLayoutSplit *layout, Occupant *occupant, gboolean sh
     wattroff(layout->subwin, theme_attrs(presence_colour));
 }
 
+static void
+_occupantswin_role(ProfLayoutSplit *layout, ProfMucWin *mucwin, muc_role_t role, char *title)
+{
+    if (_occupantswin_full(layout)) {
+        return;
+    }
+
+    wattron(layout->subwin, theme_attrs(THEME_OCCUPANTS_HEADER));
+    win_printline_nowrap(layout->subwin, title);
+    wattroff(layout->subwin, theme_attrs(THEME_OCCUPANTS_HEADER));
+
+    GSList *occupants = muc_occupants_by_role(mucwin->roomjid, role);
+    GSList *curr = occupants;
+    while (curr && !_occupantswin_full(layout)) {
+        _occuptantswin_occupant(layout, curr->data, mucwin->showjid);
+        curr = g_slist_next(curr);
+    }
+    g_slist_free(occupants);
+}
+
+void
+occupantswin_occupants_changed(const char * const roomjid)
+{
+    if (!dirty_rooms) {
+        dirty_rooms = g_hash_table_new_full(g_str_hash, g_str_equal, free, NULL);
+    }
+    if (!g_hash_table_lookup_extended(dirty_rooms, roomjid, NULL, NULL)) {
+        g_hash_table_insert(dirty_rooms, strdup(roomjid), NULL);
+    }
+}
+
+void
+occupantswin_occupants_flush(void)
+{
+    if (!dirty_rooms || g_hash_table_size(dirty_rooms) == 0) {
+        return;
+    }
+
+    GList *rooms = g_hash_table_get_keys(dirty_rooms);
+    GList *curr = rooms;
+    while (curr) {
+        ProfWin *window = (ProfWin*)wins_get_muc(curr->data);
+        if (window && win_has_active_subwin(window)) {
+            occupantswin_occupants(curr->data);
+        }
+        curr = g_list_next(curr);
+    }
+    g_list_free(rooms);
+
+    g_hash_table_remove_all(dirty_rooms);
+}
+
 void
 occupantswin_occupants(const char * const roomjid)
 {
     ProfMucWin *mucwin = wins_get_muc(roomjid);
     if (mucwin) {
-        GList *occupants = muc_roster(roomjid);
-        if (occupants) {
-            ProfLayoutSplit *layout = (ProfLayoutSplit*)mucwin->window.layout;
-            assert(layout->memcheck == LAYOUT_SPLIT_MEMCHECK);
-
-            werase(layout->subwin);
-
-            if (prefs_get_boolean(PREF_MUC_PRIVILEGES)) {
-                wattron(layout->subwin, theme_attrs(THEME_OCCUPANTS_HEADER));
-                win_printline_nowrap(layout->subwin, " -Moderators");
-                wattroff(layout->subwin, theme_attrs(THEME_OCCUPANTS_HEADER));
-                GList *roster_curr = occupants;
-                while (roster_curr) {
-                    Occupant *occupant = roster_curr->data;
-                    if (occupant->role == MUC_ROLE_MODERATOR) {
-                        _occuptantswin_occupant(layout, occupant, mucwin->showjid);
-                    }
-                    roster_curr = g_list_next(roster_curr);
-                }
-
-                wattron(layout->subwin, theme_attrs(THEME_OCCUPANTS_HEADER));
-                win_printline_nowrap(layout->subwin, " -Participants");
-                wattroff(layout->subwin, theme_attrs(THEME_OCCUPANTS_HEADER));
-                roster_curr = occupants;
-                while (roster_curr) {
-                    Occupant *occupant = roster_curr->data;
-                    if (occupant->role == MUC_ROLE_PARTICIPANT) {
-                        _occuptantswin_occupant(layout, occupant, mucwin->showjid);
-                    }
-                    roster_curr = g_list_next(roster_curr);
-                }
-
-                wattron(layout->subwin, theme_attrs(THEME_OCCUPANTS_HEADER));
-                win_printline_nowrap(layout->subwin, " -Visitors");
-                wattroff(layout->subwin, theme_attrs(THEME_OCCUPANTS_HEADER));
-                roster_curr = occupants;
-                while (roster_curr) {
-                    Occupant *occupant = roster_curr->data;
-                    if (occupant->role == MUC_ROLE_VISITOR) {
-                        _occuptantswin_occupant(layout, occupant, mucwin->showjid);
-                    }
-                    roster_curr = g_list_next(roster_curr);
-                }
-            } else {
-                wattron(layout->subwin, theme_attrs(THEME_OCCUPANTS_HEADER));
-                win_printline_nowrap(layout->subwin, " -Occupants\n");
-                wattroff(layout->subwin, theme_attrs(THEME_OCCUPANTS_HEADER));
-                GList *roster_curr = occupants;
-                while (roster_curr) {
-                    Occupant *occupant = roster_curr->data;
-                    _occuptantswin_occupant(layout, occupant, mucwin->showjid);
-                    roster_curr = g_list_next(roster_curr);
-                }
+        ProfLayoutSplit *layout = (ProfLayoutSplit*)mucwin->window.layout;
+        assert(layout->memcheck == LAYOUT_SPLIT_MEMCHECK);
+
+        werase(layout->subwin);
+
+        if (prefs_get_boolean(PREF_MUC_PRIVILEGES)) {
+            _occupantswin_role(layout, mucwin, MUC_ROLE_MODERATOR, " -Moderators");
+            _occupantswin_role(layout, mucwin, MUC_ROLE_PARTICIPANT, " -Participants");
+            _occupantswin_role(layout, mucwin, MUC_ROLE_VISITOR, " -Visitors");
+        } else {
+            wattron(layout->subwin, theme_attrs(THEME_OCCUPANTS_HEADER));
+            win_printline_nowrap(layout->subwin, " -Occupants\n");
+            wattroff(layout->subwin, theme_attrs(THEME_OCCUPANTS_HEADER));
+
+            GList *occupants = muc_roster(roomjid);
+            GList *curr = occupants;
+            while (curr && !_occupantswin_full(layout)) {
+                _occuptantswin_occupant(layout, curr->data, mucwin->showjid);
+                curr = g_list_next(curr);
             }
+            g_list_free(occupants);
         }
-
-        g_list_free(occupants);
     }
 }
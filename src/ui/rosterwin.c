@@ -42,6 +42,17 @@
 #include "config/preferences.h"
 #include "roster_list.h"
 
+// roster changed since last drawn
+static gboolean roster_dirty = FALSE;
+
+static gboolean
+_rosterwin_full(ProfLayoutSplit *layout)
+{
+    // last line has been written to, anything further is off screen
+    int maxy = getmaxy(layout->subwin);
+    return (getcury(layout->subwin) >= maxy - 1) && (getcurx(layout->subwin) > 0);
+}
+
 static void
 _rosterwin_contact(ProfLayoutSplit *layout, PContact contact)
 {
@@ -84,6 +95,10 @@ _rosterwin_contact(ProfLayoutSplit *layout, PContact contact)
 static void
 _rosterwin_contacts_by_presence(ProfLayoutSplit *layout, const char * const presence, char *title)
 {
+    if (_rosterwin_full(layout)) {
+        return;
+    }
+
     GSList *contacts = roster_get_contacts_by_presence(presence);
 
     // if this group has contacts, or if we want to show empty groups
@@ -95,7 +110,7 @@ _rosterwin_contacts_by_presence(ProfLayoutSplit *layout, const char * const pres
 
     if (contacts) {
         GSList *curr_contact = contacts;
-        while (curr_contact) {
+        while (curr_contact && !_rosterwin_full(layout)) {
             PContact contact = curr_contact->data;
             _rosterwin_contact(layout, contact);
             curr_contact = g_slist_next(curr_contact);
@@ -107,6 +122,10 @@ _rosterwin_contacts_by_presence(ProfLayoutSplit *layout, const char * const pres
 static void
 _rosterwin_contacts_by_group(ProfLayoutSplit *layout, char *group)
 {
+    if (_rosterwin_full(layout)) {
+        return;
+    }
+
     wattron(layout->subwin, theme_attrs(THEME_ROSTER_HEADER));
     GString *title = g_string_new(" -");
     g_string_append(title, group);
@@ -117,7 +136,7 @@ _rosterwin_contacts_by_group(ProfLayoutSplit *layout, char *group)
     GSList *contacts = roster_get_group(group);
     if (contacts) {
         GSList *curr_contact = contacts;
-        while (curr_contact) {
+        while (curr_contact && !_rosterwin_full(layout)) {
             PContact contact = curr_contact->data;
             _rosterwin_contact(layout, contact);
             curr_contact = g_slist_next(curr_contact);
@@ -129,6 +148,10 @@ _rosterwin_contacts_by_group(ProfLayoutSplit *layout, char *group)
 static void
 _rosterwin_contacts_by_no_group(ProfLayoutSplit *layout)
 {
+    if (_rosterwin_full(layout)) {
+        return;
+    }
+
     GSList *contacts = roster_get_nogroup();
     if (contacts) {
         wattron(layout->subwin, theme_attrs(THEME_ROSTER_HEADER));
@@ -136,7 +159,7 @@ _rosterwin_contacts_by_no_group(ProfLayoutSplit *layout)
         wattroff(layout->subwin, theme_attrs(THEME_ROSTER_HEADER));
 
         GSList *curr_contact = contacts;
-        while (curr_contact) {
+        while (curr_contact && !_rosterwin_full(layout)) {
             PContact contact = curr_contact->data;
             _rosterwin_contact(layout, contact);
             curr_contact = g_slist_next(curr_contact);
@@ -145,15 +168,31 @@ _rosterwin_contacts_by_no_group(ProfLayoutSplit *layout)
     g_slist_free(contacts);
 }
 
+void
+rosterwin_roster_changed(void)
+{
+    roster_dirty = TRUE;
+}
+
+void
+rosterwin_roster_flush(void)
+{
+    if (roster_dirty) {
+        rosterwin_roster();
+    }
+}
+
 void
 rosterwin_roster(void)
 {
+    roster_dirty = FALSE;
+
     ProfWin *console = wins_get_console();
     if (console) {
         ProfLayoutSplit *layout = (ProfLayoutSplit*)console->layout;
         assert(layout->memcheck == LAYOUT_SPLIT_MEMCHECK);
 
-       char *by = prefs_get_string(PREF_ROSTER_BY);
+        const char *by = prefs_get_string(PREF_ROSTER_BY);
         if (g_strcmp0(by, "presence") == 0) {
             werase(layout->subwin);
             _rosterwin_contacts_by_presence(layout, "chat", " -Available for chat");
@@ -184,7 +223,7 @@ rosterwin_roster(void)
                 wattroff(layout->subwin, theme_attrs(THEME_ROSTER_HEADER));
 
                 GSList *curr_contact = contacts;
-                while (curr_contact) {
+                while (curr_contact && !_rosterwin_full(layout)) {
                     PContact contact = curr_contact->data;
                     _rosterwin_contact(layout, contact);
                     curr_contact = g_slist_next(curr_contact);
@@ -192,6 +231,5 @@ rosterwin_roster(void)
             }
             g_slist_free(contacts);
         }
-        free(by);
     }
 }
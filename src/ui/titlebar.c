@@ -183,6 +183,7 @@ _title_bar_draw(void)
 
     wnoutrefresh(win);
     inp_put_back();
+    ui_mark_dirty(UI_DIRTY_TITLEBAR);
 }
 
 static void
@@ -45,10 +45,21 @@
 #define NO_COLOUR_FROM  8
 #define NO_COLOUR_DATE  16
 
+// surfaces redrawn by ui_update
+#define UI_DIRTY_MAIN       1
+#define UI_DIRTY_SUBWIN     2
+#define UI_DIRTY_TITLEBAR   4
+#define UI_DIRTY_STATUSBAR  8
+#define UI_DIRTY_INPUT      16
+#define UI_DIRTY_TERM_TITLE 32
+#define UI_DIRTY_ALL        63
+
 // ui startup and control
 void ui_init(void);
 void ui_load_colours(void);
 void ui_update(void);
+void ui_mark_dirty(int surfaces);
+gint ui_frame_timeout(gint timeout);
 void ui_close(void);
 void ui_redraw(void);
 void ui_resize(void);
@@ -237,6 +248,9 @@ void ui_create_xmlconsole_win(void);
 gboolean ui_xmlconsole_exists(void);
 void ui_open_xmlconsole_win(void);
 
+void ui_show_search_results(const char * const query, GSList *results, double elapsed, gboolean partial);
+void ui_show_perf(GSList *stats);
+
 gboolean ui_win_has_unsaved_form(int num);
 
 void ui_inp_history_append(char *inp);
@@ -336,13 +350,18 @@ void status_bar_set_all_inactive(void);
 
 // roster window
 void rosterwin_roster(void);
+void rosterwin_roster_changed(void);
+void rosterwin_roster_flush(void);
 
 // occupants window
 void occupantswin_occupants(const char * const room);
+void occupantswin_occupants_changed(const char * const room);
+void occupantswin_occupants_flush(void);
 
 // window interface
 ProfWin* win_create_console(void);
 ProfWin* win_create_xmlconsole(void);
+ProfWin* win_create_single(win_type_t type);
 ProfWin* win_create_chat(const char * const barejid);
 ProfWin* win_create_muc(const char * const roomjid);
 ProfWin* win_create_muc_config(const char * const title, DataForm *form);
@@ -350,6 +369,7 @@ ProfWin* win_create_private(const char * const fulljid);
 
 void win_update_virtual(ProfWin *window);
 void win_free(ProfWin *window);
+void win_close(void);
 int win_unread(ProfWin *window);
 void win_resize(ProfWin *window);
 void win_hide_subwin(ProfWin *window);
@@ -48,6 +48,7 @@
 #include "xmpp/xmpp.h"
 #include "ui/buffer.h"
 #include "chat_state.h"
+#include "log_history.h"
 
 #define LAYOUT_SPLIT_MEMCHECK       12345671
 #define PROFCHATWIN_MEMCHECK        22374522
@@ -55,6 +56,7 @@
 #define PROFPRIVATEWIN_MEMCHECK     77437483
 #define PROFCONFWIN_MEMCHECK        64334685
 #define PROFXMLWIN_MEMCHECK         87333463
+#define PROFSINGLEWIN_MEMCHECK      38450127
 
 typedef enum {
     LAYOUT_SIMPLE,
@@ -63,10 +65,14 @@ typedef enum {
 
 typedef struct prof_layout_t {
     layout_type_t type;
-    WINDOW *win;
     ProfBuff buffer;
-    int y_pos;
     int paged;
+    // when paged, buffer position of the line at the top of the view and rows of it scrolled past
+    int top;
+    int top_row;
+    // buffer position of the first entry shown after a clear
+    int cleared;
+    gboolean touched;
 } ProfLayout;
 
 typedef struct prof_layout_simple_t {
@@ -86,7 +92,9 @@ typedef enum {
     WIN_MUC,
     WIN_MUC_CONFIG,
     WIN_PRIVATE,
-    WIN_XML
+    WIN_XML,
+    WIN_SEARCH,
+    WIN_PERF
 } win_type_t;
 
 typedef enum {
@@ -113,6 +121,7 @@ typedef struct prof_chat_win_t {
     gboolean otr_is_trusted;
     char *resource_override;
     gboolean history_shown;
+    ChatLogHistory *history;
     unsigned long memcheck;
 } ProfChatWin;
 
@@ -143,4 +152,10 @@ typedef struct prof_xml_win_t {
     unsigned long memcheck;
 } ProfXMLWin;
 
+// a window with no state of its own, at most one of each type is open
+typedef struct prof_single_win_t {
+    ProfWin window;
+    unsigned long memcheck;
+} ProfSingleWin;
+
 #endif
@@ -56,12 +56,35 @@
 
 #define CONS_WIN_TITLE "Profanity. Type /help for help information."
 #define XML_WIN_TITLE "XML Console"
+#define SEARCH_WIN_TITLE "Search"
+#define PERF_WIN_TITLE "Perf"
 
 #define CEILING(X) (X-(int)(X) > 0 ? (int)(X+1) : (int)(X))
 
-static void _win_print(ProfWin *window, const char show_char, int pad_indent, GDateTime *time,
-    int flags, theme_item_t theme_item, const char * const from, const char * const message, DeliveryReceipt *receipt);
-static void _win_print_wrapped(WINDOW *win, const char * const message, size_t indent, int pad_indent);
+#define RENDER_PAD_ROWS 100
+
+// only the current window is on screen, its visible rows are drawn into the view
+static WINDOW *view = NULL;
+// each line is rendered here before its visible rows are copied to the view
+static WINDOW *render_pad = NULL;
+
+static void _win_print(WINDOW *win, ProfBuffEntry *entry);
+static void _win_print_wrapped(WINDOW *win, ProfBuffEntry *entry, int offset, size_t indent);
+static void _win_line_changed(ProfWin *window);
+static void _win_draw_view(ProfWin *window);
+static void _win_view_top(ProfWin *window, int cols, int rows, int *pos, int *row);
+static void _win_view_end(ProfWin *window, int cols, int rows, int *pos, int *row);
+static void _win_cursor(ProfWin *window, int cols, int *pos, int *row);
+static void _win_scroll_up(ProfWin *window, int cols, int *pos, int *row, int n);
+static void _win_scroll_down(ProfWin *window, int cols, int *pos, int *row, int n);
+static int _win_view_cols(ProfWin *window);
+static int _win_line_rows(ProfWin *window, int pos, int cols);
+static int _win_line_render(ProfWin *window, int pos, int cols);
+static int _win_line_start(ProfWin *window, int pos);
+static int _win_line_next(ProfWin *window, int pos);
+static int _win_first(ProfWin *window);
+static int _win_end(ProfWin *window);
+static ProfBuffEntry* _win_entry(ProfWin *window, int pos);
 
 int
 win_roster_cols(void)
@@ -82,16 +105,14 @@ win_occpuants_cols(void)
 static ProfLayout*
 _win_create_simple_layout(void)
 {
-    int cols = getmaxx(stdscr);
-
     ProfLayoutSimple *layout = malloc(sizeof(ProfLayoutSimple));
     layout->base.type = LAYOUT_SIMPLE;
-    layout->base.win = newpad(PAD_SIZE, cols);
-    wbkgd(layout->base.win, theme_attrs(THEME_TEXT));
     layout->base.buffer = buffer_create();
-    layout->base.y_pos = 0;
     layout->base.paged = 0;
-    scrollok(layout->base.win, TRUE);
+    layout->base.top = 0;
+    layout->base.top_row = 0;
+    layout->base.cleared = 0;
+    layout->base.touched = TRUE;
 
     return &layout->base;
 }
@@ -99,16 +120,14 @@ _win_create_simple_layout(void)
 static ProfLayout*
 _win_create_split_layout(void)
 {
-    int cols = getmaxx(stdscr);
-
     ProfLayoutSplit *layout = malloc(sizeof(ProfLayoutSplit));
     layout->base.type = LAYOUT_SPLIT;
-    layout->base.win = newpad(PAD_SIZE, cols);
-    wbkgd(layout->base.win, theme_attrs(THEME_TEXT));
     layout->base.buffer = buffer_create();
-    layout->base.y_pos = 0;
     layout->base.paged = 0;
-    scrollok(layout->base.win, TRUE);
+    layout->base.top = 0;
+    layout->base.top_row = 0;
+    layout->base.cleared = 0;
+    layout->base.touched = TRUE;
     layout->subwin = NULL;
     layout->sub_y_pos = 0;
     layout->memcheck = LAYOUT_SPLIT_MEMCHECK;
@@ -138,6 +157,7 @@ win_create_chat(const char * const barejid)
     new_win->enc_mode = PROF_ENC_NONE;
     new_win->otr_is_trusted = FALSE;
     new_win->history_shown = FALSE;
+    new_win->history = NULL;
     new_win->unread = 0;
     new_win->state = chat_state_new();
 
@@ -150,7 +170,6 @@ ProfWin*
 win_create_muc(const char * const roomjid)
 {
     ProfMucWin *new_win = malloc(sizeof(ProfMucWin));
-    int cols = getmaxx(stdscr);
 
     new_win->window.type = WIN_MUC;
 
@@ -159,21 +178,19 @@ win_create_muc(const char * const roomjid)
 
     if (prefs_get_boolean(PREF_OCCUPANTS)) {
         int subwin_cols = win_occpuants_cols();
-        layout->base.win = newpad(PAD_SIZE, cols - subwin_cols);
-        wbkgd(layout->base.win, theme_attrs(THEME_TEXT));
         layout->subwin = newpad(PAD_SIZE, subwin_cols);;
         wbkgd(layout->subwin, theme_attrs(THEME_TEXT));
     } else {
-        layout->base.win = newpad(PAD_SIZE, (cols));
-        wbkgd(layout->base.win, theme_attrs(THEME_TEXT));
         layout->subwin = NULL;
     }
     layout->sub_y_pos = 0;
     layout->memcheck = LAYOUT_SPLIT_MEMCHECK;
     layout->base.buffer = buffer_create();
-    layout->base.y_pos = 0;
     layout->base.paged = 0;
-    scrollok(layout->base.win, TRUE);
+    layout->base.top = 0;
+    layout->base.top_row = 0;
+    layout->base.cleared = 0;
+    layout->base.touched = TRUE;
     new_win->window.layout = (ProfLayout*)layout;
 
     new_win->roomjid = strdup(roomjid);
@@ -231,6 +248,18 @@ win_create_xmlconsole(void)
     return &new_win->window;
 }
 
+ProfWin*
+win_create_single(win_type_t type)
+{
+    ProfSingleWin *new_win = malloc(sizeof(ProfSingleWin));
+    new_win->window.type = type;
+    new_win->window.layout = _win_create_simple_layout();
+
+    new_win->memcheck = PROFSINGLEWIN_MEMCHECK;
+
+    return &new_win->window;
+}
+
 char *
 win_get_title(ProfWin *window)
 {
@@ -276,6 +305,12 @@ win_get_title(ProfWin *window)
     if (window->type == WIN_XML) {
         return strdup(XML_WIN_TITLE);
     }
+    if (window->type == WIN_SEARCH) {
+        return strdup(SEARCH_WIN_TITLE);
+    }
+    if (window->type == WIN_PERF) {
+        return strdup(PERF_WIN_TITLE);
+    }
 
     return NULL;
 }
@@ -290,20 +325,13 @@ win_hide_subwin(ProfWin *window)
         }
         layout->subwin = NULL;
         layout->sub_y_pos = 0;
-        int cols = getmaxx(stdscr);
-        wresize(layout->base.win, PAD_SIZE, cols);
-        win_redraw(window);
-    } else {
-        int cols = getmaxx(stdscr);
-        wresize(window->layout->win, PAD_SIZE, cols);
-        win_redraw(window);
     }
+    win_redraw(window);
 }
 
 void
 win_show_subwin(ProfWin *window)
 {
-    int cols = getmaxx(stdscr);
     int subwin_cols = 0;
 
     if (window->layout->type != LAYOUT_SPLIT) {
@@ -319,7 +347,6 @@ win_show_subwin(ProfWin *window)
     ProfLayoutSplit *layout = (ProfLayoutSplit*)window->layout;
     layout->subwin = newpad(PAD_SIZE, subwin_cols);
     wbkgd(layout->subwin, theme_attrs(THEME_TEXT));
-    wresize(layout->base.win, PAD_SIZE, cols - subwin_cols);
     win_redraw(window);
 }
 
@@ -332,10 +359,8 @@ win_free(ProfWin* window)
             delwin(layout->subwin);
         }
         buffer_free(layout->base.buffer);
-        delwin(layout->base.win);
     } else {
         buffer_free(window->layout->buffer);
-        delwin(window->layout->win);
     }
     free(window->layout);
 
@@ -344,6 +369,7 @@ win_free(ProfWin* window)
         free(chatwin->barejid);
         free(chatwin->resource_override);
         chat_state_free(chatwin->state);
+        chat_log_history_close(chatwin->history);
     }
 
     if (window->type == WIN_MUC) {
@@ -369,50 +395,56 @@ void
 win_page_up(ProfWin *window)
 {
     int rows = getmaxy(stdscr);
-    int y = getcury(window->layout->win);
     int page_space = rows - 4;
-    int *page_start = &(window->layout->y_pos);
+    int cols = _win_view_cols(window);
+    ProfLayout *layout = window->layout;
 
-    *page_start -= page_space;
+    _win_view_top(window, cols, rows - 3, &layout->top, &layout->top_row);
+    _win_scroll_up(window, cols, &layout->top, &layout->top_row, page_space);
 
-    // went past beginning, show first page
-    if (*page_start < 0)
-        *page_start = 0;
-
-    window->layout->paged = 1;
+    // switch off page if everything fits on one page
+    int end_pos, end_row;
+    _win_view_end(window, cols, rows - 3, &end_pos, &end_row);
+    layout->paged = (layout->top != end_pos || layout->top_row != end_row);
+    layout->touched = TRUE;
     win_update_virtual(window);
-
-    // switch off page if last line and space line visible
-    if ((y) - *page_start == page_space) {
-        window->layout->paged = 0;
-    }
 }
 
 void
 win_page_down(ProfWin *window)
 {
+    if (!window->layout->paged) {
+        return;
+    }
+
     int rows = getmaxy(stdscr);
-    int y = getcury(window->layout->win);
     int page_space = rows - 4;
-    int *page_start = &(window->layout->y_pos);
+    int cols = _win_view_cols(window);
+    ProfLayout *layout = window->layout;
 
-    *page_start += page_space;
+    _win_view_top(window, cols, rows - 3, &layout->top, &layout->top_row);
+    _win_scroll_down(window, cols, &layout->top, &layout->top_row, page_space);
 
-    // only got half a screen, show full screen
-    if ((y - (*page_start)) < page_space)
-        *page_start = y - page_space;
+    // switch off page when the last page is reached
+    int end_pos, end_row;
+    _win_view_end(window, cols, rows - 3, &end_pos, &end_row);
+    layout->paged = (layout->top < end_pos || (layout->top == end_pos && layout->top_row < end_row));
+    layout->touched = TRUE;
+    win_update_virtual(window);
+}
 
-    // went past end, show full screen
-    else if (*page_start >= y)
-        *page_start = y - page_space - 1;
+gboolean
+win_at_top(ProfWin *window)
+{
+    int pos, row;
+    int cols = _win_view_cols(window);
+    _win_view_top(window, cols, getmaxy(stdscr) - 3, &pos, &row);
 
-    window->layout->paged = 1;
-    win_update_virtual(window);
+    int top_pos = pos;
+    int top_row = row;
+    _win_scroll_up(window, cols, &top_pos, &top_row, 1);
 
-    // switch off page if last line and space line visible
-    if ((y) - *page_start == page_space) {
-        window->layout->paged = 0;
-    }
+    return (top_pos == pos && top_row == row);
 }
 
 void
@@ -462,7 +494,9 @@ win_sub_page_up(ProfWin *window)
 void
 win_clear(ProfWin *window)
 {
-    werase(window->layout->win);
+    window->layout->cleared = _win_end(window);
+    window->layout->paged = 0;
+    window->layout->touched = TRUE;
     win_update_virtual(window);
 }
 
@@ -470,7 +504,6 @@ void
 win_resize(ProfWin *window)
 {
     int subwin_cols = 0;
-    int cols = getmaxx(stdscr);
 
     if (window->layout->type == LAYOUT_SPLIT) {
         ProfLayoutSplit *layout = (ProfLayoutSplit*)window->layout;
@@ -480,7 +513,6 @@ win_resize(ProfWin *window)
             } else if (window->type == WIN_MUC) {
                 subwin_cols = win_occpuants_cols();
             }
-            wresize(layout->base.win, PAD_SIZE, cols - subwin_cols);
             wresize(layout->subwin, PAD_SIZE, subwin_cols);
             if (window->type == WIN_CONSOLE) {
                 rosterwin_roster();
@@ -489,11 +521,7 @@ win_resize(ProfWin *window)
                 assert(mucwin->memcheck == PROFMUCWIN_MEMCHECK);
                 occupantswin_occupants(mucwin->roomjid);
             }
-        } else {
-            wresize(layout->base.win, PAD_SIZE, cols);
         }
-    } else {
-        wresize(window->layout->win, PAD_SIZE, cols);
     }
 
     win_redraw(window);
@@ -504,69 +532,55 @@ win_update_virtual(ProfWin *window)
 {
     int rows, cols;
     getmaxyx(stdscr, rows, cols);
-    int subwin_cols = 0;
+
+    _win_draw_view(window);
+    wnoutrefresh(view);
 
     if (window->layout->type == LAYOUT_SPLIT) {
         ProfLayoutSplit *layout = (ProfLayoutSplit*)window->layout;
         if (layout->subwin) {
-            if (window->type == WIN_MUC) {
-                subwin_cols = win_occpuants_cols();
-            } else {
-                subwin_cols = win_roster_cols();
-            }
-            pnoutrefresh(layout->base.win, layout->base.y_pos, 0, 1, 0, rows-3, (cols-subwin_cols)-1);
+            int subwin_cols = cols - _win_view_cols(window);
             pnoutrefresh(layout->subwin, layout->sub_y_pos, 0, 1, (cols-subwin_cols), rows-3, cols-1);
-        } else {
-            pnoutrefresh(layout->base.win, layout->base.y_pos, 0, 1, 0, rows-3, cols-1);
         }
-    } else {
-        pnoutrefresh(window->layout->win, window->layout->y_pos, 0, 1, 0, rows-3, cols-1);
     }
+    ui_mark_dirty(UI_DIRTY_MAIN | UI_DIRTY_SUBWIN);
 }
 
 void
 win_refresh_without_subwin(ProfWin *window)
 {
-    int rows, cols;
-    getmaxyx(stdscr, rows, cols);
-
     if ((window->type == WIN_MUC) || (window->type == WIN_CONSOLE)) {
-        pnoutrefresh(window->layout->win, window->layout->y_pos, 0, 1, 0, rows-3, cols-1);
+        win_update_virtual(window);
     }
 }
 
 void
 win_refresh_with_subwin(ProfWin *window)
 {
-    int rows, cols;
-    getmaxyx(stdscr, rows, cols);
-    int subwin_cols = 0;
-
-    if (window->type == WIN_MUC) {
-        ProfLayoutSplit *layout = (ProfLayoutSplit*)window->layout;
-        subwin_cols = win_occpuants_cols();
-        pnoutrefresh(layout->base.win, layout->base.y_pos, 0, 1, 0, rows-3, (cols-subwin_cols)-1);
-        pnoutrefresh(layout->subwin, layout->sub_y_pos, 0, 1, (cols-subwin_cols), rows-3, cols-1);
-    } else if (window->type == WIN_CONSOLE) {
-        ProfLayoutSplit *layout = (ProfLayoutSplit*)window->layout;
-        subwin_cols = win_roster_cols();
-        pnoutrefresh(layout->base.win, layout->base.y_pos, 0, 1, 0, rows-3, (cols-subwin_cols)-1);
-        pnoutrefresh(layout->subwin, layout->sub_y_pos, 0, 1, (cols-subwin_cols), rows-3, cols-1);
+    if ((window->type == WIN_MUC) || (window->type == WIN_CONSOLE)) {
+        win_update_virtual(window);
     }
 }
 
 void
 win_move_to_end(ProfWin *window)
 {
-    window->layout->paged = 0;
-
-    int rows = getmaxy(stdscr);
-    int y = getcury(window->layout->win);
-    int size = rows - 3;
+    if (window->layout->paged) {
+        window->layout->paged = 0;
+        window->layout->touched = TRUE;
+    }
+}
 
-    window->layout->y_pos = y - (size - 1);
-    if (window->layout->y_pos < 0) {
-        window->layout->y_pos = 0;
+void
+win_close(void)
+{
+    if (view) {
+        delwin(view);
+        view = NULL;
+    }
+    if (render_pad) {
+        delwin(render_pad);
+        render_pad = NULL;
     }
 }
 
@@ -923,7 +937,7 @@ win_print(ProfWin *window, const char show_char, int pad_indent, GDateTime *time
     }
 
     buffer_push(window->layout->buffer, show_char, pad_indent, timestamp, flags, theme_item, from, message, NULL);
-    _win_print(window, show_char, pad_indent, timestamp, flags, theme_item, from, message, NULL);
+    _win_line_changed(window);
     // TODO: cross-reference.. this should be replaced by a real event-based system
     ui_input_nonblocking(TRUE);
     g_date_time_unref(timestamp);
@@ -946,7 +960,7 @@ win_print_with_receipt(ProfWin *window, const char show_char, int pad_indent, GT
     receipt->received = FALSE;
 
     buffer_push(window->layout->buffer, show_char, pad_indent, time, flags, theme_item, from, message, receipt);
-    _win_print(window, show_char, pad_indent, time, flags, theme_item, from, message, receipt);
+    _win_line_changed(window);
     // TODO: cross-reference.. this should be replaced by a real event-based system
     ui_input_nonblocking(TRUE);
     g_date_time_unref(time);
@@ -957,7 +971,7 @@ win_mark_received(ProfWin *window, const char * const id)
 {
     gboolean received = buffer_mark_received(window->layout->buffer, id);
     if (received) {
-        win_redraw(window);
+        window->layout->touched = TRUE;
     }
 }
 
@@ -974,9 +988,15 @@ win_newline(ProfWin *window)
 }
 
 static void
-_win_print(ProfWin *window, const char show_char, int pad_indent, GDateTime *time,
-    int flags, theme_item_t theme_item, const char * const from, const char * const message, DeliveryReceipt *receipt)
+_win_print(WINDOW *win, ProfBuffEntry *entry)
 {
+    const char show_char = entry->show_char;
+    int flags = entry->flags;
+    theme_item_t theme_item = entry->theme_item;
+    const char * const from = entry->from;
+    const char * const message = entry->message;
+    DeliveryReceipt *receipt = entry->receipt;
+
     // flags : 1st bit =  0/1 - me/not me
     //         2nd bit =  0/1 - date/no date
     //         3rd bit =  0/1 - eol/no eol
@@ -988,9 +1008,8 @@ _win_print(ProfWin *window, const char show_char, int pad_indent, GDateTime *tim
     size_t indent = 0;
 
     gchar *date_fmt = NULL;
-    char *time_pref = prefs_get_string(PREF_TIME);
-    date_fmt = g_date_time_format(time, time_pref);
-    prefs_free_string(time_pref);
+    const char *time_pref = prefs_get_string(PREF_TIME);
+    date_fmt = g_date_time_format(entry->time, time_pref);
     assert(date_fmt != NULL);
 
     if(strlen(date_fmt) != 0){
@@ -1000,11 +1019,11 @@ _win_print(ProfWin *window, const char show_char, int pad_indent, GDateTime *tim
     if ((flags & NO_DATE) == 0) {
         if (date_fmt && strlen(date_fmt)) {
             if ((flags & NO_COLOUR_DATE) == 0) {
-                wattron(window->layout->win, theme_attrs(THEME_TIME));
+                wattron(win, theme_attrs(THEME_TIME));
             }
-            wprintw(window->layout->win, "%s %c ", date_fmt, show_char);
+            wprintw(win, "%s %c ", date_fmt, show_char);
             if ((flags & NO_COLOUR_DATE) == 0) {
-                wattroff(window->layout->win, theme_attrs(THEME_TIME));
+                wattroff(win, theme_attrs(THEME_TIME));
             }
         }
     }
@@ -1022,45 +1041,45 @@ _win_print(ProfWin *window, const char show_char, int pad_indent, GDateTime *tim
             colour = theme_attrs(THEME_RECEIPT_SENT);
         }
 
-        wattron(window->layout->win, colour);
+        wattron(win, colour);
         if (strncmp(message, "/me ", 4) == 0) {
-            wprintw(window->layout->win, "*%s ", from);
+            wprintw(win, "*%s ", from);
             offset = 4;
             me_message = TRUE;
         } else {
-            wprintw(window->layout->win, "%s: ", from);
-            wattroff(window->layout->win, colour);
+            wprintw(win, "%s: ", from);
+            wattroff(win, colour);
         }
     }
 
     if (!me_message) {
         if (receipt && !receipt->received) {
-            wattron(window->layout->win, theme_attrs(THEME_RECEIPT_SENT));
+            wattron(win, theme_attrs(THEME_RECEIPT_SENT));
         } else {
-            wattron(window->layout->win, theme_attrs(theme_item));
+            wattron(win, theme_attrs(theme_item));
         }
     }
 
     if (prefs_get_boolean(PREF_WRAP)) {
-        _win_print_wrapped(window->layout->win, message+offset, indent, pad_indent);
+        _win_print_wrapped(win, entry, offset, indent);
     } else {
-        wprintw(window->layout->win, "%s", message+offset);
+        wprintw(win, "%s", message+offset);
     }
 
     if ((flags & NO_EOL) == 0) {
-        int curx = getcurx(window->layout->win);
+        int curx = getcurx(win);
         if (curx != 0) {
-            wprintw(window->layout->win, "\n");
+            wprintw(win, "\n");
         }
     }
 
     if (me_message) {
-        wattroff(window->layout->win, colour);
+        wattroff(win, colour);
     } else {
         if (receipt && !receipt->received) {
-            wattroff(window->layout->win, theme_attrs(THEME_RECEIPT_SENT));
+            wattroff(win, theme_attrs(THEME_RECEIPT_SENT));
         } else {
-            wattroff(window->layout->win, theme_attrs(theme_item));
+            wattroff(win, theme_attrs(theme_item));
         }
     }
 
@@ -1077,127 +1096,289 @@ _win_indent(WINDOW *win, int size)
 }
 
 static void
-_win_print_wrapped(WINDOW *win, const char * const message, size_t indent, int pad_indent)
+_win_print_wrapped(WINDOW *win, ProfBuffEntry *entry, int offset, size_t indent)
 {
-    int starty = getcury(win);
-    int wordi = 0;
-    char *word = malloc(strlen(message) + 1);
+    ProfBuffLayout *layout = buffer_entry_layout(entry, offset, getcurx(win), indent, getmaxx(win));
 
-    gchar *curr_ch = g_utf8_offset_to_pointer(message, 0);
+    int i;
+    for (i = 0; i < layout->segments->len; i++) {
+        ProfBuffSegment *segment = &g_array_index(layout->segments, ProfBuffSegment, i);
+        if (segment->newline) {
+            waddch(win, '\n');
+        }
+        _win_indent(win, segment->indent);
+        if (segment->len > 0) {
+            waddnstr(win, entry->message + segment->offset, segment->len);
+        }
+    }
+}
 
-    while (*curr_ch != '\0') {
+void
+win_redraw(ProfWin *window)
+{
+    // rows are measured again, lazily, for the lines that get drawn
+    ProfBuffIter iter;
+    ProfBuffEntry *e = NULL;
+    buffer_iter_init(&iter, window->layout->buffer);
+    while (buffer_iter_next(&iter, &e)) {
+        e->rows_cols = 0;
+    }
+    window->layout->touched = TRUE;
+}
 
-        // handle space
-        if (*curr_ch == ' ') {
-            waddch(win, ' ');
-            curr_ch = g_utf8_next_char(curr_ch);
+static ProfBuffEntry*
+_win_entry(ProfWin *window, int pos)
+{
+    ProfBuff buffer = window->layout->buffer;
+    return buffer_yield_entry(buffer, pos - buffer_start(buffer));
+}
 
-        // handle newline
-        } else if (*curr_ch == '\n') {
-            waddch(win, '\n');
-            _win_indent(win, indent + pad_indent);
-            curr_ch = g_utf8_next_char(curr_ch);
+static int
+_win_first(ProfWin *window)
+{
+    int start = buffer_start(window->layout->buffer);
+    if (window->layout->cleared > start) {
+        return window->layout->cleared;
+    } else {
+        return start;
+    }
+}
 
-        // handle word
-        } else {
-            wordi = 0;
-            int wordlen = 0;
-            while (*curr_ch != ' ' && *curr_ch != '\n' && *curr_ch != '\0') {
-                size_t ch_len = mbrlen(curr_ch, 4, NULL);
-                int offset = 0;
-                while (offset < ch_len) {
-                    word[wordi++] = curr_ch[offset++];
-                }
-                curr_ch = g_utf8_next_char(curr_ch);
-            }
-            word[wordi] = '\0';
-            wordlen = utf8_display_len(word);
-
-            int curx = getcurx(win);
-            int cury = getcury(win);
-            int maxx = getmaxx(win);
-
-            // wrap required
-            if (curx + wordlen > maxx) {
-                int linelen = maxx - (indent + pad_indent);
-
-                // word larger than line
-                if (wordlen > linelen) {
-                    gchar *word_ch = g_utf8_offset_to_pointer(word, 0);
-                    while(*word_ch != '\0') {
-                        curx = getcurx(win);
-                        cury = getcury(win);
-                        gboolean firstline = cury == starty;
-
-                        if (firstline && curx < indent) {
-                            _win_indent(win, indent);
-                        }
-                        if (!firstline && curx < (indent + pad_indent)) {
-                            _win_indent(win, indent + pad_indent);
-                        }
-
-                        gchar copy[wordi+1];
-                        g_utf8_strncpy(copy, word_ch, 1);
-                        waddstr(win, copy);
-
-                        word_ch = g_utf8_next_char(word_ch);
-                    }
+static int
+_win_end(ProfWin *window)
+{
+    ProfBuff buffer = window->layout->buffer;
+    return buffer_start(buffer) + buffer_size(buffer);
+}
 
-                // newline and print word
-                } else {
-                    waddch(win, '\n');
-                    curx = getcurx(win);
-                    cury = getcury(win);
-                    gboolean firstline = cury == starty;
+// a line is a run of entries printed with NO_EOL and the entry that ends it
+static int
+_win_line_start(ProfWin *window, int pos)
+{
+    int first = _win_first(window);
+    while (pos > first && (_win_entry(window, pos - 1)->flags & NO_EOL)) {
+        pos--;
+    }
 
-                    if (firstline && curx < indent) {
-                        _win_indent(win, indent);
-                    }
-                    if (!firstline && curx < (indent + pad_indent)) {
-                        _win_indent(win, indent + pad_indent);
-                    }
-                    waddstr(win, word);
-                }
+    return pos;
+}
 
-            // no wrap required
-            } else {
-                curx = getcurx(win);
-                cury = getcury(win);
-                gboolean firstline = cury == starty;
+static int
+_win_line_next(ProfWin *window, int pos)
+{
+    int end = _win_end(window);
+    while (pos < end - 1 && (_win_entry(window, pos)->flags & NO_EOL)) {
+        pos++;
+    }
 
-                if (firstline && curx < indent) {
-                    _win_indent(win, indent);
-                }
-                if (!firstline && curx < (indent + pad_indent)) {
-                    _win_indent(win, indent + pad_indent);
-                }
-                waddstr(win, word);
-            }
+    return pos + 1;
+}
+
+static void
+_win_line_changed(ProfWin *window)
+{
+    // the new entry may have continued an open line, whose rows are then stale
+    int pos = _win_line_start(window, _win_end(window) - 1);
+    if (pos >= _win_first(window)) {
+        _win_entry(window, pos)->rows_cols = 0;
+    }
+    window->layout->touched = TRUE;
+}
+
+static int
+_win_line_render(ProfWin *window, int pos, int cols)
+{
+    int next = _win_line_next(window, pos);
+    int pad_rows = RENDER_PAD_ROWS;
+    if (render_pad) {
+        pad_rows = getmaxy(render_pad);
+    }
+
+    while (TRUE) {
+        if (!render_pad) {
+            render_pad = newpad(pad_rows, cols);
+        } else if (getmaxy(render_pad) != pad_rows || getmaxx(render_pad) != cols) {
+            wresize(render_pad, pad_rows, cols);
         }
+        wbkgd(render_pad, theme_attrs(THEME_TEXT));
+        werase(render_pad);
 
-        // consume first space of next line
-        int curx = getcurx(win);
-        int cury = getcury(win);
-        gboolean firstline = (cury == starty);
+        int i;
+        for (i = pos; i < next; i++) {
+            _win_print(render_pad, _win_entry(window, i));
+        }
 
-        if (!firstline && curx == 0 && *curr_ch == ' ') {
-            curr_ch = g_utf8_next_char(curr_ch);
+        // reaching the last row means the line may not have fitted
+        if (getcury(render_pad) < pad_rows - 1) {
+            break;
         }
+        pad_rows *= 2;
     }
 
-    free(word);
+    ProfBuffEntry *entry = _win_entry(window, pos);
+    entry->rows = getcury(render_pad);
+    entry->rows_cols = cols;
+
+    return entry->rows;
 }
 
-void
-win_redraw(ProfWin *window)
+static int
+_win_line_rows(ProfWin *window, int pos, int cols)
 {
-    int i, size;
-    werase(window->layout->win);
-    size = buffer_size(window->layout->buffer);
+    ProfBuffEntry *entry = _win_entry(window, pos);
+    if (entry->rows_cols == cols) {
+        return entry->rows;
+    }
 
-    for (i = 0; i < size; i++) {
-        ProfBuffEntry *e = buffer_yield_entry(window->layout->buffer, i);
-        _win_print(window, e->show_char, e->pad_indent, e->time, e->flags, e->theme_item, e->from, e->message, e->receipt);
+    return _win_line_render(window, pos, cols);
+}
+
+// the row the next entry will be printed on, after the last line or in it when it is open
+static void
+_win_cursor(ProfWin *window, int cols, int *pos, int *row)
+{
+    int end = _win_end(window);
+    if (end > _win_first(window) && (_win_entry(window, end - 1)->flags & NO_EOL)) {
+        *pos = _win_line_start(window, end - 1);
+        *row = _win_line_rows(window, *pos, cols);
+    } else {
+        *pos = end;
+        *row = 0;
+    }
+}
+
+static void
+_win_scroll_up(ProfWin *window, int cols, int *pos, int *row, int n)
+{
+    int first = _win_first(window);
+    while (n > 0) {
+        if (*row >= n) {
+            *row -= n;
+            return;
+        }
+        n -= *row;
+
+        // went past beginning, stay on first line
+        if (*pos <= first) {
+            *pos = first;
+            *row = 0;
+            return;
+        }
+        *pos = _win_line_start(window, *pos - 1);
+        *row = _win_line_rows(window, *pos, cols);
+    }
+}
+
+static void
+_win_scroll_down(ProfWin *window, int cols, int *pos, int *row, int n)
+{
+    int end_pos, end_row;
+    _win_cursor(window, cols, &end_pos, &end_row);
+
+    *row += n;
+    while (*pos < end_pos) {
+        int rows = _win_line_rows(window, *pos, cols);
+        if (*row < rows) {
+            return;
+        }
+        *row -= rows;
+        *pos = _win_line_next(window, *pos);
+    }
+
+    // went past end, stop at the cursor
+    if (*row > end_row) {
+        *row = end_row;
+    }
+}
+
+static void
+_win_view_top(ProfWin *window, int cols, int rows, int *pos, int *row)
+{
+    if (window->layout->paged) {
+
+        // entries at the top may have been dropped or cleared, and rows change with the width
+        if (window->layout->top < _win_first(window)) {
+            window->layout->top = _win_first(window);
+            window->layout->top_row = 0;
+        }
+        _win_scroll_down(window, cols, &window->layout->top, &window->layout->top_row, 0);
+        *pos = window->layout->top;
+        *row = window->layout->top_row;
+    } else {
+        _win_view_end(window, cols, rows, pos, row);
+    }
+}
+
+// top of the last page, which has the cursor on its bottom row
+static void
+_win_view_end(ProfWin *window, int cols, int rows, int *pos, int *row)
+{
+    _win_cursor(window, cols, pos, row);
+    _win_scroll_up(window, cols, pos, row, rows - 1);
+}
+
+static int
+_win_view_cols(ProfWin *window)
+{
+    int cols = getmaxx(stdscr);
+
+    if (window->layout->type == LAYOUT_SPLIT) {
+        ProfLayoutSplit *layout = (ProfLayoutSplit*)window->layout;
+        if (layout->subwin) {
+            if (window->type == WIN_MUC) {
+                cols -= win_occpuants_cols();
+            } else {
+                cols -= win_roster_cols();
+            }
+        }
+    }
+
+    return cols;
+}
+
+static void
+_win_draw_view(ProfWin *window)
+{
+    int rows = getmaxy(stdscr) - 3;
+    int cols = _win_view_cols(window);
+    if (rows < 1 || cols < 1) {
+        return;
+    }
+
+    if (!view) {
+        view = newwin(rows, cols, 1, 0);
+    } else if (getmaxy(view) != rows || getmaxx(view) != cols) {
+        wresize(view, rows, cols);
+        mvwin(view, 1, 0);
+    }
+    wbkgd(view, theme_attrs(THEME_TEXT));
+    werase(view);
+
+    int pos, row;
+    _win_view_top(window, cols, rows, &pos, &row);
+
+    // render only the lines in view and copy their visible rows
+    int end = _win_end(window);
+    int y = 0;
+    while (y < rows && pos < end) {
+        int next = _win_line_next(window, pos);
+        int line_rows = _win_line_render(window, pos, cols);
+
+        // an open last line has text on the cursor row
+        if (next == end && (_win_entry(window, end - 1)->flags & NO_EOL)) {
+            line_rows++;
+        }
+
+        int count = line_rows - row;
+        if (count > rows - y) {
+            count = rows - y;
+        }
+        if (count > 0) {
+            copywin(render_pad, view, row, 0, y, 0, y + count - 1, cols - 1, FALSE);
+            y += count;
+        }
+        row = 0;
+        pos = next;
     }
 }
 
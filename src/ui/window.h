@@ -52,6 +52,7 @@
 #include <ncurses.h>
 #endif
 
+// rows of the roster and occupants panels
 #define PAD_SIZE 1000
 
 void win_move_to_end(ProfWin *window);
@@ -76,6 +77,7 @@ void win_clear(ProfWin *window);
 
 void win_page_up(ProfWin *window);
 void win_page_down(ProfWin *window);
+gboolean win_at_top(ProfWin *window);
 void win_sub_page_down(ProfWin *window);
 void win_sub_page_up(ProfWin *window);
 
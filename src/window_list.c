@@ -51,11 +51,25 @@
 static GHashTable *windows;
 static int current;
 
+// windows indexed by jid, keys are owned by the windows
+static GHashTable *chat_wins;
+static GHashTable *muc_wins;
+static GHashTable *muc_conf_wins;
+static GHashTable *private_wins;
+
+static GHashTable * _wins_index_for(ProfWin *window, char **jid);
+static void _wins_index_add(ProfWin *window);
+static void _wins_index_remove(ProfWin *window);
+
 void
 wins_init(void)
 {
     windows = g_hash_table_new_full(g_direct_hash, g_direct_equal, NULL,
         (GDestroyNotify)win_free);
+    chat_wins = g_hash_table_new(g_str_hash, g_str_equal);
+    muc_wins = g_hash_table_new(g_str_hash, g_str_equal);
+    muc_conf_wins = g_hash_table_new(g_str_hash, g_str_equal);
+    private_wins = g_hash_table_new(g_str_hash, g_str_equal);
 
     ProfWin *console = win_create_console();
     g_hash_table_insert(windows, GINT_TO_POINTER(1), console);
@@ -72,89 +86,41 @@ wins_get_console(void)
 ProfChatWin *
 wins_get_chat(const char * const barejid)
 {
-    GList *values = g_hash_table_get_values(windows);
-    GList *curr = values;
-
-    while (curr) {
-        ProfWin *window = curr->data;
-        if (window->type == WIN_CHAT) {
-            ProfChatWin *chatwin = (ProfChatWin*)window;
-            if (g_strcmp0(chatwin->barejid, barejid) == 0) {
-                g_list_free(values);
-                return chatwin;
-            }
-        }
-        curr = g_list_next(curr);
+    if (!barejid) {
+        return NULL;
     }
 
-    g_list_free(values);
-    return NULL;
+    return g_hash_table_lookup(chat_wins, barejid);
 }
 
 ProfMucConfWin *
 wins_get_muc_conf(const char * const roomjid)
 {
-    GList *values = g_hash_table_get_values(windows);
-    GList *curr = values;
-
-    while (curr) {
-        ProfWin *window = curr->data;
-        if (window->type == WIN_MUC_CONFIG) {
-            ProfMucConfWin *confwin = (ProfMucConfWin*)window;
-            if (g_strcmp0(confwin->roomjid, roomjid) == 0) {
-                g_list_free(values);
-                return confwin;
-            }
-        }
-        curr = g_list_next(curr);
+    if (!roomjid) {
+        return NULL;
     }
 
-    g_list_free(values);
-    return NULL;
+    return g_hash_table_lookup(muc_conf_wins, roomjid);
 }
 
 ProfMucWin *
 wins_get_muc(const char * const roomjid)
 {
-    GList *values = g_hash_table_get_values(windows);
-    GList *curr = values;
-
-    while (curr) {
-        ProfWin *window = curr->data;
-        if (window->type == WIN_MUC) {
-            ProfMucWin *mucwin = (ProfMucWin*)window;
-            if (g_strcmp0(mucwin->roomjid, roomjid) == 0) {
-                g_list_free(values);
-                return mucwin;
-            }
-        }
-        curr = g_list_next(curr);
+    if (!roomjid) {
+        return NULL;
     }
 
-    g_list_free(values);
-    return NULL;
+    return g_hash_table_lookup(muc_wins, roomjid);
 }
 
 ProfPrivateWin *
 wins_get_private(const char * const fulljid)
 {
-    GList *values = g_hash_table_get_values(windows);
-    GList *curr = values;
-
-    while (curr) {
-        ProfWin *window = curr->data;
-        if (window->type == WIN_PRIVATE) {
-            ProfPrivateWin *privatewin = (ProfPrivateWin*)window;
-            if (g_strcmp0(privatewin->fulljid, fulljid) == 0) {
-                g_list_free(values);
-                return privatewin;
-            }
-        }
-        curr = g_list_next(curr);
+    if (!fulljid) {
+        return NULL;
     }
 
-    g_list_free(values);
-    return NULL;
+    return g_hash_table_lookup(private_wins, fulljid);
 }
 
 ProfWin *
@@ -304,6 +270,10 @@ wins_close_by_num(int i)
             win_update_virtual(window);
         }
 
+        ProfWin *window = g_hash_table_lookup(windows, GINT_TO_POINTER(i));
+        if (window) {
+            _wins_index_remove(window);
+        }
         g_hash_table_remove(windows, GINT_TO_POINTER(i));
         status_bar_inactive(i);
     }
@@ -332,6 +302,17 @@ wins_new_xmlconsole(void)
     return newwin;
 }
 
+ProfWin *
+wins_new_single(win_type_t type)
+{
+    GList *keys = g_hash_table_get_keys(windows);
+    int result = get_next_available_win_num(keys);
+    g_list_free(keys);
+    ProfWin *newwin = win_create_single(type);
+    g_hash_table_insert(windows, GINT_TO_POINTER(result), newwin);
+    return newwin;
+}
+
 ProfWin *
 wins_new_chat(const char * const barejid)
 {
@@ -340,6 +321,7 @@ wins_new_chat(const char * const barejid)
     g_list_free(keys);
     ProfWin *newwin = win_create_chat(barejid);
     g_hash_table_insert(windows, GINT_TO_POINTER(result), newwin);
+    _wins_index_add(newwin);
     return newwin;
 }
 
@@ -351,6 +333,7 @@ wins_new_muc(const char * const roomjid)
     g_list_free(keys);
     ProfWin *newwin = win_create_muc(roomjid);
     g_hash_table_insert(windows, GINT_TO_POINTER(result), newwin);
+    _wins_index_add(newwin);
     return newwin;
 }
 
@@ -362,6 +345,7 @@ wins_new_muc_config(const char * const roomjid, DataForm *form)
     g_list_free(keys);
     ProfWin *newwin = win_create_muc_config(roomjid, form);
     g_hash_table_insert(windows, GINT_TO_POINTER(result), newwin);
+    _wins_index_add(newwin);
     return newwin;
 }
 
@@ -373,6 +357,7 @@ wins_new_private(const char * const fulljid)
     g_list_free(keys);
     ProfWin *newwin = win_create_private(fulljid);
     g_hash_table_insert(windows, GINT_TO_POINTER(result), newwin);
+    _wins_index_add(newwin);
     return newwin;
 }
 
@@ -447,6 +432,27 @@ wins_get_xmlconsole(void)
     return NULL;
 }
 
+ProfSingleWin *
+wins_get_single(win_type_t type)
+{
+    GList *values = g_hash_table_get_values(windows);
+    GList *curr = values;
+
+    while (curr) {
+        ProfWin *window = curr->data;
+        if (window->type == type) {
+            ProfSingleWin *singlewin = (ProfSingleWin*)window;
+            assert(singlewin->memcheck == PROFSINGLEWIN_MEMCHECK);
+            g_list_free(values);
+            return singlewin;
+        }
+        curr = g_list_next(curr);
+    }
+
+    g_list_free(values);
+    return NULL;
+}
+
 GSList *
 wins_get_chat_recipients(void)
 {
@@ -638,6 +644,7 @@ wins_create_summary(void)
         GString *muc_string;
         GString *muc_config_string;
         GString *xml_string;
+        GString *single_string;
 
         switch (window->type)
         {
@@ -724,6 +731,17 @@ wins_create_summary(void)
 
                 break;
 
+            case WIN_SEARCH:
+            case WIN_PERF:
+                single_string = g_string_new("");
+                char *single_title = win_get_title(window);
+                g_string_printf(single_string, "%d: %s", ui_index, single_title);
+                result = g_slist_append(result, strdup(single_string->str));
+                g_string_free(single_string, TRUE);
+                free(single_title);
+
+                break;
+
             default:
                 break;
         }
@@ -737,5 +755,56 @@ wins_create_summary(void)
 void
 wins_destroy(void)
 {
+    g_hash_table_destroy(chat_wins);
+    g_hash_table_destroy(muc_wins);
+    g_hash_table_destroy(muc_conf_wins);
+    g_hash_table_destroy(private_wins);
     g_hash_table_destroy(windows);
 }
+
+// the jid indexes map to windows rather than window numbers,
+// so they are unaffected by swapping and tidying windows
+static GHashTable *
+_wins_index_for(ProfWin *window, char **jid)
+{
+    switch (window->type)
+    {
+        case WIN_CHAT:
+            *jid = ((ProfChatWin*)window)->barejid;
+            return chat_wins;
+        case WIN_MUC:
+            *jid = ((ProfMucWin*)window)->roomjid;
+            return muc_wins;
+        case WIN_MUC_CONFIG:
+            *jid = ((ProfMucConfWin*)window)->roomjid;
+            return muc_conf_wins;
+        case WIN_PRIVATE:
+            *jid = ((ProfPrivateWin*)window)->fulljid;
+            return private_wins;
+        default:
+            return NULL;
+    }
+}
+
+static void
+_wins_index_add(ProfWin *window)
+{
+    char *jid = NULL;
+    GHashTable *index = _wins_index_for(window, &jid);
+
+    // keep the existing window if one is already open for the jid
+    if (index && !g_hash_table_lookup(index, jid)) {
+        g_hash_table_insert(index, jid, window);
+    }
+}
+
+static void
+_wins_index_remove(ProfWin *window)
+{
+    char *jid = NULL;
+    GHashTable *index = _wins_index_for(window, &jid);
+
+    if (index && g_hash_table_lookup(index, jid) == window) {
+        g_hash_table_remove(index, jid);
+    }
+}
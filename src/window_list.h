@@ -40,6 +40,7 @@
 void wins_init(void);
 
 ProfWin * wins_new_xmlconsole(void);
+ProfWin * wins_new_single(win_type_t type);
 ProfWin * wins_new_chat(const char * const barejid);
 ProfWin * wins_new_muc(const char * const roomjid);
 ProfWin * wins_new_muc_config(const char * const roomjid, DataForm *form);
@@ -51,6 +52,7 @@ ProfMucWin * wins_get_muc(const char * const roomjid);
 ProfMucConfWin * wins_get_muc_conf(const char * const roomjid);
 ProfPrivateWin *wins_get_private(const char * const fulljid);
 ProfXMLWin * wins_get_xmlconsole(void);
+ProfSingleWin * wins_get_single(win_type_t type);
 
 ProfWin * wins_get_current(void);
 
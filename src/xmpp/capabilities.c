@@ -47,6 +47,7 @@
 
 #include "common.h"
 #include "log.h"
+#include "tools/persist.h"
 #include "xmpp/xmpp.h"
 #include "xmpp/stanza.h"
 #include "xmpp/form.h"
@@ -54,17 +55,21 @@
 
 static gchar *cache_loc;
 static GKeyFile *cache;
+static PersistStore cache_store;
 
 static GHashTable *jid_to_ver;
 static GHashTable *jid_to_caps;
 
+// ver -> Capabilities parsed from the cache file, shared between jids
+static GHashTable *ver_to_caps;
+
 static char *my_sha1;
 
 static gchar* _get_cache_file(void);
 static void _save_cache(void);
+static void _write_cache(void);
 static Capabilities * _caps_by_ver(const char * const ver);
 static Capabilities * _caps_by_jid(const char * const jid);
-Capabilities * _caps_copy(Capabilities *caps);
 
 void
 caps_init(void)
@@ -79,9 +84,11 @@ caps_init(void)
     cache = g_key_file_new();
     g_key_file_load_from_file(cache, cache_loc, G_KEY_FILE_KEEP_COMMENTS,
         NULL);
+    cache_store = persist_store_new("capabilities cache", _write_cache);
 
     jid_to_ver = g_hash_table_new_full(g_str_hash, g_str_equal, g_free, g_free);
     jid_to_caps = g_hash_table_new_full(g_str_hash, g_str_equal, g_free, (GDestroyNotify)caps_destroy);
+    ver_to_caps = g_hash_table_new_full(g_str_hash, g_str_equal, g_free, (GDestroyNotify)caps_destroy);
 
     my_sha1 = NULL;
 }
@@ -126,6 +133,11 @@ caps_add_by_ver(const char * const ver, Capabilities *caps)
 
         _save_cache();
     }
+
+    if (!g_hash_table_contains(ver_to_caps, ver)) {
+        caps->refcount++;
+        g_hash_table_insert(ver_to_caps, strdup(ver), caps);
+    }
 }
 
 void
@@ -143,12 +155,17 @@ caps_map_jid_to_ver(const char * const jid, const char * const ver)
 gboolean
 caps_contains(const char * const ver)
 {
-    return (g_key_file_has_group(cache, ver));
+    return g_hash_table_contains(ver_to_caps, ver) || g_key_file_has_group(cache, ver);
 }
 
 static Capabilities *
 _caps_by_ver(const char * const ver)
 {
+    Capabilities *caps = g_hash_table_lookup(ver_to_caps, ver);
+    if (caps) {
+        return caps;
+    }
+
     if (g_key_file_has_group(cache, ver)) {
         Capabilities *new_caps = malloc(sizeof(struct capabilities_t));
 
@@ -214,6 +231,9 @@ _caps_by_ver(const char * const ver)
         } else {
             new_caps->features = NULL;
         }
+        new_caps->refcount = 1;
+
+        g_hash_table_insert(ver_to_caps, strdup(ver), new_caps);
         return new_caps;
     } else {
         return NULL;
@@ -234,13 +254,15 @@ caps_lookup(const char * const jid)
         Capabilities *caps = _caps_by_ver(ver);
         if (caps) {
             log_debug("Capabilities lookup %s, found by verification string %s.", jid, ver);
+            caps->refcount++;
             return caps;
         }
     } else {
         Capabilities *caps = _caps_by_jid(jid);
         if (caps) {
             log_debug("Capabilities lookup %s, found by JID.", jid);
-            return _caps_copy(caps);
+            caps->refcount++;
+            return caps;
         }
     }
 
@@ -248,32 +270,6 @@ caps_lookup(const char * const jid)
     return NULL;
 }
 
-Capabilities *
-_caps_copy(Capabilities *caps)
-{
-    if (!caps) {
-        return NULL;
-    } else {
-        Capabilities *result = (Capabilities *)malloc(sizeof(Capabilities));
-        result->category = caps->category ? strdup(caps->category) : NULL;
-        result->type = caps->type ? strdup(caps->type) : NULL;
-        result->name = caps->name ? strdup(caps->name) : NULL;
-        result->software = caps->software ? strdup(caps->software) : NULL;
-        result->software_version = caps->software_version ? strdup(caps->software_version) : NULL;
-        result->os = caps->os ? strdup(caps->os) : NULL;
-        result->os_version = caps->os_version ? strdup(caps->os_version) : NULL;
-
-        result->features = NULL;
-        GSList *curr = caps->features;
-        while (curr) {
-            result->features = g_slist_append(result->features, strdup(curr->data));
-            curr = g_slist_next(curr);
-        }
-
-        return result;
-    }
-}
-
 char *
 caps_create_sha1_str(xmpp_stanza_t * const query)
 {
@@ -530,6 +526,7 @@ caps_create(xmpp_stanza_t *query)
     } else {
         new_caps->features = NULL;
     }
+    new_caps->refcount = 1;
 
     return new_caps;
 }
@@ -626,16 +623,24 @@ caps_create_query_response_stanza(xmpp_ctx_t * const ctx)
 void
 caps_close(void)
 {
+    persist_store_free(cache_store);
+    cache_store = NULL;
     g_key_file_free(cache);
     cache = NULL;
     g_hash_table_destroy(jid_to_ver);
     g_hash_table_destroy(jid_to_caps);
+    g_hash_table_destroy(ver_to_caps);
 }
 
 void
 caps_destroy(Capabilities *caps)
 {
     if (caps) {
+        caps->refcount--;
+        if (caps->refcount > 0) {
+            return;
+        }
+
         free(caps->category);
         free(caps->type);
         free(caps->name);
@@ -665,10 +670,15 @@ _get_cache_file(void)
 
 static void
 _save_cache(void)
+{
+    persist_store_changed(cache_store);
+}
+
+static void
+_write_cache(void)
 {
     gsize g_data_size;
     gchar *g_cache_data = g_key_file_to_data(cache, &g_data_size, NULL);
-    g_file_set_contents(cache_loc, g_cache_data, g_data_size, NULL);
-    g_chmod(cache_loc, S_IRUSR | S_IWUSR);
+    persist_write_file(cache_loc, g_cache_data, g_data_size);
     g_free(g_cache_data);
 }
\ No newline at end of file
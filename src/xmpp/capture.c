@@ -0,0 +1,121 @@
+/*
+ * capture.c
+ *
+ * Copyright (C) 2012 - 2015 James Booth <boothj5@gmail.com>
+ *
+ * This file is part of Profanity.
+ *
+ * Profanity is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Profanity is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Profanity.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * In addition, as a special exception, the copyright holders give permission to
+ * link the code of portions of this program with the OpenSSL library under
+ * certain conditions as described in each individual source file, and
+ * distribute linked combinations including the two.
+ *
+ * You must obey the GNU General Public License in all respects for all of the
+ * code used other than OpenSSL. If you modify file(s) with this exception, you
+ * may extend this exception to your version of the file(s), but you are not
+ * obligated to do so. If you do not wish to do so, delete this exception
+ * statement from your version. If you delete this exception statement from all
+ * source files in the program, then also delete it here.
+ *
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <glib.h>
+#include <strophe.h>
+
+#include "log.h"
+#include "xmpp/capture.h"
+#include "xmpp/connection.h"
+#include "xmpp/xmpp.h"
+
+static FILE *capture_file;
+static char *capture_file_path;
+static gint64 capture_started;
+
+static int _capture_handler(xmpp_conn_t * const conn,
+    xmpp_stanza_t * const stanza, void * const userdata);
+
+void
+capture_add_handlers(void)
+{
+    xmpp_conn_t * const conn = connection_get_conn();
+    xmpp_ctx_t * const ctx = connection_get_ctx();
+
+    // added before the other handlers so stanzas are timed as they arrive
+    xmpp_handler_add(conn, _capture_handler, NULL, NULL, NULL, ctx);
+}
+
+gboolean
+capture_start(const char * const path)
+{
+    capture_stop();
+
+    capture_file = fopen(path, "w");
+    if (!capture_file) {
+        log_error("Could not open capture file %s", path);
+        return FALSE;
+    }
+
+    fprintf(capture_file, "%s\n", CAPTURE_HEADER);
+    capture_file_path = strdup(path);
+    capture_started = g_get_monotonic_time();
+    log_info("Capturing received stanzas to %s", path);
+
+    return TRUE;
+}
+
+void
+capture_stop(void)
+{
+    if (capture_file) {
+        fclose(capture_file);
+        capture_file = NULL;
+        log_info("Stopped capturing received stanzas to %s", capture_file_path);
+        free(capture_file_path);
+        capture_file_path = NULL;
+    }
+}
+
+const char *
+capture_path(void)
+{
+    return capture_file_path;
+}
+
+static int
+_capture_handler(xmpp_conn_t * const conn,
+    xmpp_stanza_t * const stanza, void * const userdata)
+{
+    if (!capture_file) {
+        return 1;
+    }
+
+    xmpp_ctx_t *ctx = (xmpp_ctx_t *)userdata;
+    char *text = NULL;
+    size_t text_size = 0;
+    if (xmpp_stanza_to_text(stanza, &text, &text_size) == XMPP_EOK) {
+        gint64 offset = g_get_monotonic_time() - capture_started;
+        fprintf(capture_file, "%" G_GINT64_FORMAT " %zu\n", offset, text_size);
+        fwrite(text, 1, text_size, capture_file);
+        fputc('\n', capture_file);
+        xmpp_free(ctx, text);
+    }
+
+    return 1;
+}
@@ -48,6 +48,7 @@
 #include "event/server_events.h"
 #include "xmpp/bookmark.h"
 #include "xmpp/capabilities.h"
+#include "xmpp/capture.h"
 #include "xmpp/connection.h"
 #include "xmpp/iq.h"
 #include "xmpp/message.h"
@@ -65,8 +66,17 @@ static struct _jabber_conn_t {
     int priority;
     int tls_disabled;
     char *domain;
+    int sock;
+    unsigned long stanzas_handled;
+    gboolean input_pending;
 } jabber_conn;
 
+// libstrophe reads at most 4096 bytes per run and a TLS record holds up to 16384,
+// so keep running until this many runs in a row handle no stanza
+#define PROCESS_IDLE_RUNS 4
+// most runs per call, so a flood of stanzas cannot starve the terminal
+#define PROCESS_MAX_RUNS 256
+
 static GHashTable *available_resources;
 
 // for auto reconnect
@@ -95,10 +105,14 @@ static xmpp_log_t * _xmpp_get_file_logger();
 static jabber_conn_status_t _jabber_connect(const char * const fulljid,
     const char * const passwd, const char * const altdomain, int port);
 static void _jabber_reconnect(void);
+static void _jabber_run(int millis);
 
 static void _connection_handler(xmpp_conn_t * const conn,
     const xmpp_conn_event_t status, const int error,
     xmpp_stream_error_t * const stream_error, void * const userdata);
+#ifdef HAVE_XMPP_CONN_SET_SOCKOPT_CALLBACK
+static int _connection_sockopt_cb(xmpp_conn_t *conn, void *sock);
+#endif
 
 void _connection_free_saved_account(void);
 void _connection_free_saved_details(void);
@@ -114,6 +128,7 @@ jabber_init(const int disable_tls)
     jabber_conn.ctx = NULL;
     jabber_conn.tls_disabled = disable_tls;
     jabber_conn.domain = NULL;
+    jabber_conn.sock = -1;
     presence_sub_requests_init();
     caps_init();
     available_resources = g_hash_table_new_full(g_str_hash, g_str_equal, free,
@@ -210,6 +225,7 @@ jabber_disconnect(void)
     }
 
     jabber_conn.conn_status = JABBER_STARTED;
+    jabber_conn.sock = -1;
     FREE_SET_NULL(jabber_conn.presence_message);
     FREE_SET_NULL(jabber_conn.domain);
 }
@@ -220,6 +236,7 @@ jabber_shutdown(void)
     _connection_free_saved_account();
     _connection_free_saved_details();
     _connection_free_session_data();
+    capture_stop();
     xmpp_shutdown();
     free(jabber_conn.log);
     jabber_conn.log = NULL;
@@ -235,7 +252,7 @@ jabber_process_events(int millis)
         case JABBER_CONNECTED:
         case JABBER_CONNECTING:
         case JABBER_DISCONNECTING:
-            xmpp_run_once(jabber_conn.ctx, millis);
+            _jabber_run(millis);
             break;
         case JABBER_DISCONNECTED:
             reconnect_sec = prefs_get_reconnect();
@@ -263,6 +280,47 @@ jabber_get_connection_status(void)
     return (jabber_conn.conn_status);
 }
 
+// TRUE when the last call to jabber_process_events stopped with stanzas still
+// arriving, data may be buffered by libstrophe or the TLS library where
+// polling the socket will not see it
+gboolean
+jabber_has_pending_input(void)
+{
+    return (jabber_get_socket() != -1) && jabber_conn.input_pending;
+}
+
+// TRUE when libstrophe has stanzas it could not yet write to the socket
+gboolean
+jabber_has_pending_output(void)
+{
+#ifdef HAVE_XMPP_CONN_SEND_QUEUE_LEN
+    if (jabber_get_socket() != -1) {
+        return xmpp_conn_send_queue_len(jabber_conn.conn) > 0;
+    }
+#endif
+    return FALSE;
+}
+
+void
+connection_stanza_handled(void)
+{
+    jabber_conn.stanzas_handled++;
+}
+
+int
+jabber_get_socket(void)
+{
+    switch (jabber_conn.conn_status)
+    {
+        case JABBER_CONNECTED:
+        case JABBER_CONNECTING:
+        case JABBER_DISCONNECTING:
+            return jabber_conn.sock;
+        default:
+            return -1;
+    }
+}
+
 xmpp_conn_t *
 connection_get_conn(void)
 {
@@ -399,6 +457,10 @@ _jabber_connect(const char * const fulljid, const char * const passwd,
     if (jabber_conn.tls_disabled) {
         xmpp_conn_disable_tls(jabber_conn.conn);
     }
+    jabber_conn.sock = -1;
+#ifdef HAVE_XMPP_CONN_SET_SOCKOPT_CALLBACK
+    xmpp_conn_set_sockopt_callback(jabber_conn.conn, _connection_sockopt_cb);
+#endif
 
     int connect_status = xmpp_connect_client(jabber_conn.conn, altdomain, port,
         _connection_handler, jabber_conn.ctx);
@@ -411,6 +473,32 @@ _jabber_connect(const char * const fulljid, const char * const passwd,
     return jabber_conn.conn_status;
 }
 
+// each run reads at most one chunk, keep running while stanzas are handled
+static void
+_jabber_run(int millis)
+{
+    int runs = 0;
+    int idle_runs = 0;
+    while (idle_runs < PROCESS_IDLE_RUNS && runs < PROCESS_MAX_RUNS &&
+            jabber_conn.conn_status != JABBER_DISCONNECTED) {
+        unsigned long handled = jabber_conn.stanzas_handled;
+        if (runs == 0) {
+            xmpp_run_once(jabber_conn.ctx, millis);
+        } else {
+            xmpp_run_once(jabber_conn.ctx, 0);
+        }
+        runs++;
+
+        if (jabber_conn.stanzas_handled != handled) {
+            idle_runs = 0;
+        } else {
+            idle_runs++;
+        }
+    }
+
+    jabber_conn.input_pending = (idle_runs < PROCESS_IDLE_RUNS);
+}
+
 static void
 _jabber_reconnect(void)
 {
@@ -461,6 +549,7 @@ _connection_handler(xmpp_conn_t * const conn,
 
         chat_sessions_init();
 
+        capture_add_handlers();
         roster_add_handlers();
         message_add_handlers();
         presence_add_handlers();
@@ -521,6 +610,7 @@ _connection_handler(xmpp_conn_t * const conn,
 
         // close stream response from server after disconnect is handled too
         jabber_conn.conn_status = JABBER_DISCONNECTED;
+        jabber_conn.sock = -1;
     } else if (status == XMPP_CONN_FAIL) {
         log_debug("Connection handler: XMPP_CONN_FAIL");
     } else {
@@ -528,6 +618,16 @@ _connection_handler(xmpp_conn_t * const conn,
     }
 }
 
+#ifdef HAVE_XMPP_CONN_SET_SOCKOPT_CALLBACK
+static int
+_connection_sockopt_cb(xmpp_conn_t *conn, void *sock)
+{
+    // remember the socket so the main loop can wait on it, keep libstrophe's keepalive defaults
+    jabber_conn.sock = *((sock_t*)sock);
+    return xmpp_sockopt_cb_keepalive(conn, sock);
+}
+#endif
+
 static log_level_t
 _get_log_level(const xmpp_log_level_t xmpp_level)
 {
@@ -38,6 +38,7 @@
 #include <strophe.h>
 
 #include "resource.h"
+#include "tools/perf.h"
 
 xmpp_conn_t *connection_get_conn(void);
 xmpp_ctx_t *connection_get_ctx(void);
@@ -45,5 +46,19 @@ void connection_set_priority(int priority);
 void connection_set_presence_message(const char * const message);
 void connection_add_available_resource(Resource *resource);
 void connection_remove_available_resource(const char * const resource);
+void connection_stanza_handled(void);
+
+// define func_perf, which /perf times as "<stanza> <func>"
+// each handler gets its own wrapper as libstrophe ignores a handler function added twice
+#define PERF_HANDLER(stanza_name, func) \
+static int \
+func##_perf(xmpp_conn_t * const conn, xmpp_stanza_t * const stanza, void * const userdata) \
+{ \
+    gint64 start = perf_start(); \
+    int result = func(conn, stanza, userdata); \
+    perf_end(stanza_name " " #func, start); \
+    connection_stanza_handled(); \
+    return result; \
+}
 
 #endif
@@ -57,7 +57,7 @@
 #include "roster_list.h"
 #include "xmpp/xmpp.h"
 
-#define HANDLE(ns, type, func) xmpp_handler_add(conn, func, ns, STANZA_NAME_IQ, type, ctx)
+#define HANDLE(ns, type, func) xmpp_handler_add(conn, func##_perf, ns, STANZA_NAME_IQ, type, ctx)
 
 typedef struct p_room_info_data_t {
     char *room;
@@ -89,6 +89,13 @@ static int _caps_response_handler(xmpp_conn_t *const conn, xmpp_stanza_t * const
 static int _caps_response_handler_for_jid(xmpp_conn_t *const conn, xmpp_stanza_t * const stanza, void * const userdata);
 static int _caps_response_handler_legacy(xmpp_conn_t *const conn, xmpp_stanza_t * const stanza, void * const userdata);
 
+PERF_HANDLER(STANZA_NAME_IQ, _error_handler)
+PERF_HANDLER(STANZA_NAME_IQ, _disco_info_get_handler)
+PERF_HANDLER(STANZA_NAME_IQ, _disco_items_get_handler)
+PERF_HANDLER(STANZA_NAME_IQ, _disco_items_result_handler)
+PERF_HANDLER(STANZA_NAME_IQ, _version_get_handler)
+PERF_HANDLER(STANZA_NAME_IQ, _ping_get_handler)
+
 void
 iq_add_handlers(void)
 {
@@ -52,7 +52,7 @@
 #include "xmpp/xmpp.h"
 #include "pgp/gpg.h"
 
-#define HANDLE(ns, type, func) xmpp_handler_add(conn, func, ns, STANZA_NAME_MESSAGE, type, ctx)
+#define HANDLE(ns, type, func) xmpp_handler_add(conn, func##_perf, ns, STANZA_NAME_MESSAGE, type, ctx)
 
 static int _groupchat_handler(xmpp_conn_t * const conn, xmpp_stanza_t * const stanza, void * const userdata);
 static int _chat_handler(xmpp_conn_t * const conn, xmpp_stanza_t * const stanza, void * const userdata);
@@ -62,6 +62,14 @@ static int _captcha_handler(xmpp_conn_t * const conn, xmpp_stanza_t * const stan
 static int _message_error_handler(xmpp_conn_t * const conn, xmpp_stanza_t * const stanza, void * const userdata);
 static int _receipt_received_handler(xmpp_conn_t * const conn, xmpp_stanza_t * const stanza, void * const userdata);
 
+PERF_HANDLER(STANZA_NAME_MESSAGE, _message_error_handler)
+PERF_HANDLER(STANZA_NAME_MESSAGE, _groupchat_handler)
+PERF_HANDLER(STANZA_NAME_MESSAGE, _chat_handler)
+PERF_HANDLER(STANZA_NAME_MESSAGE, _muc_user_handler)
+PERF_HANDLER(STANZA_NAME_MESSAGE, _conference_handler)
+PERF_HANDLER(STANZA_NAME_MESSAGE, _captcha_handler)
+PERF_HANDLER(STANZA_NAME_MESSAGE, _receipt_received_handler)
+
 void
 message_add_handlers(void)
 {
@@ -53,7 +53,7 @@
 
 static Autocomplete sub_requests_ac;
 
-#define HANDLE(ns, type, func) xmpp_handler_add(conn, func, ns, \
+#define HANDLE(ns, type, func) xmpp_handler_add(conn, func##_perf, ns, \
                                                 STANZA_NAME_PRESENCE, type, ctx)
 
 static int _unavailable_handler(xmpp_conn_t * const conn,
@@ -80,6 +80,14 @@ presence_sub_requests_init(void)
     sub_requests_ac = autocomplete_new();
 }
 
+PERF_HANDLER(STANZA_NAME_PRESENCE, _presence_error_handler)
+PERF_HANDLER(STANZA_NAME_PRESENCE, _muc_user_handler)
+PERF_HANDLER(STANZA_NAME_PRESENCE, _unavailable_handler)
+PERF_HANDLER(STANZA_NAME_PRESENCE, _subscribe_handler)
+PERF_HANDLER(STANZA_NAME_PRESENCE, _subscribed_handler)
+PERF_HANDLER(STANZA_NAME_PRESENCE, _unsubscribed_handler)
+PERF_HANDLER(STANZA_NAME_PRESENCE, _available_handler)
+
 void
 presence_add_handlers(void)
 {
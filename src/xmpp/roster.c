@@ -51,7 +51,7 @@
 #include "xmpp/stanza.h"
 #include "xmpp/xmpp.h"
 
-#define HANDLE(type, func) xmpp_handler_add(conn, func, XMPP_NS_ROSTER, \
+#define HANDLE(type, func) xmpp_handler_add(conn, func##_perf, XMPP_NS_ROSTER, \
 STANZA_NAME_IQ, type, ctx)
 
 // callback data for group commands
@@ -77,6 +77,9 @@ _group_remove_handler(xmpp_conn_t * const conn, xmpp_stanza_t * const stanza,
 // helper functions
 GSList * _get_groups_from_item(xmpp_stanza_t *item);
 
+PERF_HANDLER(STANZA_NAME_IQ, _roster_set_handler)
+PERF_HANDLER(STANZA_NAME_IQ, _roster_result_handler)
+
 void
 roster_add_handlers(void)
 {
@@ -305,6 +308,8 @@ _roster_result_handler(xmpp_conn_t * const conn, xmpp_stanza_t * const stanza, v
     // handle initial roster response
     xmpp_stanza_t *query = xmpp_stanza_get_child_by_name(stanza, STANZA_NAME_QUERY);
     xmpp_stanza_t *item = xmpp_stanza_get_children(query);
+    GSList *new_contacts = NULL;
+    gint count = 0;
 
     while (item) {
         const char *barejid = xmpp_stanza_get_attribute(item, STANZA_ATTR_JID);
@@ -323,15 +328,20 @@ _roster_result_handler(xmpp_conn_t * const conn, xmpp_stanza_t * const stanza, v
 
         GSList *groups = _get_groups_from_item(item);
 
-        gboolean added = roster_add(barejid_lower, name, groups, sub, pending_out);
-        if (!added) {
-            log_warning("Attempt to add contact twice: %s", barejid_lower);
-        }
+        PContact contact = p_contact_new(barejid_lower, name, groups, sub, NULL, pending_out);
+        new_contacts = g_slist_prepend(new_contacts, contact);
+        count++;
 
         g_free(barejid_lower);
         item = xmpp_stanza_get_next(item);
     }
 
+    // index the whole roster at once, then render it once
+    gint added = roster_add_all(g_slist_reverse(new_contacts));
+    if (added < count) {
+        log_warning("Ignored %d duplicate roster items", count - added);
+    }
+
     sv_ev_roster_received();
 
     resource_presence_t conn_presence = accounts_get_login_presence(jabber_get_account_name());
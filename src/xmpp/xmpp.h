@@ -74,6 +74,7 @@ typedef struct capabilities_t {
     char *os;
     char *os_version;
     GSList *features;
+    int refcount;
 } Capabilities;
 
 typedef struct disco_item_t {
@@ -140,10 +141,18 @@ void jabber_process_events(int millis);
 const char * jabber_get_fulljid(void);
 const char * jabber_get_domain(void);
 jabber_conn_status_t jabber_get_connection_status(void);
+int jabber_get_socket(void);
+gboolean jabber_has_pending_input(void);
+gboolean jabber_has_pending_output(void);
 char * jabber_get_presence_message(void);
 char* jabber_get_account_name(void);
 GList * jabber_get_available_resources(void);
 
+// record received stanzas to a file, for replaying with the functional tests
+gboolean capture_start(const char * const path);
+void capture_stop(void);
+const char * capture_path(void);
+
 // message functions
 char* message_send_chat(const char * const barejid, const char * const msg);
 char* message_send_chat_otr(const char * const barejid, const char * const msg);
@@ -202,8 +211,10 @@ void iq_room_role_set(const char * const room, const char * const nick, char *ro
 void iq_room_role_list(const char * const room, char *role);
 
 // caps functions
+// returns a shared entry, release with caps_destroy
 Capabilities* caps_lookup(const char * const jid);
 void caps_close(void);
+// drops a reference, the capabilities are freed when the last one goes
 void caps_destroy(Capabilities *caps);
 
 gboolean bookmark_add(const char *jid, const char *nick, const char *password, const char *autojoin_str);
@@ -0,0 +1,139 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "bench.h"
+
+// each benchmark runs for at least this long, growing its iterations until it does
+#define BENCH_MIN_NS 500000000LL
+#define BENCH_MAX_N 1000000000L
+
+static long allocs = 0;
+
+#ifdef __GLIBC__
+// count every allocation, including those made inside glib and ncurses, by interposing the allocator
+extern void *__libc_malloc(size_t size);
+extern void *__libc_calloc(size_t nmemb, size_t size);
+extern void *__libc_realloc(void *ptr, size_t size);
+
+void *
+malloc(size_t size)
+{
+    allocs++;
+    return __libc_malloc(size);
+}
+
+void *
+calloc(size_t nmemb, size_t size)
+{
+    allocs++;
+    return __libc_calloc(nmemb, size);
+}
+
+void *
+realloc(void *ptr, size_t size)
+{
+    allocs++;
+    return __libc_realloc(ptr, size);
+}
+#define ALLOCS_COUNTED 1
+#else
+#define ALLOCS_COUNTED 0
+#endif
+
+static long long
+_now_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (long long)ts.tv_sec * 1000000000LL + ts.tv_nsec;
+}
+
+void
+bench_start_timer(Bench *b)
+{
+    if (!b->timing) {
+        b->start = _now_ns();
+        b->allocs_start = allocs;
+        b->timing = 1;
+    }
+}
+
+void
+bench_stop_timer(Bench *b)
+{
+    if (b->timing) {
+        b->elapsed += _now_ns() - b->start;
+        b->allocs += allocs - b->allocs_start;
+        b->timing = 0;
+    }
+}
+
+void
+bench_reset_timer(Bench *b)
+{
+    b->elapsed = 0;
+    b->allocs = 0;
+    if (b->timing) {
+        b->start = _now_ns();
+        b->allocs_start = allocs;
+    }
+}
+
+static void
+_run(const BenchTest * const benchmark, Bench *b, long n)
+{
+    b->n = n;
+    b->elapsed = 0;
+    b->allocs = 0;
+    b->timing = 0;
+    bench_start_timer(b);
+    benchmark->func(b);
+    bench_stop_timer(b);
+}
+
+int
+run_benchmarks(const BenchTest * const benchmarks, size_t count, const char * const filter)
+{
+    // one line per benchmark, tab separated, so runs can be diffed
+    printf("# name\titerations\tns/op\tallocs/op\n");
+
+    size_t i;
+    for (i = 0; i < count; i++) {
+        const BenchTest *benchmark = &benchmarks[i];
+        if (filter && !strstr(benchmark->name, filter)) {
+            continue;
+        }
+
+        Bench b;
+        long n = 1;
+        _run(benchmark, &b, n);
+        while (b.elapsed < BENCH_MIN_NS && n < BENCH_MAX_N) {
+
+            // aim past the minimum, but never grow more than a hundred fold at once
+            long long per_op = b.elapsed / n;
+            if (per_op < 1) {
+                per_op = 1;
+            }
+            long next = (long)((BENCH_MIN_NS * 6 / 5) / per_op);
+            if (next > n * 100) {
+                next = n * 100;
+            }
+            if (next <= n) {
+                next = n + 1;
+            }
+            n = next;
+            _run(benchmark, &b, n);
+        }
+
+        if (ALLOCS_COUNTED) {
+            printf("%s\t%ld\t%.1f\t%.2f\n", benchmark->name, n, (double)b.elapsed / n, (double)b.allocs / n);
+        } else {
+            printf("%s\t%ld\t%.1f\t-\n", benchmark->name, n, (double)b.elapsed / n);
+        }
+        fflush(stdout);
+    }
+
+    return 0;
+}
@@ -0,0 +1,32 @@
+#ifndef BENCH_H
+#define BENCH_H
+
+#include <stddef.h>
+
+typedef struct bench_t {
+    // iterations the benchmark must run
+    long n;
+    long long start;
+    long long elapsed;
+    long allocs_start;
+    long allocs;
+    int timing;
+} Bench;
+
+typedef void (*bench_func)(Bench *b);
+
+typedef struct bench_test_t {
+    const char *name;
+    bench_func func;
+} BenchTest;
+
+#define bench_test(f) { #f, f }
+
+// exclude setup from the measurement
+void bench_reset_timer(Bench *b);
+void bench_start_timer(Bench *b);
+void bench_stop_timer(Bench *b);
+
+int run_benchmarks(const BenchTest * const benchmarks, size_t count, const char * const filter);
+
+#endif
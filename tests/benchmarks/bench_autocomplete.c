@@ -0,0 +1,84 @@
+#include <glib.h>
+#include <stdlib.h>
+
+#include "bench.h"
+#include "tools/autocomplete.h"
+
+// the same pseudo random names every run, so results can be compared
+static gchar **
+_names(int count)
+{
+    gchar **names = malloc(sizeof(gchar *) * (count + 1));
+    guint32 seed = 12345;
+    int i;
+    for (i = 0; i < count; i++) {
+        seed = seed * 1103515245 + 12345;
+        names[i] = g_strdup_printf("user%08x@example.org", seed);
+    }
+    names[count] = NULL;
+
+    return names;
+}
+
+static void
+_bench_add(Bench *b, int count)
+{
+    gchar **names = _names(count);
+    bench_reset_timer(b);
+
+    long i;
+    for (i = 0; i < b->n; i++) {
+        Autocomplete ac = autocomplete_new();
+        int j;
+        for (j = 0; j < count; j++) {
+            autocomplete_add(ac, names[j]);
+        }
+        autocomplete_free(ac);
+    }
+
+    bench_stop_timer(b);
+    g_strfreev(names);
+}
+
+static void
+_bench_complete(Bench *b, int count)
+{
+    gchar **names = _names(count);
+    Autocomplete ac = autocomplete_new();
+    int i;
+    for (i = 0; i < count; i++) {
+        autocomplete_add(ac, names[i]);
+    }
+    bench_reset_timer(b);
+
+    long j;
+    for (j = 0; j < b->n; j++) {
+        char *result = autocomplete_complete(ac, "user7", FALSE);
+        free(result);
+        autocomplete_reset(ac);
+    }
+
+    bench_stop_timer(b);
+    autocomplete_free(ac);
+    g_strfreev(names);
+}
+
+void bench_autocomplete_add_10k(Bench *b)
+{
+    _bench_add(b, 10000);
+}
+
+void bench_autocomplete_add_100k(Bench *b)
+{
+    _bench_add(b, 100000);
+}
+
+void bench_autocomplete_complete_10k(Bench *b)
+{
+    _bench_complete(b, 10000);
+}
+
+void bench_autocomplete_complete_100k(Bench *b)
+{
+    _bench_complete(b, 100000);
+}
@@ -0,0 +1,4 @@
+void bench_autocomplete_add_10k(Bench *b);
+void bench_autocomplete_add_100k(Bench *b);
+void bench_autocomplete_complete_10k(Bench *b);
+void bench_autocomplete_complete_100k(Bench *b);
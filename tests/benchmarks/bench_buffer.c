@@ -0,0 +1,49 @@
+#include <glib.h>
+#include <stdlib.h>
+
+#include "bench.h"
+#include "ui/buffer.h"
+
+#define BENCH_MESSAGE "Are we still on for the release tomorrow? The build from last night looks good to me."
+
+void bench_buffer_push(Bench *b)
+{
+    ProfBuff buffer = buffer_create();
+    GDateTime *now = g_date_time_new_now_local();
+    bench_reset_timer(b);
+
+    // the buffer fills after BUFF_SIZE entries, after which each push also drops the oldest
+    long i;
+    for (i = 0; i < b->n; i++) {
+        buffer_push(buffer, '-', 0, now, 0, 0, "bob", BENCH_MESSAGE, NULL);
+    }
+
+    bench_stop_timer(b);
+    g_date_time_unref(now);
+    buffer_free(buffer);
+}
+
+void bench_buffer_yield_entry(Bench *b)
+{
+    ProfBuff buffer = buffer_create();
+    GDateTime *now = g_date_time_new_now_local();
+    int i;
+    for (i = 0; i < BUFF_SIZE; i++) {
+        buffer_push(buffer, '-', 0, now, 0, 0, "bob", BENCH_MESSAGE, NULL);
+    }
+    bench_reset_timer(b);
+
+    long j;
+    int total = 0;
+    for (j = 0; j < b->n; j++) {
+        ProfBuffEntry *entry = buffer_yield_entry(buffer, j % BUFF_SIZE);
+        total += entry->pad_indent;
+    }
+
+    bench_stop_timer(b);
+    g_date_time_unref(now);
+    buffer_free(buffer);
+    if (total != 0) {
+        abort();
+    }
+}
@@ -0,0 +1,2 @@
+void bench_buffer_push(Bench *b);
+void bench_buffer_yield_entry(Bench *b);
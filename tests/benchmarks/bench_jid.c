@@ -0,0 +1,21 @@
+#include <glib.h>
+#include <stdlib.h>
+
+#include "bench.h"
+#include "jid.h"
+
+static const char * const jids[] = {
+    "romeo@montague.example/orchard",
+    "room@conference.example.org/a nick with spaces",
+    "juliet@capulet.example",
+    "example.org"
+};
+
+void bench_jid_create(Bench *b)
+{
+    long i;
+    for (i = 0; i < b->n; i++) {
+        Jid *jid = jid_create(jids[i % 4]);
+        jid_destroy(jid);
+    }
+}
@@ -0,0 +1 @@
+void bench_jid_create(Bench *b);
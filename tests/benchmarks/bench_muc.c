@@ -0,0 +1,30 @@
+#include <glib.h>
+#include <stdlib.h>
+
+#include "bench.h"
+#include "muc.h"
+
+#define BENCH_ROOM "room@conference.example.org"
+#define BENCH_OCCUPANTS 500
+
+void bench_muc_roster(Bench *b)
+{
+    muc_init();
+    muc_join(BENCH_ROOM, "me", NULL, FALSE);
+    int i;
+    for (i = 0; i < BENCH_OCCUPANTS; i++) {
+        char *nick = g_strdup_printf("nick%03d", (i * 7) % BENCH_OCCUPANTS);
+        muc_roster_add(BENCH_ROOM, nick, NULL, "participant", "none", i % 2 ? "away" : NULL, NULL);
+        g_free(nick);
+    }
+    bench_reset_timer(b);
+
+    long j;
+    for (j = 0; j < b->n; j++) {
+        GList *occupants = muc_roster(BENCH_ROOM);
+        g_list_free(occupants);
+    }
+
+    bench_stop_timer(b);
+    muc_close();
+}
@@ -0,0 +1 @@
+void bench_muc_roster(Bench *b);
@@ -0,0 +1,25 @@
+#include <glib.h>
+#include <stdlib.h>
+
+#include "bench.h"
+#include "tools/parser.h"
+
+void bench_parse_args(Bench *b)
+{
+    long i;
+    for (i = 0; i < b->n; i++) {
+        gboolean result = FALSE;
+        gchar **args = parse_args("/join room@conference.example.org nick \"a nick\" password secret", 1, 5, &result);
+        g_strfreev(args);
+    }
+}
+
+void bench_parse_args_with_freetext(Bench *b)
+{
+    long i;
+    for (i = 0; i < b->n; i++) {
+        gboolean result = FALSE;
+        gchar **args = parse_args_with_freetext("/msg \"Bob Smith\" are we still on for the release tomorrow?", 1, 2, &result);
+        g_strfreev(args);
+    }
+}
@@ -0,0 +1,2 @@
+void bench_parse_args(Bench *b);
+void bench_parse_args_with_freetext(Bench *b);
@@ -0,0 +1,115 @@
+#include <glib.h>
+#include <stdlib.h>
+
+#include "bench.h"
+#include "contact.h"
+#include "resource.h"
+#include "roster_list.h"
+
+#define BENCH_CONTACTS 2000
+
+static void
+_roster_fill(void)
+{
+    roster_init();
+    int i;
+    for (i = 0; i < BENCH_CONTACTS; i++) {
+        char *barejid = g_strdup_printf("contact%04d@example.org", i);
+        char *name = g_strdup_printf("Contact %04d", BENCH_CONTACTS - i);
+        roster_add(barejid, name, NULL, "both", FALSE);
+
+        // a third online, a third away, the rest offline
+        if (i % 3 == 0) {
+            roster_update_presence(barejid, resource_new("laptop", RESOURCE_ONLINE, NULL, 0), NULL);
+        } else if (i % 3 == 1) {
+            roster_update_presence(barejid, resource_new("phone", RESOURCE_AWAY, "out", 0), NULL);
+        }
+        g_free(barejid);
+        g_free(name);
+    }
+}
+
+void bench_roster_get_contacts(Bench *b)
+{
+    _roster_fill();
+    bench_reset_timer(b);
+
+    long i;
+    for (i = 0; i < b->n; i++) {
+        GSList *contacts = roster_get_contacts();
+        g_slist_free(contacts);
+    }
+
+    bench_stop_timer(b);
+    roster_free();
+}
+
+void bench_roster_get_contacts_online(Bench *b)
+{
+    _roster_fill();
+    bench_reset_timer(b);
+
+    long i;
+    for (i = 0; i < b->n; i++) {
+        GSList *contacts = roster_get_contacts_online();
+        g_slist_free(contacts);
+    }
+
+    bench_stop_timer(b);
+    roster_free();
+}
+
+void bench_roster_get_contacts_by_presence(Bench *b)
+{
+    _roster_fill();
+    bench_reset_timer(b);
+
+    long i;
+    for (i = 0; i < b->n; i++) {
+        GSList *contacts = roster_get_contacts_by_presence("away");
+        g_slist_free(contacts);
+    }
+
+    bench_stop_timer(b);
+    roster_free();
+}
+
+void bench_roster_add(Bench *b)
+{
+    long i;
+    for (i = 0; i < b->n; i++) {
+        roster_init();
+        int j;
+        for (j = 0; j < BENCH_CONTACTS; j++) {
+            char *barejid = g_strdup_printf("contact%04d@example.org", j);
+            char *name = g_strdup_printf("Contact %04d", BENCH_CONTACTS - j);
+            roster_add(barejid, name, NULL, "both", FALSE);
+            g_free(barejid);
+            g_free(name);
+        }
+        bench_stop_timer(b);
+        roster_free();
+        bench_start_timer(b);
+    }
+}
+
+void bench_roster_add_all(Bench *b)
+{
+    long i;
+    for (i = 0; i < b->n; i++) {
+        roster_init();
+        GSList *contacts = NULL;
+        int j;
+        for (j = 0; j < BENCH_CONTACTS; j++) {
+            char *barejid = g_strdup_printf("contact%04d@example.org", j);
+            char *name = g_strdup_printf("Contact %04d", BENCH_CONTACTS - j);
+            contacts = g_slist_prepend(contacts, p_contact_new(barejid, name, NULL, "both", NULL, FALSE));
+            g_free(barejid);
+            g_free(name);
+        }
+        roster_add_all(g_slist_reverse(contacts));
+        bench_stop_timer(b);
+        roster_free();
+        bench_start_timer(b);
+    }
+}
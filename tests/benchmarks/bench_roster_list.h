@@ -0,0 +1,5 @@
+void bench_roster_get_contacts(Bench *b);
+void bench_roster_get_contacts_online(Bench *b);
+void bench_roster_get_contacts_by_presence(Bench *b);
+void bench_roster_add(Bench *b);
+void bench_roster_add_all(Bench *b);
@@ -0,0 +1,116 @@
+#include "config.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <locale.h>
+
+#include <glib.h>
+#ifdef HAVE_NCURSESW_NCURSES_H
+#include <ncursesw/ncurses.h>
+#elif HAVE_NCURSES_H
+#include <ncurses.h>
+#endif
+
+#include "bench.h"
+#include "ui/buffer.h"
+
+#define BENCH_COLS 80
+#define BENCH_INDENT 11
+
+static const char * const message =
+    "Has anyone looked at the reconnect bug yet? After a suspend the client keeps the old socket "
+    "and only notices after the ping timeout, which is 5 minutes by default. 日本語のテキストも "
+    "wraps differently because every character takes two columns, see "
+    "https://example.org/a/very/long/url/that/cannot/be/broken/at/a/space/and/has/to/be/split/anywhere";
+
+static SCREEN *screen = NULL;
+static WINDOW *pad = NULL;
+
+static gboolean
+_pad_init(void)
+{
+    if (!pad) {
+        setlocale(LC_ALL, "");
+        FILE *out = fopen("/dev/null", "w");
+        screen = newterm(NULL, out, stdin);
+        if (!screen) {
+            return FALSE;
+        }
+        pad = newpad(1000, BENCH_COLS);
+        scrollok(pad, TRUE);
+    }
+
+    return TRUE;
+}
+
+// what the window prints for a wrapped message, emitting each segment of the layout
+static void
+_print_wrapped(ProfBuffEntry *entry, int width)
+{
+    ProfBuffLayout *layout = buffer_entry_layout(entry, 0, BENCH_INDENT + 5, BENCH_INDENT, width);
+
+    int i;
+    for (i = 0; i < layout->segments->len; i++) {
+        ProfBuffSegment *segment = &g_array_index(layout->segments, ProfBuffSegment, i);
+        if (segment->newline) {
+            waddch(pad, '\n');
+        }
+        int j;
+        for (j = 0; j < segment->indent; j++) {
+            waddch(pad, ' ');
+        }
+        if (segment->len > 0) {
+            waddnstr(pad, entry->message + segment->offset, segment->len);
+        }
+    }
+    waddch(pad, '\n');
+}
+
+static void
+_bench_print_wrapped(Bench *b, gboolean resize)
+{
+    if (!_pad_init()) {
+        fprintf(stderr, "no terminal, skipping\n");
+        return;
+    }
+
+    ProfBuff buffer = buffer_create();
+    GDateTime *now = g_date_time_new_now_local();
+    buffer_push(buffer, '-', 0, now, 0, 0, "bob", message, NULL);
+    ProfBuffEntry *entry = buffer_yield_entry(buffer, 0);
+    bench_reset_timer(b);
+
+    long i;
+    for (i = 0; i < b->n; i++) {
+        werase(pad);
+        wmove(pad, 0, BENCH_INDENT + 5);
+
+        // a changing width forces the layout to be worked out again, as after a resize
+        _print_wrapped(entry, (resize && (i % 2)) ? BENCH_COLS - 1 : BENCH_COLS);
+    }
+
+    bench_stop_timer(b);
+    g_date_time_unref(now);
+    buffer_free(buffer);
+}
+
+void bench_win_print_wrapped(Bench *b)
+{
+    _bench_print_wrapped(b, FALSE);
+}
+
+void bench_win_print_wrapped_resize(Bench *b)
+{
+    _bench_print_wrapped(b, TRUE);
+}
+
+void bench_window_close(void)
+{
+    if (pad) {
+        delwin(pad);
+        pad = NULL;
+        endwin();
+        delscreen(screen);
+        screen = NULL;
+    }
+}
@@ -0,0 +1,3 @@
+void bench_win_print_wrapped(Bench *b);
+void bench_win_print_wrapped_resize(Bench *b);
+void bench_window_close(void);
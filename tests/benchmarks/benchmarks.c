@@ -0,0 +1,49 @@
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "config.h"
+
+#include "bench.h"
+#include "bench_autocomplete.h"
+#include "bench_buffer.h"
+#include "bench_jid.h"
+#include "bench_muc.h"
+#include "bench_parser.h"
+#include "bench_roster_list.h"
+#include "bench_window.h"
+
+int main(int argc, char* argv[]) {
+    // glib allocations go through malloc so they are counted
+    setenv("G_SLICE", "always-malloc", 1);
+
+    const BenchTest all_benchmarks[] = {
+        bench_test(bench_buffer_push),
+        bench_test(bench_buffer_yield_entry),
+        bench_test(bench_win_print_wrapped),
+        bench_test(bench_win_print_wrapped_resize),
+        bench_test(bench_autocomplete_add_10k),
+        bench_test(bench_autocomplete_add_100k),
+        bench_test(bench_autocomplete_complete_10k),
+        bench_test(bench_autocomplete_complete_100k),
+        bench_test(bench_jid_create),
+        bench_test(bench_parse_args),
+        bench_test(bench_parse_args_with_freetext),
+        bench_test(bench_roster_get_contacts),
+        bench_test(bench_roster_get_contacts_online),
+        bench_test(bench_roster_get_contacts_by_presence),
+        bench_test(bench_roster_add),
+        bench_test(bench_roster_add_all),
+        bench_test(bench_muc_roster),
+    };
+
+    // an optional argument only runs the benchmarks whose names contain it
+    const char *filter = NULL;
+    if (argc > 1) {
+        filter = argv[1];
+    }
+
+    int result = run_benchmarks(all_benchmarks, sizeof(all_benchmarks) / sizeof(all_benchmarks[0]), filter);
+    bench_window_close();
+
+    return result;
+}
@@ -20,6 +20,8 @@
 #include "test_receipts.h"
 #include "test_roster.h"
 #include "test_software.h"
+#include "test_load.h"
+#include "test_replay.h"
 
 #define PROF_FUNC_TEST(test) unit_test_setup_teardown(test, init_prof_test, close_prof_test)
 
@@ -82,6 +84,13 @@ int main(int argc, char* argv[]) {
         PROF_FUNC_TEST(display_software_version_result_when_from_domainpart),
         PROF_FUNC_TEST(show_message_in_chat_window_when_no_resource),
         PROF_FUNC_TEST(display_software_version_result_in_chat),
+
+        PROF_FUNC_TEST(load_large_roster_presence_burst),
+        PROF_FUNC_TEST(load_large_room_join_with_history),
+        PROF_FUNC_TEST(load_sustained_groupchat),
+        PROF_FUNC_TEST(load_offline_messages_on_login),
+
+        PROF_FUNC_TEST(replay_recorded_session),
     };
 
     return run_tests(all_tests);
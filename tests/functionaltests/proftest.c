@@ -21,6 +21,9 @@ char *data_orig;
 
 int fd = 0;
 
+gint64 load_start_us = 0;
+long load_start_cpu_ms = 0;
+
 gboolean
 _create_dir(char *name)
 {
@@ -252,3 +255,120 @@ prof_connect(void)
         "<item jid=\"buddy2@localhost\" subscription=\"both\" name=\"Buddy2\"/>"
     );
 }
+
+// the spawning shells exec profanity, fall back to their first child if one did not
+static pid_t
+_prof_pid(void)
+{
+    pid_t pid = exp_pid;
+    char *path = g_strdup_printf("/proc/%d/comm", pid);
+    gchar *comm = NULL;
+    if (g_file_get_contents(path, &comm, NULL, NULL) && !g_str_has_prefix(comm, "profanity")) {
+        g_free(path);
+        path = g_strdup_printf("/proc/%d/task/%d/children", pid, pid);
+        gchar *children = NULL;
+        if (g_file_get_contents(path, &children, NULL, NULL)) {
+            pid = atoi(children);
+            g_free(children);
+        }
+    }
+    g_free(comm);
+    g_free(path);
+
+    return pid;
+}
+
+// user plus system time, or -1 when /proc is not available
+static long
+_prof_cpu_ms(void)
+{
+    char *path = g_strdup_printf("/proc/%d/stat", _prof_pid());
+    gchar *stat = NULL;
+    long result = -1;
+    if (g_file_get_contents(path, &stat, NULL, NULL)) {
+        // fields after the command name, which may contain spaces
+        char *fields = strrchr(stat, ')');
+        unsigned long utime = 0;
+        unsigned long stime = 0;
+        if (fields && sscanf(fields + 2, "%*c %*d %*d %*d %*d %*d %*u %*u %*u %*u %*u %lu %lu", &utime, &stime) == 2) {
+            result = (utime + stime) * 1000 / sysconf(_SC_CLK_TCK);
+        }
+        g_free(stat);
+    }
+    g_free(path);
+
+    return result;
+}
+
+// high water mark of the resident set, or -1 when /proc is not available
+static long
+_prof_peak_rss_kb(void)
+{
+    char *path = g_strdup_printf("/proc/%d/status", _prof_pid());
+    gchar *status = NULL;
+    long result = -1;
+    if (g_file_get_contents(path, &status, NULL, NULL)) {
+        char *hwm = strstr(status, "VmHWM:");
+        if (hwm) {
+            result = strtol(hwm + strlen("VmHWM:"), NULL, 10);
+        }
+        g_free(status);
+    }
+    g_free(path);
+
+    return result;
+}
+
+void
+prof_load_start(void)
+{
+    load_start_us = g_get_monotonic_time();
+    load_start_cpu_ms = _prof_cpu_ms();
+}
+
+int
+prof_load_quiescent(char *scenario, char *marker, ProfLoadLimits limits)
+{
+    // the marker is sent after the load, once it is drawn everything before it has been handled
+    exp_timeout = limits.wall_ms / 1000 + 1;
+    int seen = prof_output_exact(marker);
+    exp_timeout = 10;
+
+    if (!seen) {
+        printf("%s: marker not displayed after %d ms\n", scenario, limits.wall_ms);
+    }
+    int result = prof_load_report(scenario, limits);
+
+    return seen && result;
+}
+
+// print wall time since prof_load_start, peak RSS and CPU time, and check them against limits
+int
+prof_load_report(char *scenario, ProfLoadLimits limits)
+{
+    long wall_ms = (g_get_monotonic_time() - load_start_us) / 1000;
+    long cpu_ms = _prof_cpu_ms();
+    if (cpu_ms != -1 && load_start_cpu_ms != -1) {
+        cpu_ms -= load_start_cpu_ms;
+    }
+    long peak_rss_kb = _prof_peak_rss_kb();
+
+    printf("# scenario\twall_ms\tpeak_rss_kb\tcpu_ms\n");
+    printf("%s\t%ld\t%ld\t%ld\n", scenario, wall_ms, peak_rss_kb, cpu_ms);
+
+    int result = 1;
+    if (wall_ms > limits.wall_ms) {
+        printf("%s: wall time %ld ms, limit %d ms\n", scenario, wall_ms, limits.wall_ms);
+        result = 0;
+    }
+    if (peak_rss_kb > limits.peak_rss_kb) {
+        printf("%s: peak RSS %ld kB, limit %ld kB\n", scenario, peak_rss_kb, limits.peak_rss_kb);
+        result = 0;
+    }
+    if (cpu_ms > limits.cpu_ms) {
+        printf("%s: CPU time %ld ms, limit %d ms\n", scenario, cpu_ms, limits.cpu_ms);
+        result = 0;
+    }
+
+    return result;
+}
@@ -15,4 +15,14 @@ void prof_input(char *input);
 int prof_output_exact(char *text);
 int prof_output_regex(char *text);
 
+typedef struct prof_load_limits_t {
+    int wall_ms;
+    long peak_rss_kb;
+    int cpu_ms;
+} ProfLoadLimits;
+
+void prof_load_start(void);
+int prof_load_quiescent(char *scenario, char *marker, ProfLoadLimits limits);
+int prof_load_report(char *scenario, ProfLoadLimits limits);
+
 #endif
@@ -1,2 +1,2 @@
 export COLUMNS=300
-./profanity -l DEBUG
+exec ./profanity -l DEBUG
@@ -0,0 +1,207 @@
+#include <glib.h>
+#include <stdarg.h>
+#include <stddef.h>
+#include <setjmp.h>
+#include <cmocka.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <stabber.h>
+#include <expect.h>
+
+#include "proftest.h"
+
+#define LOAD_ROOM "loadroom@conference.localhost"
+
+// stanzas are sent in batches rather than one write each
+#define LOAD_BATCH 100
+
+static void
+_send_batch(GString *batch, int count)
+{
+    if (batch->len > 0 && (count % LOAD_BATCH == 0)) {
+        stbbr_send(batch->str);
+        g_string_truncate(batch, 0);
+    }
+}
+
+static void
+_send_rest(GString *batch)
+{
+    if (batch->len > 0) {
+        stbbr_send(batch->str);
+    }
+    g_string_free(batch, TRUE);
+}
+
+static void
+_send_chat_marker(void)
+{
+    stbbr_send(
+        "<message id=\"loadmarker\" to=\"stabber@localhost\" from=\"loadmarker@localhost/done\" type=\"chat\">"
+            "<body>done</body>"
+        "</message>"
+    );
+}
+
+static void
+_send_room_marker(void)
+{
+    stbbr_send(
+        "<message id=\"loadmarker\" to=\"stabber@localhost/profanity\" from=\"" LOAD_ROOM "/loadmarker\" type=\"groupchat\">"
+            "<body>room load complete</body>"
+        "</message>"
+    );
+}
+
+static void
+_join_room(int occupants)
+{
+    prof_input("/join " LOAD_ROOM);
+
+    GString *batch = g_string_new("");
+    int i;
+    for (i = 1; i <= occupants; i++) {
+        g_string_append_printf(batch,
+            "<presence to=\"stabber@localhost/profanity\" from=\"" LOAD_ROOM "/occupant%d\">"
+                "<x xmlns=\"http://jabber.org/protocol/muc#user\">"
+                    "<item affiliation=\"none\" role=\"participant\"/>"
+                "</x>"
+            "</presence>", i);
+        _send_batch(batch, i);
+    }
+    g_string_append(batch,
+        "<presence to=\"stabber@localhost/profanity\" from=\"" LOAD_ROOM "/stabber\">"
+            "<x xmlns=\"http://jabber.org/protocol/muc#user\">"
+                "<item affiliation=\"none\" role=\"participant\"/>"
+                "<status code=\"110\"/>"
+            "</x>"
+        "</presence>"
+    );
+    _send_rest(batch);
+}
+
+void
+load_large_roster_presence_burst(void **state)
+{
+    prof_load_start();
+
+    GString *roster = g_string_new("");
+    int i;
+    for (i = 1; i <= 5000; i++) {
+        g_string_append_printf(roster,
+            "<item jid=\"contact%d@localhost\" subscription=\"both\" name=\"Contact %d\"/>", i, i);
+    }
+    prof_connect_with_roster(roster->str);
+    g_string_free(roster, TRUE);
+
+    GString *batch = g_string_new("");
+    for (i = 1; i <= 5000; i++) {
+        g_string_append_printf(batch,
+            "<presence to=\"stabber@localhost\" from=\"contact%d@localhost/laptop\">"
+                "<show>%s</show>"
+                "<status>status %d</status>"
+                "<priority>%d</priority>"
+            "</presence>", i, i % 2 ? "away" : "chat", i, i % 10);
+        _send_batch(batch, i);
+    }
+    _send_rest(batch);
+    _send_chat_marker();
+
+    ProfLoadLimits limits = { 30000, 150000, 20000 };
+    assert_true(prof_load_quiescent("large_roster_presence_burst", "<< incoming from loadmarker@localhost/done", limits));
+}
+
+void
+load_large_room_join_with_history(void **state)
+{
+    prof_connect();
+
+    prof_load_start();
+    _join_room(2000);
+
+    GString *batch = g_string_new("");
+    int i;
+    for (i = 1; i <= 500; i++) {
+        g_string_append_printf(batch,
+            "<message type=\"groupchat\" to=\"stabber@localhost/profanity\" from=\"" LOAD_ROOM "/occupant%d\">"
+                "<body>history message %d from before the join</body>"
+                "<delay xmlns=\"urn:xmpp:delay\" stamp=\"2015-06-01T12:%02d:%02dZ\" from=\"" LOAD_ROOM "\"/>"
+            "</message>", i % 2000 + 1, i, (i / 60) % 60, i % 60);
+        _send_batch(batch, i);
+    }
+    _send_rest(batch);
+    _send_room_marker();
+
+    ProfLoadLimits limits = { 20000, 100000, 15000 };
+    assert_true(prof_load_quiescent("large_room_join_with_history", "room load complete", limits));
+}
+
+void
+load_sustained_groupchat(void **state)
+{
+    prof_connect();
+    _join_room(50);
+    assert_true(prof_output_exact("-> You have joined the room as stabber"));
+
+    prof_load_start();
+
+    // 200 messages a second for 10 seconds, as 10 messages every 50ms
+    gint64 next = g_get_monotonic_time();
+    int sent = 0;
+    GString *batch = g_string_new("");
+    while (sent < 2000) {
+        int i;
+        for (i = 0; i < 10; i++) {
+            sent++;
+            g_string_append_printf(batch,
+                "<message type=\"groupchat\" to=\"stabber@localhost/profanity\" from=\"" LOAD_ROOM "/occupant%d\">"
+                    "<body>live message %d</body>"
+                "</message>", sent % 50 + 1, sent);
+        }
+        stbbr_send(batch->str);
+        g_string_truncate(batch, 0);
+
+        next += 50000;
+        gint64 now = g_get_monotonic_time();
+        if (next > now) {
+            g_usleep(next - now);
+        }
+    }
+    g_string_free(batch, TRUE);
+    _send_room_marker();
+
+    // keeping up means finishing soon after the last send, with CPU to spare
+    ProfLoadLimits limits = { 13000, 80000, 8000 };
+    assert_true(prof_load_quiescent("sustained_groupchat", "room load complete", limits));
+}
+
+void
+load_offline_messages_on_login(void **state)
+{
+    GString *roster = g_string_new("");
+    int i;
+    for (i = 1; i <= 50; i++) {
+        g_string_append_printf(roster,
+            "<item jid=\"friend%d@localhost\" subscription=\"both\" name=\"Friend %d\"/>", i, i);
+    }
+
+    prof_load_start();
+    prof_connect_with_roster(roster->str);
+    g_string_free(roster, TRUE);
+
+    GString *batch = g_string_new("");
+    for (i = 1; i <= 1000; i++) {
+        g_string_append_printf(batch,
+            "<message type=\"chat\" to=\"stabber@localhost\" from=\"friend%d@localhost/phone\">"
+                "<body>offline message %d</body>"
+                "<delay xmlns=\"urn:xmpp:delay\" stamp=\"2015-06-01T%02d:%02d:00Z\" from=\"localhost\">Offline Storage</delay>"
+            "</message>", i % 50 + 1, i, (i / 60) % 24, i % 60);
+        _send_batch(batch, i);
+    }
+    _send_rest(batch);
+    _send_chat_marker();
+
+    ProfLoadLimits limits = { 15000, 80000, 10000 };
+    assert_true(prof_load_quiescent("offline_messages_on_login", "<< incoming from loadmarker@localhost/done", limits));
+}
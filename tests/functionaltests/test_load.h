@@ -0,0 +1,4 @@
+void load_large_roster_presence_burst(void **state);
+void load_large_room_join_with_history(void **state);
+void load_sustained_groupchat(void **state);
+void load_offline_messages_on_login(void **state);
@@ -0,0 +1,197 @@
+#include <glib.h>
+#include <stdarg.h>
+#include <stddef.h>
+#include <setjmp.h>
+#include <cmocka.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <stabber.h>
+#include <expect.h>
+
+#include "proftest.h"
+
+// written by /capture, see src/xmpp/capture.h
+#define REPLAY_HEADER "profanity-capture 1\n"
+#define REPLAY_PERF_FILE XDG_DATA_HOME "/replay_perf.tsv"
+#define REPLAY_BATCH 100
+
+static GPtrArray *
+_replay_load(const char * const path, gint64 *duration)
+{
+    gchar *contents = NULL;
+    gsize size = 0;
+    if (!g_file_get_contents(path, &contents, &size, NULL)) {
+        return NULL;
+    }
+    if (!g_str_has_prefix(contents, REPLAY_HEADER)) {
+        g_free(contents);
+        return NULL;
+    }
+
+    GPtrArray *stanzas = g_ptr_array_new_with_free_func(g_free);
+    char *pos = contents + strlen(REPLAY_HEADER);
+    char *end = contents + size;
+    while (pos < end) {
+        gint64 offset = 0;
+        gsize len = 0;
+        int header_len = 0;
+        if (sscanf(pos, "%" G_GINT64_FORMAT " %" G_GSIZE_FORMAT "\n%n", &offset, &len, &header_len) != 2 ||
+                header_len == 0 || pos + header_len + len > end) {
+            break;
+        }
+        pos += header_len;
+        g_ptr_array_add(stanzas, g_strndup(pos, len));
+        pos += len + 1;
+        *duration = offset;
+    }
+    g_free(contents);
+
+    return stanzas;
+}
+
+// the items of the first roster result, so presences are from known contacts
+static char *
+_replay_roster(GPtrArray *stanzas)
+{
+    guint i;
+    for (i = 0; i < stanzas->len; i++) {
+        char *stanza = g_ptr_array_index(stanzas, i);
+        if (!g_str_has_prefix(stanza, "<iq") || !strstr(stanza, "type=\"result\"")) {
+            continue;
+        }
+        char *query = strstr(stanza, "<query xmlns=\"jabber:iq:roster\"");
+        if (!query) {
+            continue;
+        }
+        char *items = strchr(query, '>');
+        char *items_end = strstr(query, "</query>");
+        if (items && items_end && items[-1] != '/') {
+            return g_strndup(items + 1, items_end - items - 1);
+        }
+    }
+
+    return g_strdup("");
+}
+
+// join each room we were in, the recorded self presence then completes the join
+static void
+_replay_join_rooms(GPtrArray *stanzas)
+{
+    GHashTable *rooms = g_hash_table_new_full(g_str_hash, g_str_equal, g_free, NULL);
+    guint i;
+    for (i = 0; i < stanzas->len; i++) {
+        char *stanza = g_ptr_array_index(stanzas, i);
+        if (!g_str_has_prefix(stanza, "<presence") || !strstr(stanza, "code=\"110\"") ||
+                strstr(stanza, "type=\"unavailable\"")) {
+            continue;
+        }
+        char *from = strstr(stanza, "from=\"");
+        if (!from) {
+            continue;
+        }
+        from += strlen("from=\"");
+        char *from_end = strchr(from, '"');
+        char *slash = strchr(from, '/');
+        if (!from_end || !slash || slash > from_end) {
+            continue;
+        }
+        gchar *room = g_strndup(from, slash - from);
+        if (g_hash_table_lookup(rooms, room)) {
+            g_free(room);
+            continue;
+        }
+        gchar *nick = g_strndup(slash + 1, from_end - slash - 1);
+        gchar *join = g_strdup_printf("/join %s nick \"%s\"", room, nick);
+        prof_input(join);
+        g_free(join);
+        g_free(nick);
+        g_hash_table_insert(rooms, room, room);
+    }
+    g_hash_table_destroy(rooms);
+}
+
+static int
+_replay_limit(const char * const name, int fallback)
+{
+    char *value = getenv(name);
+    return value ? atoi(value) : fallback;
+}
+
+void
+replay_recorded_session(void **state)
+{
+    char *path = getenv("PROF_REPLAY_FILE");
+    if (!path) {
+        printf("PROF_REPLAY_FILE not set, nothing to replay\n");
+        return;
+    }
+
+    gint64 recorded_us = 0;
+    GPtrArray *stanzas = _replay_load(path, &recorded_us);
+    assert_true(stanzas != NULL);
+
+    char *roster = _replay_roster(stanzas);
+    prof_connect_with_roster(roster);
+    g_free(roster);
+    _replay_join_rooms(stanzas);
+
+    prof_input("/perf on");
+    assert_true(prof_output_exact("Profiling enabled."));
+
+    ProfLoadLimits limits = {
+        _replay_limit("PROF_REPLAY_WALL_MS", 300000),
+        _replay_limit("PROF_REPLAY_RSS_KB", 1000000),
+        _replay_limit("PROF_REPLAY_CPU_MS", 300000)
+    };
+
+    // full speed, the recorded times are only reported
+    prof_load_start();
+    GString *batch = g_string_new("");
+    guint i;
+    for (i = 0; i < stanzas->len; i++) {
+        g_string_append(batch, g_ptr_array_index(stanzas, i));
+        if ((i + 1) % REPLAY_BATCH == 0) {
+            stbbr_send(batch->str);
+            g_string_truncate(batch, 0);
+        }
+    }
+    g_string_append(batch,
+        "<iq id=\"replaydone\" type=\"get\" to=\"stabber@localhost/profanity\" from=\"localhost\">"
+            "<ping xmlns=\"urn:xmpp:ping\"/>"
+        "</iq>"
+    );
+    stbbr_send(batch->str);
+    g_string_free(batch, TRUE);
+
+    // stanzas are handled in order, so the ping reply means the recording has been processed
+    gint64 deadline = g_get_monotonic_time() + (gint64)limits.wall_ms * 1000;
+    int done = 0;
+    while (!done && g_get_monotonic_time() < deadline) {
+        done = stbbr_received(
+            "<iq id=\"replaydone\" type=\"result\" from=\"stabber@localhost/profanity\" to=\"localhost\"/>"
+        );
+        if (!done) {
+            g_usleep(10000);
+        }
+    }
+    int result = prof_load_report("replay", limits);
+    printf("%u stanzas recorded over %.1f s\n", stanzas->len, recorded_us / 1000000.0);
+    g_ptr_array_free(stanzas, TRUE);
+
+    // per handler latency, written by /perf
+    prof_input("/perf dump " REPLAY_PERF_FILE);
+    gchar *perf = NULL;
+    int tries;
+    for (tries = 0; tries < 100 && !g_file_get_contents(REPLAY_PERF_FILE, &perf, NULL, NULL); tries++) {
+        g_usleep(50000);
+    }
+    if (perf) {
+        printf("%s", perf);
+        g_free(perf);
+    }
+
+    assert_true(done);
+    assert_true(result);
+}
@@ -0,0 +1 @@
+void replay_recorded_session(void **state);
@@ -32,6 +32,7 @@ log_level_t log_get_filter(void)
     return (log_level_t)mock();
 }
 void log_reinit(void) {}
+void log_update_rotate(void) {}
 void log_close(void) {}
 void log_debug(const char * const msg, ...) {}
 void log_info(const char * const msg, ...) {}
@@ -64,12 +65,9 @@ void chat_log_msg_in_delayed(const char * const barejid, const char * msg, GDate
 void chat_log_otr_msg_in(const char * const barejid, const char * const msg, gboolean was_decrypted) {}
 void chat_log_pgp_msg_in(const char * const barejid, const char * const msg) {}
 
+void chat_log_flush(void) {}
+void chat_log_flush_all(void) {}
 void chat_log_close(void) {}
-GSList * chat_log_get_previous(const gchar * const login,
-    const gchar * const recipient)
-{
-    return mock_ptr_type(GSList *);
-}
 
 void groupchat_log_init(void) {}
 void groupchat_log_chat(const gchar * const login, const gchar * const room,
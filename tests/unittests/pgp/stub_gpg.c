@@ -37,10 +37,9 @@ gboolean p_gpg_available(const char * const barejid)
 {
     return FALSE;
 }
-char * p_gpg_decrypt(const char * const cipher)
-{
-    return NULL;
-}
+void p_gpg_decrypt_async(const char * const cipher, p_gpg_decrypt_callback callback, void *userdata,
+    GDestroyNotify free_userdata) {}
+void p_gpg_process_completed(void) {}
 
 void p_gpg_on_connect(const char * const barejid) {}
 void p_gpg_on_disconnect(void) {}
@@ -50,7 +49,6 @@ gboolean p_gpg_addkey(const char * const jid, const char * const keyid)
     return TRUE;
 }
 
-void p_gpg_free_decrypted(char *decrypted) {}
 
 void p_gpg_free_keys(GHashTable *keys) {}
 
@@ -117,3 +117,98 @@ void add_two_same_updates(void **state)
     autocomplete_clear(ac);
     g_slist_free_full(result, g_free);
 }
+
+void complete_cycles_matches_and_wraps(void **state)
+{
+    Autocomplete ac = autocomplete_new();
+    autocomplete_add(ac, "bob");
+    autocomplete_add(ac, "alice");
+    autocomplete_add(ac, "anne");
+    autocomplete_add(ac, "carol");
+
+    char *first = autocomplete_complete(ac, "a", FALSE);
+    char *second = autocomplete_complete(ac, "a", FALSE);
+    char *third = autocomplete_complete(ac, "a", FALSE);
+
+    assert_string_equal("alice", first);
+    assert_string_equal("anne", second);
+    assert_string_equal("alice", third);
+
+    free(first);
+    free(second);
+    free(third);
+    autocomplete_free(ac);
+}
+
+void complete_after_removing_last_found_restarts(void **state)
+{
+    Autocomplete ac = autocomplete_new();
+    autocomplete_add(ac, "alice");
+    autocomplete_add(ac, "anne");
+
+    char *first = autocomplete_complete(ac, "a", FALSE);
+    autocomplete_remove(ac, "alice");
+    char *second = autocomplete_complete(ac, "a", FALSE);
+
+    assert_string_equal("alice", first);
+    assert_string_equal("anne", second);
+
+    free(first);
+    free(second);
+    autocomplete_free(ac);
+}
+
+void complete_continues_after_add_before_last_found(void **state)
+{
+    Autocomplete ac = autocomplete_new();
+    autocomplete_add(ac, "anne");
+    autocomplete_add(ac, "anton");
+
+    char *first = autocomplete_complete(ac, "an", FALSE);
+    autocomplete_add(ac, "alice");
+    char *second = autocomplete_complete(ac, "an", FALSE);
+
+    assert_string_equal("anne", first);
+    assert_string_equal("anton", second);
+
+    free(first);
+    free(second);
+    autocomplete_free(ac);
+}
+
+void contains_finds_only_added_items(void **state)
+{
+    Autocomplete ac = autocomplete_new();
+    autocomplete_add(ac, "bob");
+    autocomplete_add(ac, "alice");
+    autocomplete_remove(ac, "bob");
+
+    assert_true(autocomplete_contains(ac, "alice"));
+    assert_false(autocomplete_contains(ac, "bob"));
+    assert_false(autocomplete_contains(ac, "al"));
+
+    autocomplete_free(ac);
+}
+
+void add_all_sorts_and_skips_duplicates(void **state)
+{
+    Autocomplete ac = autocomplete_new();
+    autocomplete_add(ac, "carol");
+    GSList *items = NULL;
+    items = g_slist_append(items, "bob");
+    items = g_slist_append(items, "carol");
+    items = g_slist_append(items, "alice");
+    items = g_slist_append(items, "bob");
+
+    autocomplete_add_all(ac, items);
+    GSList *result = autocomplete_create_list(ac);
+
+    assert_int_equal(3, autocomplete_length(ac));
+    assert_string_equal("alice", result->data);
+    assert_string_equal("bob", result->next->data);
+    assert_string_equal("carol", result->next->next->data);
+
+    g_slist_free(items);
+    g_slist_free_full(result, free);
+    autocomplete_free(ac);
+}
@@ -8,3 +8,8 @@ void add_two_and_complete_returns_second(void **state);
 void add_two_adds_two(void **state);
 void add_two_same_adds_one(void **state);
 void add_two_same_updates(void **state);
+void complete_cycles_matches_and_wraps(void **state);
+void complete_after_removing_last_found_restarts(void **state);
+void complete_continues_after_add_before_last_found(void **state);
+void contains_finds_only_added_items(void **state);
+void add_all_sorts_and_skips_duplicates(void **state);
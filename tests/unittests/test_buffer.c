@@ -0,0 +1,223 @@
+#include <glib.h>
+#include <stdarg.h>
+#include <string.h>
+#include <stddef.h>
+#include <setjmp.h>
+#include <cmocka.h>
+#include <stdlib.h>
+
+#include "ui/buffer.h"
+
+static void
+_push(ProfBuff buffer, const char * const message, DeliveryReceipt *receipt)
+{
+    GDateTime *now = g_date_time_new_now_local();
+    buffer_push(buffer, '-', 0, now, 0, 0, "", message, receipt);
+    g_date_time_unref(now);
+}
+
+void buffer_empty_after_create(void **state)
+{
+    ProfBuff buffer = buffer_create();
+
+    assert_int_equal(0, buffer_size(buffer));
+
+    buffer_free(buffer);
+}
+
+void buffer_yields_entries_in_order(void **state)
+{
+    ProfBuff buffer = buffer_create();
+    _push(buffer, "first", NULL);
+    _push(buffer, "second", NULL);
+    _push(buffer, "third", NULL);
+
+    assert_int_equal(3, buffer_size(buffer));
+    assert_string_equal("first", buffer_yield_entry(buffer, 0)->message);
+    assert_string_equal("second", buffer_yield_entry(buffer, 1)->message);
+    assert_string_equal("third", buffer_yield_entry(buffer, 2)->message);
+
+    buffer_free(buffer);
+}
+
+void buffer_drops_oldest_when_full(void **state)
+{
+    ProfBuff buffer = buffer_create();
+    int i;
+    for (i = 0; i < BUFF_SIZE + 50; i++) {
+        char *message = g_strdup_printf("%d", i);
+        _push(buffer, message, NULL);
+        g_free(message);
+    }
+
+    assert_int_equal(BUFF_SIZE, buffer_size(buffer));
+    assert_string_equal("50", buffer_yield_entry(buffer, 0)->message);
+    assert_string_equal("1249", buffer_yield_entry(buffer, BUFF_SIZE - 1)->message);
+
+    buffer_free(buffer);
+}
+
+void buffer_iter_walks_entries_in_order_after_wrap(void **state)
+{
+    ProfBuff buffer = buffer_create();
+    int i;
+    for (i = 0; i < BUFF_SIZE + 10; i++) {
+        char *message = g_strdup_printf("%d", i);
+        _push(buffer, message, NULL);
+        g_free(message);
+    }
+
+    ProfBuffIter iter;
+    ProfBuffEntry *entry = NULL;
+    int count = 0;
+    buffer_iter_init(&iter, buffer);
+    while (buffer_iter_next(&iter, &entry)) {
+        char *expected = g_strdup_printf("%d", count + 10);
+        assert_string_equal(expected, entry->message);
+        g_free(expected);
+        count++;
+    }
+
+    assert_int_equal(BUFF_SIZE, count);
+
+    buffer_free(buffer);
+}
+
+void buffer_mark_received_marks_once(void **state)
+{
+    ProfBuff buffer = buffer_create();
+    DeliveryReceipt *receipt = malloc(sizeof(struct delivery_receipt_t));
+    receipt->id = strdup("msg1");
+    receipt->received = FALSE;
+    _push(buffer, "hello", receipt);
+
+    assert_true(buffer_mark_received(buffer, "msg1"));
+    assert_false(buffer_mark_received(buffer, "msg1"));
+    assert_false(buffer_mark_received(buffer, "msg2"));
+
+    buffer_free(buffer);
+}
+
+void buffer_push_front_adds_older_entries(void **state)
+{
+    ProfBuff buffer = buffer_create();
+    _push(buffer, "newest", NULL);
+
+    GDateTime *now = g_date_time_new_now_local();
+    assert_true(buffer_push_front(buffer, '-', 0, now, 0, 0, "", "older"));
+    assert_true(buffer_push_front(buffer, '-', 0, now, 0, 0, "", "oldest"));
+    g_date_time_unref(now);
+
+    assert_int_equal(3, buffer_size(buffer));
+    assert_string_equal("oldest", buffer_yield_entry(buffer, 0)->message);
+    assert_string_equal("older", buffer_yield_entry(buffer, 1)->message);
+    assert_string_equal("newest", buffer_yield_entry(buffer, 2)->message);
+
+    buffer_free(buffer);
+}
+
+void buffer_push_front_refused_when_full(void **state)
+{
+    ProfBuff buffer = buffer_create();
+    int i;
+    for (i = 0; i < BUFF_SIZE; i++) {
+        char *message = g_strdup_printf("%d", i);
+        _push(buffer, message, NULL);
+        g_free(message);
+    }
+
+    GDateTime *now = g_date_time_new_now_local();
+    assert_false(buffer_push_front(buffer, '-', 0, now, 0, 0, "", "older"));
+    g_date_time_unref(now);
+
+    assert_int_equal(BUFF_SIZE, buffer_size(buffer));
+    assert_string_equal("0", buffer_yield_entry(buffer, 0)->message);
+
+    buffer_free(buffer);
+}
+
+void buffer_layout_wraps_word_to_next_line(void **state)
+{
+    ProfBuff buffer = buffer_create();
+    _push(buffer, "hello world", NULL);
+    ProfBuffEntry *entry = buffer_yield_entry(buffer, 0);
+
+    ProfBuffLayout *layout = buffer_entry_layout(entry, 0, 0, 0, 10);
+
+    assert_int_equal(2, layout->segments->len);
+    ProfBuffSegment *first = &g_array_index(layout->segments, ProfBuffSegment, 0);
+    ProfBuffSegment *second = &g_array_index(layout->segments, ProfBuffSegment, 1);
+    assert_false(first->newline);
+    assert_int_equal(0, first->offset);
+    assert_int_equal(6, first->len);
+    assert_true(second->newline);
+    assert_int_equal(6, second->offset);
+    assert_int_equal(5, second->len);
+
+    buffer_free(buffer);
+}
+
+void buffer_layout_breaks_long_word_with_indent(void **state)
+{
+    ProfBuff buffer = buffer_create();
+    _push(buffer, "abcdefghij", NULL);
+    ProfBuffEntry *entry = buffer_yield_entry(buffer, 0);
+
+    ProfBuffLayout *layout = buffer_entry_layout(entry, 0, 2, 2, 6);
+
+    assert_int_equal(3, layout->segments->len);
+    ProfBuffSegment *segment = &g_array_index(layout->segments, ProfBuffSegment, 0);
+    assert_int_equal(0, segment->indent);
+    assert_int_equal(0, segment->offset);
+    assert_int_equal(4, segment->len);
+    segment = &g_array_index(layout->segments, ProfBuffSegment, 1);
+    assert_false(segment->newline);
+    assert_int_equal(2, segment->indent);
+    assert_int_equal(4, segment->offset);
+    assert_int_equal(4, segment->len);
+    segment = &g_array_index(layout->segments, ProfBuffSegment, 2);
+    assert_int_equal(2, segment->indent);
+    assert_int_equal(8, segment->offset);
+    assert_int_equal(2, segment->len);
+
+    buffer_free(buffer);
+}
+
+void buffer_layout_cached_until_width_changes(void **state)
+{
+    ProfBuff buffer = buffer_create();
+    _push(buffer, "hello world", NULL);
+    ProfBuffEntry *entry = buffer_yield_entry(buffer, 0);
+
+    ProfBuffLayout *layout = buffer_entry_layout(entry, 0, 0, 0, 10);
+    assert_true(layout == buffer_entry_layout(entry, 0, 0, 0, 10));
+
+    layout = buffer_entry_layout(entry, 0, 0, 0, 20);
+    assert_int_equal(20, layout->width);
+    assert_int_equal(1, layout->segments->len);
+    assert_int_equal(11, g_array_index(layout->segments, ProfBuffSegment, 0).len);
+
+    buffer_free(buffer);
+}
+
+void buffer_start_tracks_dropped_and_front_entries(void **state)
+{
+    ProfBuff buffer = buffer_create();
+    int i;
+    for (i = 0; i < BUFF_SIZE + 5; i++) {
+        _push(buffer, "line", NULL);
+    }
+    assert_int_equal(5, buffer_start(buffer));
+
+    buffer_free(buffer);
+    buffer = buffer_create();
+    _push(buffer, "newer", NULL);
+
+    GDateTime *now = g_date_time_new_now_local();
+    buffer_push_front(buffer, '-', 0, now, 0, 0, "", "older");
+    g_date_time_unref(now);
+
+    assert_int_equal(-1, buffer_start(buffer));
+
+    buffer_free(buffer);
+}
@@ -0,0 +1,11 @@
+void buffer_empty_after_create(void **state);
+void buffer_yields_entries_in_order(void **state);
+void buffer_drops_oldest_when_full(void **state);
+void buffer_iter_walks_entries_in_order_after_wrap(void **state);
+void buffer_mark_received_marks_once(void **state);
+void buffer_push_front_adds_older_entries(void **state);
+void buffer_push_front_refused_when_full(void **state);
+void buffer_layout_wraps_word_to_next_line(void **state);
+void buffer_layout_breaks_long_word_with_indent(void **state);
+void buffer_layout_cached_until_width_changes(void **state);
+void buffer_start_tracks_dropped_and_front_entries(void **state);
@@ -0,0 +1,159 @@
+#include <glib.h>
+#include <stdarg.h>
+#include <string.h>
+#include <stddef.h>
+#include <setjmp.h>
+#include <cmocka.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <unistd.h>
+
+#include "common.h"
+#include "helpers.h"
+#include "log_history.h"
+
+#define LOGS_DIR "./tests/files/xdg_data_home/profanity/chatlogs"
+#define CONTACT_DIR LOGS_DIR "/me_at_server.org/buddy_at_server.org"
+
+static void
+_remove_tree(const char * const path)
+{
+    GDir *dir = g_dir_open(path, 0, NULL);
+    if (dir) {
+        const gchar *name;
+        while ((name = g_dir_read_name(dir)) != NULL) {
+            gchar *child = g_strdup_printf("%s/%s", path, name);
+            _remove_tree(child);
+            g_free(child);
+        }
+        g_dir_close(dir);
+    }
+    remove(path);
+}
+
+static void
+_write_log(const char * const name, const char * const text)
+{
+    mkdir_recursive(CONTACT_DIR);
+    gchar *path = g_strdup_printf("%s/%s", CONTACT_DIR, name);
+    FILE *logp = fopen(path, "w");
+    fputs(text, logp);
+    fclose(logp);
+    g_free(path);
+}
+
+static void
+_assert_lines(GSList *lines, int count, ...)
+{
+    assert_int_equal(count, g_slist_length(lines));
+
+    va_list expected;
+    va_start(expected, count);
+    GSList *curr = lines;
+    while (curr) {
+        assert_string_equal(va_arg(expected, char *), curr->data);
+        curr = g_slist_next(curr);
+    }
+    va_end(expected);
+
+    g_slist_free_full(lines, free);
+}
+
+void chat_log_history_before_test(void **state)
+{
+    create_data_dir(state);
+}
+
+void chat_log_history_after_test(void **state)
+{
+    _remove_tree(LOGS_DIR);
+    remove_data_dir(state);
+    rmdir("./tests/files");
+}
+
+void history_of_empty_log_has_no_lines(void **state)
+{
+    _write_log("2015_01_02.log", "");
+
+    ChatLogHistory *history = chat_log_history_open("me@server.org", "buddy@server.org");
+    assert_null(chat_log_history_older(history, 10));
+    chat_log_history_close(history);
+}
+
+void history_returns_log_smaller_than_chunk(void **state)
+{
+    _write_log("2015_01_02.log",
+        "10:00:00 - buddy@server.org: one\n"
+        "10:00:01 - me: two\n"
+        "10:00:02 - buddy@server.org: three\n");
+
+    ChatLogHistory *history = chat_log_history_open("me@server.org", "buddy@server.org");
+    _assert_lines(chat_log_history_older(history, 10), 4,
+        "2/1/2015:",
+        "10:00:00 - buddy@server.org: one",
+        "10:00:01 - me: two",
+        "10:00:02 - buddy@server.org: three");
+    assert_null(chat_log_history_older(history, 10));
+    chat_log_history_close(history);
+}
+
+void history_joins_line_straddling_chunk(void **state)
+{
+    // the long line starts before and ends after the 4KB boundary counted from the end
+    GString *long_line = g_string_new("10:00:01 - me: ");
+    while (long_line->len < 5000) {
+        g_string_append_c(long_line, 'x');
+    }
+    GString *text = g_string_new("10:00:00 - me: first\n");
+    g_string_append_printf(text, "%s\n", long_line->str);
+    g_string_append(text, "10:00:02 - me: last\n");
+    _write_log("2015_01_02.log", text->str);
+    g_string_free(text, TRUE);
+
+    ChatLogHistory *history = chat_log_history_open("me@server.org", "buddy@server.org");
+    _assert_lines(chat_log_history_older(history, 10), 4,
+        "2/1/2015:",
+        "10:00:00 - me: first",
+        long_line->str,
+        "10:00:02 - me: last");
+    chat_log_history_close(history);
+    g_string_free(long_line, TRUE);
+}
+
+void history_reads_last_line_without_newline(void **state)
+{
+    _write_log("2015_01_02.log",
+        "10:00:00 - me: one\n"
+        "10:00:01 - me: two");
+
+    ChatLogHistory *history = chat_log_history_open("me@server.org", "buddy@server.org");
+    _assert_lines(chat_log_history_older(history, 10), 3,
+        "2/1/2015:",
+        "10:00:00 - me: one",
+        "10:00:01 - me: two");
+    chat_log_history_close(history);
+}
+
+void history_pages_back_to_start_of_logs(void **state)
+{
+    _write_log("2015_01_01.log",
+        "09:00:00 - me: old\n");
+    _write_log("2015_01_02.log",
+        "10:00:00 - me: a\n"
+        "10:00:01 - me: b\n"
+        "10:00:02 - me: c\n");
+
+    ChatLogHistory *history = chat_log_history_open("me@server.org", "buddy@server.org");
+    _assert_lines(chat_log_history_older(history, 2), 2,
+        "10:00:01 - me: b",
+        "10:00:02 - me: c");
+    _assert_lines(chat_log_history_older(history, 2), 2,
+        "2/1/2015:",
+        "10:00:00 - me: a");
+    _assert_lines(chat_log_history_older(history, 2), 2,
+        "1/1/2015:",
+        "09:00:00 - me: old");
+    assert_null(chat_log_history_older(history, 2));
+    assert_null(chat_log_history_older(history, 2));
+    chat_log_history_close(history);
+}
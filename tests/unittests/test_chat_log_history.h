@@ -0,0 +1,7 @@
+void chat_log_history_before_test(void **state);
+void chat_log_history_after_test(void **state);
+void history_of_empty_log_has_no_lines(void **state);
+void history_returns_log_smaller_than_chunk(void **state);
+void history_joins_line_straddling_chunk(void **state);
+void history_reads_last_line_without_newline(void **state);
+void history_pages_back_to_start_of_logs(void **state);
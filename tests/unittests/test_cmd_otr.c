@@ -76,7 +76,7 @@ void cmd_otr_log_on_enables_logging(void **state)
     expect_cons_show("OTR messages will be logged as plaintext.");
 
     gboolean result = cmd_otr(NULL, CMD_OTR, args);
-    char *pref_otr_log = prefs_get_string(PREF_OTR_LOG);
+    const char *pref_otr_log = prefs_get_string(PREF_OTR_LOG);
 
     assert_true(result);
     assert_string_equal("on", pref_otr_log);
@@ -104,7 +104,7 @@ void cmd_otr_log_off_disables_logging(void **state)
     expect_cons_show("OTR message logging disabled.");
 
     gboolean result = cmd_otr(NULL, CMD_OTR, args);
-    char *pref_otr_log = prefs_get_string(PREF_OTR_LOG);
+    const char *pref_otr_log = prefs_get_string(PREF_OTR_LOG);
 
     assert_true(result);
     assert_string_equal("off", pref_otr_log);
@@ -119,7 +119,7 @@ void cmd_otr_redact_redacts_logging(void **state)
     expect_cons_show("OTR messages will be logged as '[redacted]'.");
 
     gboolean result = cmd_otr(NULL, CMD_OTR, args);
-    char *pref_otr_log = prefs_get_string(PREF_OTR_LOG);
+    const char *pref_otr_log = prefs_get_string(PREF_OTR_LOG);
 
     assert_true(result);
     assert_string_equal("redact", pref_otr_log);
@@ -70,6 +70,7 @@ void cmd_rooms_uses_account_default_when_no_arg(void **state)
     account->otr_always = NULL;
     account->pgp_keyid = NULL;
     account->muc_service = strdup("default_conf_server");
+    account->refcount = 1;
 
     will_return(jabber_get_connection_status, JABBER_CONNECTED);
     will_return(jabber_get_account_name, "account_name");
@@ -63,7 +63,7 @@ void cmd_statuses_console_sets_all(void **state)
 
     gboolean result = cmd_statuses(NULL, CMD_STATUSES, args);
 
-    char *setting = prefs_get_string(PREF_STATUSES_CONSOLE);
+    const char *setting = prefs_get_string(PREF_STATUSES_CONSOLE);
     assert_non_null(setting);
     assert_string_equal("all", setting);
     assert_true(result);
@@ -77,7 +77,7 @@ void cmd_statuses_console_sets_online(void **state)
 
     gboolean result = cmd_statuses(NULL, CMD_STATUSES, args);
 
-    char *setting = prefs_get_string(PREF_STATUSES_CONSOLE);
+    const char *setting = prefs_get_string(PREF_STATUSES_CONSOLE);
     assert_non_null(setting);
     assert_string_equal("online", setting);
     assert_true(result);
@@ -91,7 +91,7 @@ void cmd_statuses_console_sets_none(void **state)
 
     gboolean result = cmd_statuses(NULL, CMD_STATUSES, args);
 
-    char *setting = prefs_get_string(PREF_STATUSES_CONSOLE);
+    const char *setting = prefs_get_string(PREF_STATUSES_CONSOLE);
     assert_non_null(setting);
     assert_string_equal("none", setting);
     assert_true(result);
@@ -105,7 +105,7 @@ void cmd_statuses_chat_sets_all(void **state)
 
     gboolean result = cmd_statuses(NULL, CMD_STATUSES, args);
 
-    char *setting = prefs_get_string(PREF_STATUSES_CHAT);
+    const char *setting = prefs_get_string(PREF_STATUSES_CHAT);
     assert_non_null(setting);
     assert_string_equal("all", setting);
     assert_true(result);
@@ -119,7 +119,7 @@ void cmd_statuses_chat_sets_online(void **state)
 
     gboolean result = cmd_statuses(NULL, CMD_STATUSES, args);
 
-    char *setting = prefs_get_string(PREF_STATUSES_CHAT);
+    const char *setting = prefs_get_string(PREF_STATUSES_CHAT);
     assert_non_null(setting);
     assert_string_equal("online", setting);
     assert_true(result);
@@ -133,7 +133,7 @@ void cmd_statuses_chat_sets_none(void **state)
 
     gboolean result = cmd_statuses(NULL, CMD_STATUSES, args);
 
-    char *setting = prefs_get_string(PREF_STATUSES_CHAT);
+    const char *setting = prefs_get_string(PREF_STATUSES_CHAT);
     assert_non_null(setting);
     assert_string_equal("none", setting);
     assert_true(result);
@@ -147,7 +147,7 @@ void cmd_statuses_muc_sets_all(void **state)
 
     gboolean result = cmd_statuses(NULL, CMD_STATUSES, args);
 
-    char *setting = prefs_get_string(PREF_STATUSES_MUC);
+    const char *setting = prefs_get_string(PREF_STATUSES_MUC);
     assert_non_null(setting);
     assert_string_equal("all", setting);
     assert_true(result);
@@ -161,7 +161,7 @@ void cmd_statuses_muc_sets_online(void **state)
 
     gboolean result = cmd_statuses(NULL, CMD_STATUSES, args);
 
-    char *setting = prefs_get_string(PREF_STATUSES_MUC);
+    const char *setting = prefs_get_string(PREF_STATUSES_MUC);
     assert_non_null(setting);
     assert_string_equal("online", setting);
     assert_true(result);
@@ -175,7 +175,7 @@ void cmd_statuses_muc_sets_none(void **state)
 
     gboolean result = cmd_statuses(NULL, CMD_STATUSES, args);
 
-    char *setting = prefs_get_string(PREF_STATUSES_MUC);
+    const char *setting = prefs_get_string(PREF_STATUSES_MUC);
     assert_non_null(setting);
     assert_string_equal("none", setting);
     assert_true(result);
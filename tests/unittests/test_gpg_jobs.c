@@ -0,0 +1,250 @@
+#include <glib.h>
+#include <stdarg.h>
+#include <string.h>
+#include <stddef.h>
+#include <setjmp.h>
+#include <cmocka.h>
+#include <stdlib.h>
+#include <pthread.h>
+#include <poll.h>
+
+#include "pgp/gpg_jobs.h"
+#include "tools/wakeup.h"
+
+typedef struct test_job_t {
+    int id;
+    // microseconds the job takes
+    gulong delay;
+    // wait for _gate_open before finishing
+    gboolean gated;
+    pthread_t ran_on;
+} TestJob;
+
+static GSList *delivered;
+static int freed;
+static int workers_created;
+static int workers_freed;
+
+static pthread_mutex_t gate_lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t gate_cond = PTHREAD_COND_INITIALIZER;
+static gboolean gate_open;
+
+static void *
+_worker_new(void)
+{
+    __sync_fetch_and_add(&workers_created, 1);
+    return &workers_created;
+}
+
+static void
+_worker_free(void *worker)
+{
+    __sync_fetch_and_add(&workers_freed, 1);
+}
+
+static void
+_run(void *worker, void *data)
+{
+    TestJob *job = data;
+    job->ran_on = pthread_self();
+    if (job->gated) {
+        pthread_mutex_lock(&gate_lock);
+        while (!gate_open) {
+            pthread_cond_wait(&gate_cond, &gate_lock);
+        }
+        pthread_mutex_unlock(&gate_lock);
+    }
+    g_usleep(job->delay);
+}
+
+static void
+_deliver(void *data)
+{
+    TestJob *job = data;
+    delivered = g_slist_append(delivered, GINT_TO_POINTER(job->id));
+}
+
+static void
+_free(void *data)
+{
+    freed++;
+    free(data);
+}
+
+static void
+_start(int workers)
+{
+    delivered = NULL;
+    freed = 0;
+    workers_created = 0;
+    workers_freed = 0;
+    gate_open = FALSE;
+
+    GPGJobFuncs funcs;
+    funcs.worker_new = _worker_new;
+    funcs.worker_free = _worker_free;
+    funcs.run = _run;
+    funcs.deliver = _deliver;
+    funcs.free = _free;
+    gpg_jobs_start(&funcs, workers);
+}
+
+static void
+_stop(void)
+{
+    gpg_jobs_stop();
+    g_slist_free(delivered);
+    delivered = NULL;
+}
+
+static TestJob *
+_submit(gpg_jobs_queue_t queue, int id, gulong delay, gboolean gated)
+{
+    TestJob *job = malloc(sizeof(TestJob));
+    job->id = id;
+    job->delay = delay;
+    job->gated = gated;
+    gpg_jobs_submit(queue, job);
+
+    return job;
+}
+
+static void
+_open_gate(void)
+{
+    pthread_mutex_lock(&gate_lock);
+    gate_open = TRUE;
+    pthread_cond_broadcast(&gate_cond);
+    pthread_mutex_unlock(&gate_lock);
+}
+
+// process completed jobs until count have been freed, or a few seconds pass
+static void
+_process_until_freed(int count)
+{
+    int i;
+    for (i = 0; i < 500 && freed < count; i++) {
+        gpg_jobs_process_completed();
+        g_usleep(10000);
+    }
+}
+
+static void
+_process_until_delivered(int id)
+{
+    int i;
+    for (i = 0; i < 500 && !g_slist_find(delivered, GINT_TO_POINTER(id)); i++) {
+        gpg_jobs_process_completed();
+        g_usleep(10000);
+    }
+}
+
+void gpg_jobs_delivers_in_submission_order(void **state)
+{
+    _start(2);
+
+    // earlier jobs take longer, so workers finish them last
+    int i;
+    for (i = 0; i < 6; i++) {
+        _submit(GPG_JOBS_DECRYPT, i, (6 - i) * 20000, FALSE);
+    }
+    _process_until_freed(6);
+
+    assert_int_equal(6, g_slist_length(delivered));
+    for (i = 0; i < 6; i++) {
+        assert_int_equal(i, GPOINTER_TO_INT(g_slist_nth_data(delivered, i)));
+    }
+
+    _stop();
+    assert_int_equal(2, workers_created);
+    assert_int_equal(2, workers_freed);
+}
+
+void gpg_jobs_verify_does_not_hold_back_decrypt(void **state)
+{
+    _start(2);
+
+    _submit(GPG_JOBS_VERIFY, 1, 0, TRUE);
+    _submit(GPG_JOBS_DECRYPT, 2, 0, FALSE);
+    _process_until_delivered(2);
+
+    assert_int_equal(1, g_slist_length(delivered));
+    assert_int_equal(2, GPOINTER_TO_INT(delivered->data));
+
+    _open_gate();
+    _process_until_delivered(1);
+    assert_int_equal(2, g_slist_length(delivered));
+
+    _stop();
+}
+
+void gpg_jobs_drops_results_from_old_generation(void **state)
+{
+    _start(2);
+
+    _submit(GPG_JOBS_VERIFY, 1, 0, TRUE);
+    _submit(GPG_JOBS_DECRYPT, 2, 0, TRUE);
+    gpg_jobs_new_generation();
+    _submit(GPG_JOBS_DECRYPT, 3, 0, FALSE);
+    _open_gate();
+    _process_until_freed(3);
+
+    assert_int_equal(3, freed);
+    assert_int_equal(1, g_slist_length(delivered));
+    assert_int_equal(3, GPOINTER_TO_INT(delivered->data));
+
+    _stop();
+}
+
+void gpg_jobs_stop_frees_undelivered_jobs(void **state)
+{
+    _start(2);
+
+    int i;
+    for (i = 0; i < 4; i++) {
+        _submit(GPG_JOBS_DECRYPT, i, 1000, FALSE);
+    }
+    _stop();
+
+    assert_int_equal(4, freed);
+    assert_int_equal(2, workers_freed);
+}
+
+void gpg_jobs_run_on_main_thread_without_workers(void **state)
+{
+    _start(0);
+
+    TestJob *job = _submit(GPG_JOBS_VERIFY, 1, 0, FALSE);
+    assert_true(pthread_equal(pthread_self(), job->ran_on));
+    assert_null(delivered);
+
+    gpg_jobs_process_completed();
+    assert_int_equal(1, g_slist_length(delivered));
+
+    _stop();
+    assert_int_equal(1, workers_created);
+    assert_int_equal(1, workers_freed);
+}
+
+void gpg_jobs_wakes_main_loop_on_completion(void **state)
+{
+    wakeup_init();
+    _start(1);
+
+    _submit(GPG_JOBS_DECRYPT, 1, 0, TRUE);
+    struct pollfd fds[1];
+    fds[0].fd = wakeup_get_fd();
+    fds[0].events = POLLIN;
+    assert_int_equal(0, poll(fds, 1, 0));
+
+    _open_gate();
+    assert_int_equal(1, poll(fds, 1, 5000));
+    wakeup_clear();
+    assert_int_equal(0, poll(fds, 1, 0));
+
+    _process_until_delivered(1);
+    assert_int_equal(1, g_slist_length(delivered));
+
+    _stop();
+    wakeup_close();
+}
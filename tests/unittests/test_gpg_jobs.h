@@ -0,0 +1,6 @@
+void gpg_jobs_delivers_in_submission_order(void **state);
+void gpg_jobs_verify_does_not_hold_back_decrypt(void **state);
+void gpg_jobs_drops_results_from_old_generation(void **state);
+void gpg_jobs_stop_frees_undelivered_jobs(void **state);
+void gpg_jobs_run_on_main_thread_without_workers(void **state);
+void gpg_jobs_wakes_main_loop_on_completion(void **state);
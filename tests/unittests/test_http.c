@@ -0,0 +1,166 @@
+#include <glib.h>
+#include <stdarg.h>
+#include <string.h>
+#include <stddef.h>
+#include <setjmp.h>
+#include <cmocka.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+
+#include "tools/http.h"
+
+// one shot HTTP server on localhost that answers with a fixed response
+typedef struct stub_server_t {
+    int sock;
+    int port;
+    const char *response;
+    pthread_t thread;
+} StubServer;
+
+typedef struct http_result_t {
+    gboolean done;
+    char *body;
+} HTTPResult;
+
+static void *
+_serve(void *arg)
+{
+    StubServer *server = arg;
+    int client = accept(server->sock, NULL, NULL);
+    if (client != -1) {
+        // read the request headers before answering
+        GString *request = g_string_new("");
+        char buf[512];
+        ssize_t len;
+        while (!strstr(request->str, "\r\n\r\n") && (len = read(client, buf, sizeof(buf) - 1)) > 0) {
+            buf[len] = '\0';
+            g_string_append(request, buf);
+        }
+        g_string_free(request, TRUE);
+
+        write(client, server->response, strlen(server->response));
+        close(client);
+    }
+
+    return NULL;
+}
+
+static void
+_start_server(StubServer *server, const char * const response)
+{
+    struct sockaddr_in addr;
+    socklen_t addr_len = sizeof(addr);
+    memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    addr.sin_port = 0;
+
+    server->sock = socket(AF_INET, SOCK_STREAM, 0);
+    assert_true(server->sock != -1);
+    assert_int_equal(0, bind(server->sock, (struct sockaddr *)&addr, sizeof(addr)));
+    assert_int_equal(0, listen(server->sock, 1));
+    assert_int_equal(0, getsockname(server->sock, (struct sockaddr *)&addr, &addr_len));
+
+    server->port = ntohs(addr.sin_port);
+    server->response = response;
+    pthread_create(&server->thread, NULL, _serve, server);
+}
+
+static void
+_stop_server(StubServer *server)
+{
+    pthread_join(server->thread, NULL);
+    close(server->sock);
+}
+
+static void
+_store_result(const char * const body, void *userdata)
+{
+    HTTPResult *result = userdata;
+    result->done = TRUE;
+    result->body = body ? strdup(body) : NULL;
+}
+
+static void
+_wait_for(HTTPResult *result)
+{
+    int i;
+    for (i = 0; i < 500 && !result->done; i++) {
+        http_process_completed();
+        if (!result->done) {
+            usleep(10000);
+        }
+    }
+}
+
+void http_get_returns_body_to_main_loop(void **state)
+{
+    StubServer server;
+    _start_server(&server, "HTTP/1.0 200 OK\r\nContent-Length: 5\r\n\r\nhello");
+    char *url = g_strdup_printf("http://127.0.0.1:%d/", server.port);
+
+    HTTPResult result = { FALSE, NULL };
+    http_get(url, 5, _store_result, &result, NULL);
+
+    // callbacks only run from http_process_completed
+    assert_false(result.done);
+
+    _wait_for(&result);
+    assert_true(result.done);
+    assert_string_equal("hello", result.body);
+
+    free(result.body);
+    g_free(url);
+    _stop_server(&server);
+    http_close();
+}
+
+void http_get_reports_error_status_as_failure(void **state)
+{
+    StubServer server;
+    _start_server(&server, "HTTP/1.0 404 Not Found\r\nContent-Length: 9\r\n\r\nnot found");
+    char *url = g_strdup_printf("http://127.0.0.1:%d/", server.port);
+
+    HTTPResult result = { FALSE, NULL };
+    http_get(url, 5, _store_result, &result, NULL);
+
+    _wait_for(&result);
+    assert_true(result.done);
+    assert_null(result.body);
+
+    g_free(url);
+    _stop_server(&server);
+    http_close();
+}
+
+void http_close_drops_pending_requests(void **state)
+{
+    StubServer server;
+    _start_server(&server, "HTTP/1.0 200 OK\r\nContent-Length: 5\r\n\r\nhello");
+    char *url = g_strdup_printf("http://127.0.0.1:%d/", server.port);
+
+    HTTPResult result = { FALSE, NULL };
+    http_get(url, 5, _store_result, &result, NULL);
+    http_close();
+    http_process_completed();
+
+    assert_false(result.done);
+
+    g_free(url);
+    // unblock the server if the request never reached it
+    int sock = socket(AF_INET, SOCK_STREAM, 0);
+    struct sockaddr_in addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    addr.sin_port = htons(server.port);
+    if (connect(sock, (struct sockaddr *)&addr, sizeof(addr)) == 0) {
+        write(sock, "\r\n\r\n", 4);
+    }
+    close(sock);
+    _stop_server(&server);
+}
@@ -0,0 +1,3 @@
+void http_get_returns_body_to_main_loop(void **state);
+void http_get_reports_error_status_as_failure(void **state);
+void http_close_drops_pending_requests(void **state);
@@ -0,0 +1,214 @@
+#include <glib.h>
+#include <stdarg.h>
+#include <string.h>
+#include <stddef.h>
+#include <setjmp.h>
+#include <cmocka.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <unistd.h>
+
+#include "common.h"
+#include "helpers.h"
+#include "log_index.h"
+
+#define LOGS_DIR "./tests/files/xdg_data_home/profanity/chatlogs"
+#define LOGIN_DIR LOGS_DIR "/me_at_server.org"
+
+static void
+_remove_tree(const char * const path)
+{
+    GDir *dir = g_dir_open(path, 0, NULL);
+    if (dir) {
+        const gchar *name;
+        while ((name = g_dir_read_name(dir)) != NULL) {
+            gchar *child = g_strdup_printf("%s/%s", path, name);
+            _remove_tree(child);
+            g_free(child);
+        }
+        g_dir_close(dir);
+    }
+    remove(path);
+}
+
+static char *
+_write_log(const char * const dir, const char * const name, const char * const text)
+{
+    gchar *log_dir = g_strdup_printf("%s/%s", LOGIN_DIR, dir);
+    mkdir_recursive(log_dir);
+    char *path = g_strdup_printf("%s/%s", log_dir, name);
+    g_free(log_dir);
+
+    FILE *logp = fopen(path, "a");
+    fputs(text, logp);
+    fclose(logp);
+
+    return path;
+}
+
+// index everything, as the main loop does after connecting, then search
+static GSList *
+_search(const char * const query)
+{
+    log_index_start("me@server.org");
+    while (log_index_building()) {
+        log_index_process();
+    }
+
+    return log_index_search("me@server.org", query, 10);
+}
+
+void log_index_before_test(void **state)
+{
+    create_data_dir(state);
+}
+
+void log_index_after_test(void **state)
+{
+    log_index_close();
+    _remove_tree(LOGS_DIR);
+    remove_data_dir(state);
+    rmdir("./tests/files");
+}
+
+void search_finds_line_in_contact_log(void **state)
+{
+    g_free(_write_log("buddy_at_server.org", "2015_01_02.log",
+        "10:00:00 - buddy@server.org: hello there\n"
+        "10:00:05 - me: nothing to see\n"));
+
+    GSList *results = _search("hello");
+
+    assert_int_equal(1, g_slist_length(results));
+    LogSearchResult *result = results->data;
+    assert_string_equal("buddy@server.org", result->contact);
+    assert_string_equal("2015_01_02", result->date);
+    assert_string_equal("10:00:00 - buddy@server.org: hello there", result->line);
+
+    log_index_free_results(results);
+}
+
+void search_matches_every_word_ignoring_case(void **state)
+{
+    g_free(_write_log("buddy_at_server.org", "2015_01_02.log",
+        "10:00:00 - buddy@server.org: hello there\n"
+        "10:00:05 - me: Hello World\n"));
+
+    GSList *results = _search("world HELLO");
+
+    assert_int_equal(1, g_slist_length(results));
+    LogSearchResult *result = results->data;
+    assert_string_equal("10:00:05 - me: Hello World", result->line);
+
+    log_index_free_results(results);
+}
+
+void search_returns_newest_first_including_rooms(void **state)
+{
+    g_free(_write_log("buddy_at_server.org", "2015_01_02.log",
+        "12:00:00 - buddy@server.org: lunch?\n"));
+    g_free(_write_log("rooms/room_at_conf.server.org", "2015_01_03.log",
+        "09:00:00 - bob: lunch at noon\n"
+        "11:00:00 - alice: lunch was good\n"));
+
+    GSList *results = _search("lunch");
+
+    assert_int_equal(3, g_slist_length(results));
+    LogSearchResult *first = g_slist_nth_data(results, 0);
+    LogSearchResult *second = g_slist_nth_data(results, 1);
+    LogSearchResult *third = g_slist_nth_data(results, 2);
+    assert_string_equal("room@conf.server.org", first->contact);
+    assert_string_equal("11:00:00 - alice: lunch was good", first->line);
+    assert_string_equal("09:00:00 - bob: lunch at noon", second->line);
+    assert_string_equal("buddy@server.org", third->contact);
+
+    log_index_free_results(results);
+}
+
+void search_finds_lines_appended_after_indexing(void **state)
+{
+    char *path = _write_log("buddy_at_server.org", "2015_01_02.log",
+        "10:00:00 - buddy@server.org: first\n");
+    log_index_free_results(_search("first"));
+
+    char *line = "10:01:00 - me: second\n";
+    g_free(_write_log("buddy_at_server.org", "2015_01_02.log", line));
+    log_index_append(path, strlen("10:00:00 - buddy@server.org: first\n"), line);
+
+    GSList *results = log_index_search("me@server.org", "second", 10);
+    assert_int_equal(1, g_slist_length(results));
+    log_index_free_results(results);
+
+    // and again from the saved index
+    log_index_close();
+    results = log_index_search("me@server.org", "second", 10);
+    assert_int_equal(1, g_slist_length(results));
+    log_index_free_results(results);
+
+    g_free(path);
+}
+
+void search_indexes_logs_a_chunk_at_a_time(void **state)
+{
+    GString *text = g_string_new("");
+    int i;
+    for (i = 0; i < 4000; i++) {
+        g_string_append_printf(text, "10:00:00 - buddy@server.org: message number %d\n", i);
+    }
+    g_free(_write_log("buddy_at_server.org", "2015_01_02.log", text->str));
+    g_string_free(text, TRUE);
+
+    log_index_start("me@server.org");
+    log_index_process();
+    assert_true(log_index_building());
+
+    GSList *results = _search("3999");
+    assert_false(log_index_building());
+    assert_int_equal(1, g_slist_length(results));
+    log_index_free_results(results);
+}
+
+void append_indexes_log_not_loaded(void **state)
+{
+    char *first = "10:00:00 - buddy@server.org: first\n";
+    char *path = _write_log("buddy_at_server.org", "2015_01_02.log", first);
+    log_index_free_results(_search("first"));
+    log_index_close();
+
+    char *line = "10:01:00 - me: second\n";
+    g_free(_write_log("buddy_at_server.org", "2015_01_02.log", line));
+    log_index_append(path, strlen(first), line);
+    log_index_close();
+
+    // found from the postings on disk, without catching up
+    GSList *results = log_index_search("me@server.org", "second", 10);
+    assert_true(log_index_building());
+    assert_int_equal(1, g_slist_length(results));
+    log_index_free_results(results);
+
+    g_free(path);
+}
+
+void search_skips_postings_indexed_twice(void **state)
+{
+    g_free(_write_log("buddy_at_server.org", "2015_01_02.log",
+        "10:00:00 - buddy@server.org: hello there\n"
+        "10:00:05 - me: hello again\n"));
+    log_index_free_results(_search("hello"));
+    log_index_close();
+
+    // as if the postings were written again after a crash before the offsets were saved
+    gchar *words_path = g_strdup_printf("%s/buddy_at_server.org/index.words", LOGIN_DIR);
+    gchar *words = NULL;
+    gsize len = 0;
+    assert_true(g_file_get_contents(words_path, &words, &len, NULL));
+    FILE *words_file = fopen(words_path, "a");
+    fwrite(words, 1, len, words_file);
+    fclose(words_file);
+    g_free(words);
+    g_free(words_path);
+
+    GSList *results = _search("hello");
+    assert_int_equal(2, g_slist_length(results));
+    log_index_free_results(results);
+}
@@ -0,0 +1,9 @@
+void log_index_before_test(void **state);
+void log_index_after_test(void **state);
+void search_finds_line_in_contact_log(void **state);
+void search_matches_every_word_ignoring_case(void **state);
+void search_returns_newest_first_including_rooms(void **state);
+void search_finds_lines_appended_after_indexing(void **state);
+void search_indexes_logs_a_chunk_at_a_time(void **state);
+void append_indexes_log_not_loaded(void **state);
+void search_skips_postings_indexed_twice(void **state);
@@ -76,3 +76,82 @@ void test_muc_active(void **state)
 
     assert_true(room_is_active);
 }
+
+void test_muc_roster_sorted_by_nick(void **state)
+{
+    char *room = "room@server.org";
+    muc_join(room, "bob", NULL, FALSE);
+    muc_roster_add(room, "carol", NULL, "participant", "none", NULL, NULL);
+    muc_roster_add(room, "alice", NULL, "participant", "none", NULL, NULL);
+    muc_roster_add(room, "bob", NULL, "moderator", "owner", NULL, NULL);
+
+    GList *occupants = muc_roster(room);
+
+    assert_int_equal(3, g_list_length(occupants));
+    assert_string_equal("alice", ((Occupant*)g_list_nth_data(occupants, 0))->nick);
+    assert_string_equal("bob", ((Occupant*)g_list_nth_data(occupants, 1))->nick);
+    assert_string_equal("carol", ((Occupant*)g_list_nth_data(occupants, 2))->nick);
+
+    g_list_free(occupants);
+}
+
+void test_muc_occupants_by_role_follow_role_change(void **state)
+{
+    char *room = "room@server.org";
+    muc_join(room, "bob", NULL, FALSE);
+    muc_roster_add(room, "alice", NULL, "participant", "none", NULL, NULL);
+    muc_roster_add(room, "carol", NULL, "participant", "none", NULL, NULL);
+    muc_roster_add(room, "alice", NULL, "moderator", "admin", NULL, NULL);
+
+    GSList *moderators = muc_occupants_by_role(room, MUC_ROLE_MODERATOR);
+    GSList *participants = muc_occupants_by_role(room, MUC_ROLE_PARTICIPANT);
+
+    assert_int_equal(1, g_slist_length(moderators));
+    assert_string_equal("alice", ((Occupant*)moderators->data)->nick);
+    assert_int_equal(1, g_slist_length(participants));
+    assert_string_equal("carol", ((Occupant*)participants->data)->nick);
+
+    g_slist_free(moderators);
+    g_slist_free(participants);
+}
+
+void test_muc_removed_occupant_not_in_roster(void **state)
+{
+    char *room = "room@server.org";
+    muc_join(room, "bob", NULL, FALSE);
+    muc_roster_add(room, "alice", NULL, "participant", "none", NULL, NULL);
+    muc_roster_add(room, "carol", NULL, "participant", "none", NULL, NULL);
+    muc_roster_remove(room, "alice");
+
+    GList *occupants = muc_roster(room);
+    GSList *participants = muc_occupants_by_role(room, MUC_ROLE_PARTICIPANT);
+
+    assert_int_equal(1, g_list_length(occupants));
+    assert_string_equal("carol", ((Occupant*)occupants->data)->nick);
+    assert_int_equal(1, g_slist_length(participants));
+
+    g_list_free(occupants);
+    g_slist_free(participants);
+}
+
+void test_muc_own_nick_change_leaves_occupants_by_role(void **state)
+{
+    char *room = "room@server.org";
+    muc_join(room, "bob", NULL, FALSE);
+    muc_roster_add(room, "alice", NULL, "participant", "none", NULL, NULL);
+    muc_roster_add(room, "bob", NULL, "participant", "none", NULL, NULL);
+    muc_nick_change_start(room, "robert");
+    muc_nick_change_complete(room, "robert");
+    muc_roster_add(room, "robert", NULL, "participant", "none", NULL, NULL);
+
+    GSList *participants = muc_occupants_by_role(room, MUC_ROLE_PARTICIPANT);
+    GList *occupants = muc_roster(room);
+
+    assert_int_equal(2, g_slist_length(participants));
+    assert_string_equal("alice", ((Occupant*)g_slist_nth_data(participants, 0))->nick);
+    assert_string_equal("robert", ((Occupant*)g_slist_nth_data(participants, 1))->nick);
+    assert_int_equal(2, g_list_length(occupants));
+
+    g_slist_free(participants);
+    g_list_free(occupants);
+}
@@ -7,3 +7,7 @@ void test_muc_invites_count_0(void **state);
 void test_muc_invites_count_5(void **state);
 void test_muc_room_is_not_active(void **state);
 void test_muc_active(void **state);
+void test_muc_roster_sorted_by_nick(void **state);
+void test_muc_occupants_by_role_follow_role_change(void **state);
+void test_muc_removed_occupant_not_in_roster(void **state);
+void test_muc_own_nick_change_leaves_occupants_by_role(void **state);
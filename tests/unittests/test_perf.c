@@ -0,0 +1,87 @@
+#include <glib.h>
+#include <stdarg.h>
+#include <string.h>
+#include <stddef.h>
+#include <setjmp.h>
+#include <cmocka.h>
+#include <stdlib.h>
+#include <stdio.h>
+
+#include "tools/perf.h"
+
+#define PERF_FILE "./perf_test_file"
+
+#define MS 1000000
+
+void perf_disabled_records_nothing(void **state)
+{
+    perf_enable(FALSE);
+
+    gint64 start = perf_start();
+    perf_end("handler", start);
+
+    assert_true(start == 0);
+    assert_null(perf_get_stats());
+
+    perf_close();
+}
+
+void perf_stats_summarise_latencies(void **state)
+{
+    perf_enable(TRUE);
+
+    int i;
+    for (i = 0; i < 98; i++) {
+        perf_end("handler", perf_start() - 1 * MS);
+    }
+    perf_end("handler", perf_start() - 50 * MS);
+    perf_end("handler", perf_start() - 50 * MS);
+    perf_end("render", perf_start() - 1 * MS);
+
+    GSList *stats = perf_get_stats();
+    assert_int_equal(2, g_slist_length(stats));
+
+    // most expensive first
+    PerfStat *stat = stats->data;
+    assert_string_equal("handler", stat->name);
+    assert_int_equal(100, stat->count);
+    assert_true(stat->max >= 50 * MS);
+    assert_true(stat->p50 >= 1 * MS && stat->p50 < 2 * MS);
+    assert_true(stat->p99 >= 50 * MS && stat->p99 <= stat->max);
+    assert_true(stat->total >= 198 * MS);
+
+    perf_free_stats(stats);
+    perf_close();
+}
+
+void perf_reset_clears_stats(void **state)
+{
+    perf_enable(TRUE);
+    perf_end("handler", perf_start() - 1 * MS);
+
+    perf_reset();
+
+    assert_null(perf_get_stats());
+    assert_true(perf_enabled());
+
+    perf_close();
+}
+
+void perf_dump_writes_stats(void **state)
+{
+    perf_enable(TRUE);
+    perf_end("handler", perf_start() - 1 * MS);
+
+    assert_true(perf_dump(PERF_FILE));
+
+    gchar *contents = NULL;
+    g_file_get_contents(PERF_FILE, &contents, NULL, NULL);
+    gchar **lines = g_strsplit(contents, "\n", 0);
+    assert_string_equal("# name\tcount\ttotal_ns\tp50_ns\tp99_ns\tmax_ns", lines[0]);
+    assert_true(g_str_has_prefix(lines[1], "handler\t1\t"));
+
+    g_strfreev(lines);
+    g_free(contents);
+    remove(PERF_FILE);
+    perf_close();
+}
@@ -0,0 +1,4 @@
+void perf_disabled_records_nothing(void **state);
+void perf_stats_summarise_latencies(void **state);
+void perf_reset_clears_stats(void **state);
+void perf_dump_writes_stats(void **state);
@@ -0,0 +1,70 @@
+#include <glib.h>
+#include <stdarg.h>
+#include <string.h>
+#include <stddef.h>
+#include <setjmp.h>
+#include <cmocka.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <sys/stat.h>
+
+#include "tools/persist.h"
+
+#define PERSIST_FILE "./persist_test_file"
+
+static int writes = 0;
+
+static void
+_count_write(void)
+{
+    writes++;
+}
+
+void persist_coalesces_changes_into_one_write(void **state)
+{
+    writes = 0;
+    PersistStore store = persist_store_new("test", _count_write);
+
+    persist_store_changed(store);
+    persist_store_changed(store);
+    persist_store_changed(store);
+    persist_flush();
+    assert_int_equal(0, writes);
+
+    persist_flush_all();
+    assert_int_equal(1, writes);
+
+    persist_flush_all();
+    assert_int_equal(1, writes);
+
+    persist_store_free(store);
+}
+
+void persist_store_free_writes_pending_changes(void **state)
+{
+    writes = 0;
+    PersistStore store = persist_store_new("test", _count_write);
+
+    persist_store_changed(store);
+    persist_store_free(store);
+
+    assert_int_equal(1, writes);
+}
+
+void persist_write_file_replaces_contents(void **state)
+{
+    assert_true(persist_write_file(PERSIST_FILE, "first", 5));
+    assert_true(persist_write_file(PERSIST_FILE, "second", 6));
+
+    gchar *contents = NULL;
+    gsize length = 0;
+    assert_true(g_file_get_contents(PERSIST_FILE, &contents, &length, NULL));
+    assert_string_equal("second", contents);
+
+    struct stat st;
+    assert_int_equal(0, stat(PERSIST_FILE, &st));
+    assert_int_equal(S_IRUSR | S_IWUSR, st.st_mode & 0777);
+
+    g_free(contents);
+    remove(PERSIST_FILE);
+}
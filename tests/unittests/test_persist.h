@@ -0,0 +1,3 @@
+void persist_coalesces_changes_into_one_write(void **state);
+void persist_store_free_writes_pending_changes(void **state);
+void persist_write_file_replaces_contents(void **state);
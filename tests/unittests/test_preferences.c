@@ -10,7 +10,7 @@
 
 void statuses_console_defaults_to_all(void **state)
 {
-    char *setting = prefs_get_string(PREF_STATUSES_CONSOLE);
+    const char *setting = prefs_get_string(PREF_STATUSES_CONSOLE);
 
     assert_non_null(setting);
     assert_string_equal("all", setting);
@@ -18,7 +18,7 @@ void statuses_console_defaults_to_all(void **state)
 
 void statuses_chat_defaults_to_all(void **state)
 {
-    char *setting = prefs_get_string(PREF_STATUSES_CHAT);
+    const char *setting = prefs_get_string(PREF_STATUSES_CHAT);
 
     assert_non_null(setting);
     assert_string_equal("all", setting);
@@ -26,8 +26,48 @@ void statuses_chat_defaults_to_all(void **state)
 
 void statuses_muc_defaults_to_all(void **state)
 {
-    char *setting = prefs_get_string(PREF_STATUSES_MUC);
+    const char *setting = prefs_get_string(PREF_STATUSES_MUC);
 
     assert_non_null(setting);
     assert_string_equal("all", setting);
 }
+
+void time_defaults_to_seconds(void **state)
+{
+    const char *setting = prefs_get_string(PREF_TIME);
+
+    assert_string_equal("%H:%M:%S", setting);
+}
+
+void theme_defaults_to_null(void **state)
+{
+    assert_null(prefs_get_string(PREF_THEME));
+}
+
+void set_string_updates_get_string(void **state)
+{
+    prefs_set_string(PREF_STATUSES_MUC, "none");
+
+    const char *setting = prefs_get_string(PREF_STATUSES_MUC);
+
+    assert_string_equal("none", setting);
+}
+
+void set_string_null_returns_default(void **state)
+{
+    prefs_set_string(PREF_STATUSES_MUC, "none");
+    prefs_set_string(PREF_STATUSES_MUC, NULL);
+
+    const char *setting = prefs_get_string(PREF_STATUSES_MUC);
+
+    assert_string_equal("all", setting);
+}
+
+void set_boolean_updates_get_boolean(void **state)
+{
+    assert_true(prefs_get_boolean(PREF_WRAP));
+
+    prefs_set_boolean(PREF_WRAP, FALSE);
+
+    assert_false(prefs_get_boolean(PREF_WRAP));
+}
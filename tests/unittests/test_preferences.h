@@ -1,3 +1,8 @@
 void statuses_console_defaults_to_all(void **state);
 void statuses_chat_defaults_to_all(void **state);
 void statuses_muc_defaults_to_all(void **state);
+void time_defaults_to_seconds(void **state);
+void theme_defaults_to_null(void **state);
+void set_string_updates_get_string(void **state);
+void set_string_null_returns_default(void **state);
+void set_boolean_updates_get_boolean(void **state);
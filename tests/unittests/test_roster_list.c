@@ -269,3 +269,269 @@ void find_twice_returns_first_when_two_match_and_reset(void **state)
     free(result2);
     roster_free();
 }
+
+void contacts_by_presence_follow_presence_changes(void **state)
+{
+    roster_init();
+    roster_add("james@server.org", NULL, NULL, NULL, FALSE);
+    roster_add("bob@server.org", NULL, NULL, NULL, FALSE);
+    Resource *resource = resource_new("laptop", RESOURCE_AWAY, NULL, 0);
+    roster_update_presence("james@server.org", resource, NULL);
+
+    GSList *away = roster_get_contacts_by_presence("away");
+    GSList *offline = roster_get_contacts_by_presence("offline");
+    assert_int_equal(1, g_slist_length(away));
+    assert_string_equal("james@server.org", p_contact_barejid(away->data));
+    assert_int_equal(1, g_slist_length(offline));
+    assert_string_equal("bob@server.org", p_contact_barejid(offline->data));
+    g_slist_free(away);
+    g_slist_free(offline);
+
+    roster_contact_offline("james@server.org", "laptop", NULL);
+
+    away = roster_get_contacts_by_presence("away");
+    offline = roster_get_contacts_by_presence("offline");
+    assert_null(away);
+    assert_int_equal(2, g_slist_length(offline));
+    assert_string_equal("bob@server.org", p_contact_barejid(offline->data));
+    assert_string_equal("james@server.org", p_contact_barejid(offline->next->data));
+    g_slist_free(offline);
+    roster_free();
+}
+
+void contacts_by_group_follow_roster_updates(void **state)
+{
+    roster_init();
+    GSList *groups = g_slist_append(NULL, strdup("friends"));
+    roster_add("james@server.org", NULL, groups, NULL, FALSE);
+    roster_add("bob@server.org", NULL, NULL, NULL, FALSE);
+
+    GSList *friends = roster_get_group("friends");
+    GSList *nogroup = roster_get_nogroup();
+    assert_int_equal(1, g_slist_length(friends));
+    assert_string_equal("james@server.org", p_contact_barejid(friends->data));
+    assert_int_equal(1, g_slist_length(nogroup));
+    assert_string_equal("bob@server.org", p_contact_barejid(nogroup->data));
+    g_slist_free(friends);
+    g_slist_free(nogroup);
+
+    GSList *new_groups = g_slist_append(NULL, strdup("friends"));
+    roster_update("bob@server.org", "Bobby", new_groups, NULL, FALSE);
+    roster_update("james@server.org", "Aaron", NULL, NULL, FALSE);
+
+    friends = roster_get_group("friends");
+    nogroup = roster_get_nogroup();
+    assert_int_equal(1, g_slist_length(friends));
+    assert_string_equal("bob@server.org", p_contact_barejid(friends->data));
+    assert_int_equal(1, g_slist_length(nogroup));
+    assert_string_equal("james@server.org", p_contact_barejid(nogroup->data));
+    g_slist_free(friends);
+    g_slist_free(nogroup);
+
+    GSList *all = roster_get_contacts();
+    assert_string_equal("james@server.org", p_contact_barejid(all->data));
+    assert_string_equal("bob@server.org", p_contact_barejid(all->next->data));
+    g_slist_free(all);
+    roster_free();
+}
+
+void removed_contact_not_in_views(void **state)
+{
+    roster_init();
+    GSList *groups = g_slist_append(NULL, strdup("friends"));
+    roster_add("james@server.org", NULL, groups, NULL, FALSE);
+    roster_add("bob@server.org", NULL, NULL, NULL, FALSE);
+
+    roster_remove("james@server.org", "james@server.org");
+
+    GSList *friends = roster_get_group("friends");
+    GSList *offline = roster_get_contacts_by_presence("offline");
+    assert_null(friends);
+    assert_int_equal(1, g_slist_length(offline));
+    assert_string_equal("bob@server.org", p_contact_barejid(offline->data));
+    g_slist_free(offline);
+    roster_free();
+}
+
+void add_all_builds_same_roster_as_add(void **state)
+{
+    roster_init();
+    roster_add("dave@server.org", NULL, NULL, NULL, FALSE);
+
+    GSList *groups = g_slist_append(NULL, strdup("friends"));
+    GSList *new_contacts = NULL;
+    new_contacts = g_slist_append(new_contacts, p_contact_new("james@server.org", "zed", groups, NULL, NULL, FALSE));
+    new_contacts = g_slist_append(new_contacts, p_contact_new("bob@server.org", NULL, NULL, NULL, NULL, FALSE));
+    new_contacts = g_slist_append(new_contacts, p_contact_new("dave@server.org", NULL, NULL, NULL, NULL, FALSE));
+    new_contacts = g_slist_append(new_contacts, p_contact_new("bob@server.org", NULL, NULL, NULL, NULL, FALSE));
+
+    gint added = roster_add_all(new_contacts);
+    assert_int_equal(2, added);
+
+    GSList *all = roster_get_contacts();
+    assert_int_equal(3, g_slist_length(all));
+    assert_string_equal("bob@server.org", p_contact_barejid(all->data));
+    assert_string_equal("dave@server.org", p_contact_barejid(all->next->data));
+    assert_string_equal("james@server.org", p_contact_barejid(all->next->next->data));
+    g_slist_free(all);
+
+    GSList *friends = roster_get_group("friends");
+    GSList *nogroup = roster_get_nogroup();
+    assert_int_equal(1, g_slist_length(friends));
+    assert_int_equal(2, g_slist_length(nogroup));
+    g_slist_free(friends);
+    g_slist_free(nogroup);
+
+    assert_string_equal("james@server.org", roster_barejid_from_name("zed"));
+    char *found = roster_contact_autocomplete("ze");
+    assert_string_equal("zed", found);
+    free(found);
+    found = roster_barejid_autocomplete("bo");
+    assert_string_equal("bob@server.org", found);
+    free(found);
+    roster_free();
+}
+
+typedef struct test_contact_t {
+    const char *barejid;
+    const char *name;
+    const char *group;
+} TestContact;
+
+static void
+_append_barejids(GString *snapshot, const char * const view, GSList *contacts)
+{
+    g_string_append_printf(snapshot, "%s:", view);
+    GSList *curr = contacts;
+    while (curr) {
+        g_string_append_printf(snapshot, " %s", p_contact_barejid(curr->data));
+        curr = g_slist_next(curr);
+    }
+    g_string_append(snapshot, "\n");
+    g_slist_free(contacts);
+}
+
+static void
+_append_completions(GString *snapshot, const char * const ac, char * (*complete)(const char * const),
+    const char * const prefix)
+{
+    g_string_append_printf(snapshot, "%s %s:", ac, prefix);
+    roster_reset_search_attempts();
+
+    // enough to cycle through every match and back to the first
+    int i;
+    for (i = 0; i < 6; i++) {
+        char *found = complete(prefix);
+        g_string_append_printf(snapshot, " %s", found ? found : "-");
+        free(found);
+    }
+    g_string_append(snapshot, "\n");
+}
+
+// every view and completion of the roster built from existing then batch, either
+// with roster_add for each contact or with roster_add_all for the batch
+static gchar *
+_roster_snapshot(TestContact *existing, int existing_len, TestContact *batch, int batch_len,
+    gboolean add_all, gint *added)
+{
+    roster_init();
+    int i;
+    for (i = 0; i < existing_len; i++) {
+        GSList *groups = existing[i].group ? g_slist_append(NULL, strdup(existing[i].group)) : NULL;
+        roster_add(existing[i].barejid, existing[i].name, groups, NULL, FALSE);
+    }
+
+    *added = 0;
+    if (add_all) {
+        GSList *new_contacts = NULL;
+        for (i = 0; i < batch_len; i++) {
+            GSList *groups = batch[i].group ? g_slist_append(NULL, strdup(batch[i].group)) : NULL;
+            new_contacts = g_slist_append(new_contacts,
+                p_contact_new(batch[i].barejid, batch[i].name, groups, NULL, NULL, FALSE));
+        }
+        *added = roster_add_all(new_contacts);
+    } else {
+        for (i = 0; i < batch_len; i++) {
+            GSList *groups = batch[i].group ? g_slist_append(NULL, strdup(batch[i].group)) : NULL;
+            if (roster_add(batch[i].barejid, batch[i].name, groups, NULL, FALSE)) {
+                (*added)++;
+            } else {
+                g_slist_free_full(groups, free);
+            }
+        }
+    }
+
+    GString *snapshot = g_string_new("");
+    _append_barejids(snapshot, "all", roster_get_contacts());
+    _append_barejids(snapshot, "offline", roster_get_contacts_by_presence("offline"));
+    _append_barejids(snapshot, "friends", roster_get_group("friends"));
+    _append_barejids(snapshot, "work", roster_get_group("work"));
+    _append_barejids(snapshot, "nogroup", roster_get_nogroup());
+    _append_completions(snapshot, "name", roster_contact_autocomplete, "a");
+    _append_completions(snapshot, "name", roster_contact_autocomplete, "B");
+    _append_completions(snapshot, "barejid", roster_barejid_autocomplete, "a");
+    _append_completions(snapshot, "barejid", roster_barejid_autocomplete, "b");
+    _append_completions(snapshot, "group", roster_group_autocomplete, "");
+    char *bob = roster_barejid_from_name("Bob");
+    char *robert = roster_barejid_from_name("Robert");
+    g_string_append_printf(snapshot, "Bob: %s\n", bob ? bob : "-");
+    g_string_append_printf(snapshot, "Robert: %s\n", robert ? robert : "-");
+    roster_free();
+
+    return g_string_free(snapshot, FALSE);
+}
+
+static void
+_assert_add_all_matches_add(TestContact *existing, int existing_len, TestContact *batch, int batch_len,
+    gint expected_added)
+{
+    gint added_one_at_a_time = 0;
+    gint added_all = 0;
+    gchar *one_at_a_time = _roster_snapshot(existing, existing_len, batch, batch_len, FALSE,
+        &added_one_at_a_time);
+    gchar *all = _roster_snapshot(existing, existing_len, batch, batch_len, TRUE, &added_all);
+
+    assert_int_equal(expected_added, added_one_at_a_time);
+    assert_int_equal(expected_added, added_all);
+    assert_string_equal(one_at_a_time, all);
+
+    g_free(one_at_a_time);
+    g_free(all);
+}
+
+void add_all_orders_views_and_completions_like_add(void **state)
+{
+    TestContact batch[] = {
+        { "zoe@server.org", "Zoe", "friends" },
+        { "adam@server.org", NULL, "work" },
+        { "mike@server.org", "alex", NULL },
+        { "bob@server.org", "Bob", "work" },
+        { "amy@server.org", "amy", "friends" },
+    };
+
+    _assert_add_all_matches_add(NULL, 0, batch, 5, 5);
+}
+
+void add_all_keeps_first_of_duplicates_in_batch(void **state)
+{
+    TestContact batch[] = {
+        { "bob@server.org", "Bob", "work" },
+        { "adam@server.org", NULL, NULL },
+        { "bob@server.org", "Robert", "friends" },
+    };
+
+    _assert_add_all_matches_add(NULL, 0, batch, 3, 2);
+}
+
+void add_all_keeps_contacts_already_in_roster(void **state)
+{
+    TestContact existing[] = {
+        { "bob@server.org", "Bob", "work" },
+    };
+    TestContact batch[] = {
+        { "bob@server.org", "Robert", "friends" },
+        { "amy@server.org", "amy", "friends" },
+    };
+
+    _assert_add_all_matches_add(existing, 1, batch, 2, 1);
+}
@@ -16,3 +16,10 @@ void find_on_empty_returns_null(void **state);
 void find_twice_returns_second_when_two_match(void **state);
 void find_five_times_finds_fifth(void **state);
 void find_twice_returns_first_when_two_match_and_reset(void **state);
+void contacts_by_presence_follow_presence_changes(void **state);
+void contacts_by_group_follow_roster_updates(void **state);
+void removed_contact_not_in_views(void **state);
+void add_all_builds_same_roster_as_add(void **state);
+void add_all_orders_views_and_completions_like_add(void **state);
+void add_all_keeps_first_of_duplicates_in_batch(void **state);
+void add_all_keeps_contacts_already_in_roster(void **state);
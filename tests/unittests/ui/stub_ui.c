@@ -56,6 +56,11 @@ expect_ui_current_print_formatted_line(char show_char, int attrs, char *message)
 void ui_init(void) {}
 void ui_load_colours(void) {}
 void ui_update(void) {}
+void ui_mark_dirty(int surfaces) {}
+gint ui_frame_timeout(gint timeout)
+{
+    return timeout;
+}
 void ui_close(void) {}
 void ui_redraw(void) {}
 void ui_resize(void) {}
@@ -338,6 +343,8 @@ gboolean ui_xmlconsole_exists(void)
 }
 
 void ui_open_xmlconsole_win(void) {}
+void ui_show_search_results(const char * const query, GSList *results, double elapsed, gboolean partial) {}
+void ui_show_perf(GSList *stats) {}
 
 gboolean ui_win_has_unsaved_form(int num)
 {
@@ -499,9 +506,13 @@ void status_bar_set_all_inactive(void) {}
 
 // roster window
 void rosterwin_roster(void) {}
+void rosterwin_roster_changed(void) {}
+void rosterwin_roster_flush(void) {}
 
 // occupants window
 void occupantswin_occupants(const char * const room) {}
+void occupantswin_occupants_changed(const char * const room) {}
+void occupantswin_occupants_flush(void) {}
 
 // window interface
 ProfWin* win_create_console(void)
@@ -512,6 +523,10 @@ ProfWin* win_create_xmlconsole(void)
 {
     return NULL;
 }
+ProfWin* win_create_single(win_type_t type)
+{
+    return NULL;
+}
 ProfWin* win_create_chat(const char * const barejid)
 {
     return (ProfWin*)mock();
@@ -531,6 +546,7 @@ ProfWin* win_create_private(const char * const fulljid)
 
 void win_update_virtual(ProfWin *window) {}
 void win_free(ProfWin *window) {}
+void win_close(void) {}
 int win_unread(ProfWin *window)
 {
     return 0;
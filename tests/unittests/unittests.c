@@ -34,6 +34,15 @@
 #include "test_cmd_roster.h"
 #include "test_cmd_disconnect.h"
 #include "test_form.h"
+#include "test_buffer.h"
+#include "test_log_index.h"
+#include "test_chat_log_history.h"
+#include "test_persist.h"
+#include "test_perf.h"
+#include "test_http.h"
+#ifdef HAVE_LIBGPGME
+#include "test_gpg_jobs.h"
+#endif
 
 int main(int argc, char* argv[]) {
     const UnitTest all_tests[] = {
@@ -114,6 +123,11 @@ int main(int argc, char* argv[]) {
         unit_test(add_two_adds_two),
         unit_test(add_two_same_adds_one),
         unit_test(add_two_same_updates),
+        unit_test(complete_cycles_matches_and_wraps),
+        unit_test(complete_after_removing_last_found_restarts),
+        unit_test(complete_continues_after_add_before_last_found),
+        unit_test(contains_finds_only_added_items),
+        unit_test(add_all_sorts_and_skips_duplicates),
 
         unit_test(create_jid_from_null_returns_null),
         unit_test(create_jid_from_empty_string_returns_null),
@@ -210,6 +224,13 @@ int main(int argc, char* argv[]) {
         unit_test(find_twice_returns_second_when_two_match),
         unit_test(find_five_times_finds_fifth),
         unit_test(find_twice_returns_first_when_two_match_and_reset),
+        unit_test(contacts_by_presence_follow_presence_changes),
+        unit_test(contacts_by_group_follow_roster_updates),
+        unit_test(removed_contact_not_in_views),
+        unit_test(add_all_builds_same_roster_as_add),
+        unit_test(add_all_orders_views_and_completions_like_add),
+        unit_test(add_all_keeps_first_of_duplicates_in_batch),
+        unit_test(add_all_keeps_contacts_already_in_roster),
 
         unit_test_setup_teardown(returns_false_when_chat_session_does_not_exist,
             init_chat_sessions,
@@ -436,6 +457,21 @@ int main(int argc, char* argv[]) {
         unit_test_setup_teardown(statuses_muc_defaults_to_all,
             load_preferences,
             close_preferences),
+        unit_test_setup_teardown(time_defaults_to_seconds,
+            load_preferences,
+            close_preferences),
+        unit_test_setup_teardown(theme_defaults_to_null,
+            load_preferences,
+            close_preferences),
+        unit_test_setup_teardown(set_string_updates_get_string,
+            load_preferences,
+            close_preferences),
+        unit_test_setup_teardown(set_string_null_returns_default,
+            load_preferences,
+            close_preferences),
+        unit_test_setup_teardown(set_boolean_updates_get_boolean,
+            load_preferences,
+            close_preferences),
 
         unit_test_setup_teardown(console_shows_online_presence_when_set_online,
             load_preferences,
@@ -475,6 +511,10 @@ int main(int argc, char* argv[]) {
         unit_test_setup_teardown(test_muc_invites_count_5, muc_before_test, muc_after_test),
         unit_test_setup_teardown(test_muc_room_is_not_active, muc_before_test, muc_after_test),
         unit_test_setup_teardown(test_muc_active, muc_before_test, muc_after_test),
+        unit_test_setup_teardown(test_muc_roster_sorted_by_nick, muc_before_test, muc_after_test),
+        unit_test_setup_teardown(test_muc_occupants_by_role_follow_role_change, muc_before_test, muc_after_test),
+        unit_test_setup_teardown(test_muc_removed_occupant_not_in_roster, muc_before_test, muc_after_test),
+        unit_test_setup_teardown(test_muc_own_nick_change_leaves_occupants_by_role, muc_before_test, muc_after_test),
 
         unit_test(cmd_bookmark_shows_message_when_disconnected),
         unit_test(cmd_bookmark_shows_message_when_disconnecting),
@@ -555,6 +595,12 @@ int main(int argc, char* argv[]) {
         unit_test(cmd_pgp_start_shows_message_when_no_arg_in_mucconf),
         unit_test(cmd_pgp_start_shows_message_when_no_arg_in_private),
         unit_test(cmd_pgp_start_shows_message_when_no_arg_in_xmlconsole),
+        unit_test(gpg_jobs_delivers_in_submission_order),
+        unit_test(gpg_jobs_verify_does_not_hold_back_decrypt),
+        unit_test(gpg_jobs_drops_results_from_old_generation),
+        unit_test(gpg_jobs_stop_frees_undelivered_jobs),
+        unit_test(gpg_jobs_run_on_main_thread_without_workers),
+        unit_test(gpg_jobs_wakes_main_loop_on_completion),
 #else
         unit_test(cmd_pgp_shows_message_when_pgp_unsupported),
 #endif
@@ -609,6 +655,69 @@ int main(int argc, char* argv[]) {
         unit_test(remove_text_multi_value_removes_when_many),
 
         unit_test(clears_chat_sessions),
+
+        unit_test(buffer_empty_after_create),
+        unit_test(buffer_yields_entries_in_order),
+        unit_test(buffer_drops_oldest_when_full),
+        unit_test(buffer_iter_walks_entries_in_order_after_wrap),
+        unit_test(buffer_mark_received_marks_once),
+        unit_test(buffer_push_front_adds_older_entries),
+        unit_test(buffer_push_front_refused_when_full),
+        unit_test(buffer_layout_wraps_word_to_next_line),
+        unit_test(buffer_layout_breaks_long_word_with_indent),
+        unit_test(buffer_layout_cached_until_width_changes),
+        unit_test(buffer_start_tracks_dropped_and_front_entries),
+
+        unit_test_setup_teardown(search_finds_line_in_contact_log,
+            log_index_before_test,
+            log_index_after_test),
+        unit_test_setup_teardown(search_matches_every_word_ignoring_case,
+            log_index_before_test,
+            log_index_after_test),
+        unit_test_setup_teardown(search_returns_newest_first_including_rooms,
+            log_index_before_test,
+            log_index_after_test),
+        unit_test_setup_teardown(search_finds_lines_appended_after_indexing,
+            log_index_before_test,
+            log_index_after_test),
+        unit_test_setup_teardown(search_indexes_logs_a_chunk_at_a_time,
+            log_index_before_test,
+            log_index_after_test),
+        unit_test_setup_teardown(append_indexes_log_not_loaded,
+            log_index_before_test,
+            log_index_after_test),
+        unit_test_setup_teardown(search_skips_postings_indexed_twice,
+            log_index_before_test,
+            log_index_after_test),
+
+        unit_test_setup_teardown(history_of_empty_log_has_no_lines,
+            chat_log_history_before_test,
+            chat_log_history_after_test),
+        unit_test_setup_teardown(history_returns_log_smaller_than_chunk,
+            chat_log_history_before_test,
+            chat_log_history_after_test),
+        unit_test_setup_teardown(history_joins_line_straddling_chunk,
+            chat_log_history_before_test,
+            chat_log_history_after_test),
+        unit_test_setup_teardown(history_reads_last_line_without_newline,
+            chat_log_history_before_test,
+            chat_log_history_after_test),
+        unit_test_setup_teardown(history_pages_back_to_start_of_logs,
+            chat_log_history_before_test,
+            chat_log_history_after_test),
+
+        unit_test(persist_coalesces_changes_into_one_write),
+        unit_test(persist_store_free_writes_pending_changes),
+        unit_test(persist_write_file_replaces_contents),
+
+        unit_test(perf_disabled_records_nothing),
+        unit_test(perf_stats_summarise_latencies),
+        unit_test(perf_reset_clears_stats),
+        unit_test(perf_dump_writes_stats),
+
+        unit_test(http_get_returns_body_to_main_loop),
+        unit_test(http_get_reports_error_status_as_failure),
+        unit_test(http_close_drops_pending_requests),
     };
 
     return run_tests(all_tests);
@@ -42,6 +42,21 @@ jabber_conn_status_t jabber_get_connection_status(void)
     return (jabber_conn_status_t)mock();
 }
 
+int jabber_get_socket(void)
+{
+    return -1;
+}
+
+gboolean jabber_has_pending_input(void)
+{
+    return FALSE;
+}
+
+gboolean jabber_has_pending_output(void)
+{
+    return FALSE;
+}
+
 char* jabber_get_presence_message(void)
 {
     return (char*)mock();
@@ -212,6 +227,16 @@ char * bookmark_find(const char * const search_str)
 
 void bookmark_autocomplete_reset(void) {}
 
+gboolean capture_start(const char * const path)
+{
+    return TRUE;
+}
+void capture_stop(void) {}
+const char * capture_path(void)
+{
+    return NULL;
+}
+
 void roster_send_name_change(const char * const barejid, const char * const new_name, GSList *groups)
 {
     check_expected(barejid);